@@ -0,0 +1,158 @@
+#include "Halide.h"
+
+namespace {
+
+using namespace Halide;
+
+enum class Schedule { Tiled, ParallelChannels, Streaming };
+
+class BilateralGrid : public Halide::Generator<BilateralGrid> {
+public:
+    // The spatial sigma, which is the size in pixels of a grid cell.
+    GeneratorParam<int> s_sigma{"s_sigma", 8};
+    // The CPU schedule. GPU targets always use the GPU schedule.
+    //  tiled: computes the grid in square tiles of the output, in
+    //    parallel.
+    //  parallel_channels: computes each stage of the grid over the
+    //    whole image, in parallel over the intensity levels of the
+    //    grid.
+    //  streaming: slides down parallel strips of the output one grid
+    //    row at a time, keeping only the few rows of the grid that
+    //    are needed, which uses the least memory.
+    GeneratorParam<Schedule> schedule{"schedule", Schedule::ParallelChannels,
+                                      {{"tiled", Schedule::Tiled},
+                                       {"parallel_channels", Schedule::ParallelChannels},
+                                       {"streaming", Schedule::Streaming}}};
+    // The size, in grid cells, of the tiles of the tiled schedule and
+    // the height of the strips of the streaming schedule. Larger tiles
+    // recompute less of the grid at their edges.
+    GeneratorParam<int> tile_size{"tile_size", 32};
+
+    ImageParam input{Float(32), 2, "input"};
+    Param<float> r_sigma{"r_sigma"};
+
+    Func build() {
+        Var x("x"), y("y"), z("z"), c("c");
+        const int s = s_sigma;
+        const int tile = tile_size;
+
+        // Add a boundary condition
+        Func clamped = BoundaryConditions::repeat_edge(input);
+
+        // Construct the bilateral grid
+        RDom r(0, s, 0, s);
+        Expr val = clamped(x * s + r.x - s/2, y * s + r.y - s/2);
+        val = clamp(val, 0.0f, 1.0f);
+        Expr zi = cast<int>(val * (1.0f/r_sigma) + 0.5f);
+        Func histogram("histogram");
+        histogram(x, y, z, c) = 0.0f;
+        histogram(x, y, zi, c) += select(c == 0, val, 1.0f);
+
+        // Blur the grid using a five-tap filter
+        Func blurx("blurx"), blury("blury"), blurz("blurz");
+        blurz(x, y, z, c) = (histogram(x, y, z-2, c) +
+                             histogram(x, y, z-1, c)*4 +
+                             histogram(x, y, z  , c)*6 +
+                             histogram(x, y, z+1, c)*4 +
+                             histogram(x, y, z+2, c));
+        blurx(x, y, z, c) = (blurz(x-2, y, z, c) +
+                             blurz(x-1, y, z, c)*4 +
+                             blurz(x  , y, z, c)*6 +
+                             blurz(x+1, y, z, c)*4 +
+                             blurz(x+2, y, z, c));
+        blury(x, y, z, c) = (blurx(x, y-2, z, c) +
+                             blurx(x, y-1, z, c)*4 +
+                             blurx(x, y  , z, c)*6 +
+                             blurx(x, y+1, z, c)*4 +
+                             blurx(x, y+2, z, c));
+
+        // Take trilinear samples to compute the output
+        val = clamp(input(x, y), 0.0f, 1.0f);
+        Expr zv = val * (1.0f/r_sigma);
+        zi = cast<int>(zv);
+        Expr zf = zv - zi;
+        Expr xf = cast<float>(x % s) / s;
+        Expr yf = cast<float>(y % s) / s;
+        Expr xi = x/s;
+        Expr yi = y/s;
+        Func interpolated("interpolated");
+        interpolated(x, y, c) =
+            lerp(lerp(lerp(blury(xi, yi, zi, c), blury(xi+1, yi, zi, c), xf),
+                      lerp(blury(xi, yi+1, zi, c), blury(xi+1, yi+1, zi, c), xf), yf),
+                 lerp(lerp(blury(xi, yi, zi+1, c), blury(xi+1, yi, zi+1, c), xf),
+                      lerp(blury(xi, yi+1, zi+1, c), blury(xi+1, yi+1, zi+1, c), xf), yf), zf);
+
+        // Normalize
+        Func bilateral_grid("bilateral_grid");
+        bilateral_grid(x, y) = interpolated(x, y, 0)/interpolated(x, y, 1);
+
+        if (get_target().has_gpu_feature()) {
+            // Schedule blurz in 8x8 tiles. This is a tile in
+            // grid-space, which means it represents something like
+            // 64x64 pixels in the input (if s_sigma is 8).
+            blurz.compute_root().reorder(c, z, x, y).gpu_tile(x, y, 8, 8);
+
+            // Schedule histogram to happen per-tile of blurz, with
+            // intermediate results in shared memory. This means histogram
+            // and blurz makes a three-stage kernel:
+            // 1) Zero out the 8x8 set of histograms
+            // 2) Compute those histogram by iterating over lots of the input image
+            // 3) Blur the set of histograms in z
+            histogram.reorder(c, z, x, y).compute_at(blurz, Var::gpu_blocks()).gpu_threads(x, y);
+            histogram.update().reorder(c, r.x, r.y, x, y).gpu_threads(x, y).unroll(c);
+
+            // An alternative schedule for histogram that doesn't use shared memory:
+            // histogram.compute_root().reorder(c, z, x, y).gpu_tile(x, y, 8, 8);
+            // histogram.update().reorder(c, r.x, r.y, x, y).gpu_tile(x, y, 8, 8).unroll(c);
+
+            // Schedule the remaining blurs and the sampling at the end similarly.
+            blurx.compute_root().gpu_tile(x, y, z, 8, 8, 1);
+            blury.compute_root().gpu_tile(x, y, z, 8, 8, 1);
+            bilateral_grid.compute_root().gpu_tile(x, y, s, s);
+        } else if (schedule == Schedule::Tiled) {
+            // Compute the whole grid per tile of the output. The tiles
+            // of the grid overlap by the support of the blurs.
+            Var xo("xo"), yo("yo"), xin("xin"), yin("yin");
+            bilateral_grid.compute_root()
+                .tile(x, y, xo, yo, xin, yin, s * tile, s * tile)
+                .parallel(yo).vectorize(xin, 8);
+            blury.compute_at(bilateral_grid, xo).reorder(c, x, y, z).vectorize(x, 8).unroll(c);
+            blurx.compute_at(bilateral_grid, xo).reorder(c, x, y, z).vectorize(x, 8).unroll(c);
+            blurz.compute_at(bilateral_grid, xo).reorder(c, z, x, y).vectorize(x, 8).unroll(c);
+            histogram.compute_at(blurz, y);
+            histogram.update().reorder(c, r.x, r.y, x, y).unroll(c);
+        } else if (schedule == Schedule::ParallelChannels) {
+            blurz.compute_root().reorder(c, z, x, y).parallel(y).vectorize(x, 8).unroll(c);
+            histogram.compute_at(blurz, y);
+            histogram.update().reorder(c, r.x, r.y, x, y).unroll(c);
+            blurx.compute_root().reorder(c, x, y, z).parallel(z).vectorize(x, 8).unroll(c);
+            blury.compute_root().reorder(c, x, y, z).parallel(z).vectorize(x, 8).unroll(c);
+            bilateral_grid.compute_root().parallel(y).vectorize(x, 8);
+        } else {
+            // Each parallel strip of the output slides down one grid
+            // row at a time. Each row of the output needs two rows of
+            // blury, which need six rows of blurx, so those are the
+            // only rows stored, in circular buffers.
+            Var ys("ys"), yo("yo");
+            bilateral_grid.compute_root()
+                .split(y, ys, y, s * tile)
+                .split(y, yo, y, s)
+                .parallel(ys).vectorize(x, 8);
+            blury.store_at(bilateral_grid, ys).compute_at(bilateral_grid, yo)
+                .fold_storage(y, 4)
+                .reorder(c, x, z, y).vectorize(x, 8).unroll(c);
+            blurx.store_at(bilateral_grid, ys).compute_at(bilateral_grid, yo)
+                .fold_storage(y, 8)
+                .reorder(c, x, z, y).vectorize(x, 8).unroll(c);
+            blurz.compute_at(blurx, y).reorder(c, z, x, y).vectorize(x, 8).unroll(c);
+            histogram.compute_at(blurz, y);
+            histogram.update().reorder(c, r.x, r.y, x, y).unroll(c);
+        }
+
+        return bilateral_grid;
+    }
+};
+
+Halide::RegisterGenerator<BilateralGrid> register_bilateral_grid{"bilateral_grid"};
+
+}  // namespace
@@ -0,0 +1,46 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "bilateral_grid_tiled.h"
+#include "bilateral_grid_parallel_channels.h"
+#include "bilateral_grid_streaming.h"
+
+#include "halide_image.h"
+#include "schedule_benchmark.h"
+
+using namespace Halide::Tools;
+
+// Compare the throughput and the peak memory use of the CPU schedules
+// of the bilateral grid, over several image sizes and thread counts.
+
+int main(int argc, char **argv) {
+    const float r_sigma = 0.1f;
+    const int sizes[][2] = {{640, 480}, {1920, 1080}, {3840, 2160}};
+
+    schedule_benchmark::print_header();
+    for (auto size : sizes) {
+        const int width = size[0], height = size[1];
+
+        // A smooth gradient with noise, so that the pixels fall in
+        // many different cells of the grid.
+        Image<float> input(width, height);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                float noise = (rand() & 0xff) / 2550.0f;
+                input(x, y) = 0.9f * (x + y) / (width + height) + noise;
+            }
+        }
+        Image<float> output(width, height);
+
+        std::vector<schedule_benchmark::Variant> variants = {
+            {"tiled", [&]() { return bilateral_grid_tiled(input, r_sigma, output); }},
+            {"parallel_channels", [&]() { return bilateral_grid_parallel_channels(input, r_sigma, output); }},
+            {"streaming", [&]() { return bilateral_grid_streaming(input, r_sigma, output); }},
+        };
+        if (schedule_benchmark::compare(width, height, variants) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -23,12 +23,12 @@ int main(int argc, char **argv) {
     Image<float> input = load_image(argv[1]);
     Image<float> output(input.width(), input.height(), 1);
 
-    bilateral_grid(atof(argv[3]), input, output);
+    bilateral_grid(input, atof(argv[3]), output);
 
     // Timing code. Timing doesn't include copying the input data to
     // the gpu or copying the output back.
     double min_t = benchmark(timing_iterations, 10, [&]() {
-        bilateral_grid(atof(argv[3]), input, output);
+        bilateral_grid(input, atof(argv[3]), output);
     });
     printf("Time: %gms\n", min_t * 1e3);
 
@@ -0,0 +1,47 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "benchmark.h"
+#include "halide_image.h"
+#include "blur_c.h"
+#include "blur_native.h"
+
+using namespace Halide::Tools;
+
+int main(int argc, char **argv) {
+    Image<uint16_t> in(1536 + 8, 2048 + 8);
+
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            in(x, y) = (uint16_t)rand();
+        }
+    }
+
+    Image<uint16_t> out_native(1536, 2048);
+    Image<uint16_t> out_c(1536, 2048);
+
+    double t_native = benchmark(10, 1, [&]() {
+        blur_native(in, out_native);
+    });
+
+    double t_c = benchmark(10, 1, [&]() {
+        blur_c(in, out_c);
+    });
+
+    for (int y = 0; y < out_native.height(); y++) {
+        for (int x = 0; x < out_native.width(); x++) {
+            if (out_native(x, y) != out_c(x, y)) {
+                printf("out_native(%d, %d) = %d, but out_c(%d, %d) = %d\n",
+                       x, y, out_native(x, y),
+                       x, y, out_c(x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("LLVM backend: %f ms\n", t_native * 1e3);
+    printf("C backend: %f ms (%.2fx)\n", t_c * 1e3, t_c / t_native);
+
+    printf("Success!\n");
+    return 0;
+}
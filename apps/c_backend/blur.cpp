@@ -0,0 +1,28 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+// Compile a vectorized blur to an object and to C code, to compare
+// the speed of the two.
+int main(int argc, char **argv) {
+    ImageParam input(UInt(16), 2);
+    Func blur_x("blur_x"), blur_y("blur_y");
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+
+    blur_x(x, y) = (input(x, y) + input(x+1, y) + input(x+2, y))/3;
+    blur_y(x, y) = (blur_x(x, y) + blur_x(x, y+1) + blur_x(x, y+2))/3;
+
+    // The C backend doesn't have a thread pool, so keep this
+    // single-threaded for both.
+    blur_y.tile(x, y, xi, yi, 256, 32).vectorize(xi, 8);
+    blur_x.compute_at(blur_y, x).vectorize(x, 8);
+
+    std::vector<Argument> args;
+    args.push_back(input);
+
+    blur_y.compile_to_header("blur_native.h", args, "blur_native");
+    blur_y.compile_to_header("blur_c.h", args, "blur_c");
+    blur_y.compile_to_object("blur_native.o", args, "blur_native");
+    blur_y.compile_to_c("blur_c.cpp", args, "blur_c");
+    return 0;
+}
@@ -4,12 +4,17 @@
 
 #include "fft.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <ostream>
+#include <sstream>
 #include <string>
 
 #include "funct.h"
@@ -1003,6 +1008,161 @@ Func fft2d_c2r(ComplexFunc c,
     return unzipped;
 }
 
+// Compute the 1D DFT of dimension 0 of x, where R0 and R1 are the radix
+// factorizations of the two passes of the four step algorithm, or R1 is empty
+// to transform the rows of x directly.
+ComplexFunc fft1d_c2c(ComplexFunc x,
+                      const vector<int> &R0,
+                      const vector<int> &R1,
+                      int sign,
+                      const Target& target,
+                      const Fft2dDesc& desc) {
+    string prefix = desc.name.empty() ? "c2c1d_" : desc.name + "_";
+
+    vector<Var> args(x.args());
+    Var n(args[0]);
+    args.erase(args.begin());
+
+    int N0 = product(R0);
+    int N1 = product(R1);
+    int N = N0 * N1;
+
+    // Cache of twiddle factors for this FFT.
+    TwiddleFactorSet twiddle_cache;
+
+    ComplexFunc dft(prefix + "dft");
+    if (R1.empty()) {
+        // Transform groups of rows at once, by transposing the rows to be
+        // dimension 1, and vectorizing across dimension 0. A single row,
+        // e.g. of a prime size that can't be split for the four step
+        // algorithm, is transformed the same way, by repeating it to fill a
+        // group. This wastes all but one lane of each vector, but the rows
+        // can't be vectorized any other way.
+        const bool single_row = args.empty();
+        Var row(prefix + "row");
+        if (!single_row) {
+            row = args[0];
+            args.erase(args.begin());
+        }
+
+        // Get the innermost variable outside the rows.
+        Var outer = Var::outermost();
+        if (!args.empty()) {
+            outer = args.front();
+        }
+
+        ComplexFunc xT(prefix + "xT");
+        if (single_row) {
+            xT(row, n) = x(n);
+        } else {
+            xT(A({row, n}, args)) = x(A({n, row}, args));
+        }
+
+        // The number of rows isn't known, so don't limit the vector width.
+        ComplexFunc dftT = fft_dim1(xT,
+                                    R0,
+                                    sign,
+                                    std::numeric_limits<int>::max(),
+                                    desc.gain,
+                                    desc.parallel,
+                                    prefix,
+                                    target,
+                                    &twiddle_cache);
+
+        if (single_row) {
+            dft(n) = dftT(0, n);
+        } else {
+            dft(A({n, row}, args)) = dftT(A({row, n}, args));
+        }
+
+        // Schedule.
+        if (desc.schedule_input) {
+            x.compute_at(dftT, group);
+        }
+        dftT.compute_at(dft, outer);
+    } else {
+        // Get the innermost variable outside the FFT.
+        Var outer = Var::outermost();
+        if (!args.empty()) {
+            outer = args.front();
+        }
+
+        // View x as an N0 x N1 matrix x2(n0, n1) = x(n0 + N0 * n1). The DFT
+        // of x at k = k1 + N1 * k0 is the DFT of the rows of the matrix of
+        // DFTs of the columns, multiplied by twiddle factors W_N^(n0 * k1):
+        //
+        //   X_(k1 + N1 k0) =
+        //     sum_n0[ W_N0^(n0 k0) W_N^(n0 k1) sum_n1[ W_N1^(n1 k1) x2(n0, n1) ] ]
+        //
+        // The columns are transformed in groups vectorized across n0, and
+        // the rows in groups vectorized across k1.
+        Var n0(n.name() + "_0"), n1(n.name() + "_1");
+        ComplexFunc x2(prefix + "x2");
+        x2(A({n0, n1}, args)) = x(A({n0 + N0 * n1}, args));
+
+        // Compute the DFT of the columns.
+        ComplexFunc dft1 = fft_dim1(x2,
+                                    R1,
+                                    sign,
+                                    N0,  // extent of dim 0.
+                                    1.0f,
+                                    desc.parallel,
+                                    prefix,
+                                    target,
+                                    &twiddle_cache);
+
+        // Apply the twiddle factors. n0 * n1 < N, so these are all from
+        // one table of N twiddle factors.
+        ComplexFunc W = twiddle_factors(N, 1.0f, sign, prefix, &twiddle_cache);
+        ComplexFunc twiddled(prefix + "twiddled"); {
+            ComplexExpr dft1_n = dft1(A({n0, n1}, args));
+            twiddled(A({n0, n1}, args)) = dft1_n * W(n0 * n1);
+        }
+
+        // transpose so we can take the DFT of the rows.
+        ComplexFunc twiddledT, twiddledT_tiled;
+        std::tie(twiddledT, twiddledT_tiled) = tiled_transpose(twiddled, N1, target, prefix);
+
+        // Compute the DFT of the rows.
+        ComplexFunc dft0T = fft_dim1(twiddledT,
+                                     R0,
+                                     sign,
+                                     N1,  // extent of dim 0.
+                                     desc.gain,
+                                     desc.parallel,
+                                     prefix,
+                                     target,
+                                     &twiddle_cache);
+
+        // Read the result in order of k = k1 + N1 * k0.
+        dft(A({n}, args)) = dft0T(A({n % N1, n / N1}, args));
+
+        // Schedule.
+        if (twiddledT_tiled.defined()) {
+            twiddledT_tiled.compute_at(dft0T, group);
+        }
+
+        // Schedule the input, if requested.
+        if (desc.schedule_input) {
+            x.compute_at(dft1, group);
+        }
+
+        dft1.compute_at(dft, outer);
+        dft0T.compute_at(dft, outer);
+
+        // When N1 is a multiple of the vector width, the loads from dft0T
+        // are dense vectors.
+        const int vector_width = target.natural_vector_size<float>();
+        if (N1 % vector_width == 0) {
+            dft.vectorize(n, vector_width);
+        }
+    }
+
+    dft.bound(n, 0, N);
+
+    return dft;
+}
+
 namespace {
 
 // Compute a factorization of N suitable for use in the FFT.
@@ -1034,6 +1194,32 @@ vector<int> radix_factor(int N) {
     return R;
 }
 
+// Use the radix factorization R of N if one was given, or the default
+// factorization of N otherwise.
+vector<int> radix_or_default(const vector<int> &R, int N) {
+    if (R.empty()) {
+        return radix_factor(N);
+    }
+    assert(product(R) == N && "Radix factorization does not match the FFT size.");
+    return R;
+}
+
+// 1D FFTs at least this large are computed with the four step algorithm by
+// default, even if they could be vectorized across rows instead.
+const int kFourStepMinSize = 1024;
+
+// Find the largest divisor of N not greater than sqrt(N), to split N into
+// N0 x N1 for the four step algorithm.
+int four_step_split(int N) {
+    int N0 = 1;
+    for (int d = 2; d * d <= N; d++) {
+        if (N % d == 0) {
+            N0 = d;
+        }
+    }
+    return N0;
+}
+
 }  // namespace
 
 ComplexFunc fft2d_c2c(ComplexFunc x,
@@ -1041,19 +1227,341 @@ ComplexFunc fft2d_c2c(ComplexFunc x,
                       int sign,
                       const Target& target,
                       const Fft2dDesc& desc) {
-    return fft2d_c2c(x, radix_factor(N0), radix_factor(N1), sign, target, desc);
+    return fft2d_c2c(x, radix_or_default(desc.radix0, N0), radix_or_default(desc.radix1, N1),
+                     sign, target, desc);
 }
 
 ComplexFunc fft2d_r2c(Func r,
                       int N0, int N1,
                       const Target& target,
                       const Fft2dDesc& desc) {
-    return fft2d_r2c(r, radix_factor(N0), radix_factor(N1), target, desc);
+    return fft2d_r2c(r, radix_or_default(desc.radix0, N0), radix_or_default(desc.radix1, N1),
+                     target, desc);
 }
 
 Func fft2d_c2r(ComplexFunc c,
                int N0, int N1,
                const Target& target,
                const Fft2dDesc& desc) {
-    return fft2d_c2r(c, radix_factor(N0), radix_factor(N1), target, desc);
+    return fft2d_c2r(c, radix_or_default(desc.radix0, N0), radix_or_default(desc.radix1, N1),
+                     target, desc);
+}
+
+ComplexFunc fft1d_c2c(ComplexFunc x,
+                      int N,
+                      int sign,
+                      const Target& target,
+                      const Fft2dDesc& desc) {
+    vector<int> R0, R1;
+    if (!desc.radix0.empty()) {
+        R0 = desc.radix0;
+        R1 = desc.radix1;
+        assert(product(R0) * product(R1) == N && "Radix factorization does not match the FFT size.");
+    } else {
+        int N0 = four_step_split(N);
+        if (N0 > 1 && (x.dimensions() == 1 || N >= kFourStepMinSize)) {
+            R0 = radix_factor(N0);
+            R1 = radix_factor(N / N0);
+        } else {
+            R0 = radix_factor(N);
+        }
+    }
+    return fft1d_c2c(x, R0, R1, sign, target, desc);
+}
+
+namespace {
+
+// A plan for computing an FFT, and how long it took.
+struct FftPlan {
+    vector<int> R0, R1;
+    bool parallel;
+    double time;
+};
+
+// Plans found so far, keyed by a description of the FFT and target.
+std::map<string, FftPlan> plan_cache;
+std::mutex plan_cache_mutex;
+
+bool find_plan(const string &key, FftPlan *plan) {
+    std::lock_guard<std::mutex> lock(plan_cache_mutex);
+    auto i = plan_cache.find(key);
+    if (i == plan_cache.end()) {
+        return false;
+    }
+    *plan = i->second;
+    return true;
+}
+
+void add_plan(const string &key, const FftPlan &plan) {
+    std::lock_guard<std::mutex> lock(plan_cache_mutex);
+    plan_cache[key] = plan;
+}
+
+Fft2dDesc apply_plan(Fft2dDesc desc, const FftPlan &plan) {
+    desc.radix0 = plan.R0;
+    desc.radix1 = plan.R1;
+    desc.parallel = plan.parallel;
+    return desc;
+}
+
+// The radices the planner tries factoring each dimension into.
+const int kPlanRadices[] = { 8, 6, 4, 3, 2 };
+
+// The maximum number of alternatives of each kind the planner times.
+const size_t kMaxPlanCandidates = 6;
+
+// Find the factorizations of N into the radices above, with the radices in
+// non-increasing order.
+void radix_factorizations(int N, int max_radix, vector<int> &R, vector<vector<int>> &result) {
+    if (N == 1) {
+        result.push_back(R);
+        return;
+    }
+    bool factored = false;
+    for (int r : kPlanRadices) {
+        if (r <= max_radix && N % r == 0 && result.size() < 256) {
+            factored = true;
+            R.push_back(r);
+            radix_factorizations(N / r, r, R, result);
+            R.pop_back();
+        }
+    }
+    if (!factored) {
+        // If there are still factors left over, just include them as a radix.
+        R.push_back(N);
+        result.push_back(R);
+        R.pop_back();
+    }
+}
+
+// Get the factorizations of N the planner should try. The default
+// factorization is always first, followed by those with the fewest passes.
+vector<vector<int>> radix_candidates(int N) {
+    vector<vector<int>> all;
+    vector<int> R;
+    radix_factorizations(N, N, R, all);
+    std::stable_sort(all.begin(), all.end(),
+                     [](const vector<int> &a, const vector<int> &b) { return a.size() < b.size(); });
+
+    vector<vector<int>> candidates = { radix_factor(N) };
+    for (const vector<int> &i : all) {
+        if (candidates.size() >= kMaxPlanCandidates) {
+            break;
+        }
+        if (std::find(candidates.begin(), candidates.end(), i) == candidates.end()) {
+            candidates.push_back(i);
+        }
+    }
+    return candidates;
+}
+
+// Get the ways of splitting N into N0 x N1 for the four step algorithm that
+// the planner should try, which are those nearest to sqrt(N).
+vector<int> four_step_candidates(int N) {
+    vector<int> splits;
+    for (int N0 = 2; N0 <= N / 2; N0++) {
+        if (N % N0 == 0) {
+            splits.push_back(N0);
+        }
+    }
+    auto distance = [=](int N0) { return std::abs(std::log((double)N0 * N0 / N)); };
+    std::stable_sort(splits.begin(), splits.end(),
+                     [&](int a, int b) { return distance(a) < distance(b); });
+    if (splits.size() > kMaxPlanCandidates) {
+        splits.resize(kMaxPlanCandidates);
+    }
+    return splits;
+}
+
+// Compile and run an FFT producing output of the given size, and return the
+// time it takes in seconds.
+double time_fft(Func fft, const vector<int> &size, const Target& target) {
+    fft.compile_jit(target);
+    Realization R = fft.realize(size, target);
+
+    // Repeat the FFT enough times to get a measurable time, and take the
+    // minimum over a few samples to reduce noise.
+    const double min_sample_time = 1e-3;
+    int iterations = 1;
+    double best = std::numeric_limits<double>::infinity();
+    for (int sample = 0; sample < 5; sample++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            fft.realize(R, target);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double>(end - start).count() / iterations;
+        best = std::min(best, t);
+        if (sample == 0 && t > 0) {
+            iterations = std::max(1, (int)(min_sample_time / t));
+        }
+    }
+    return best;
+}
+
+typedef std::function<Func(const Fft2dDesc&)> FftBuilder;
+
+// Find the fastest plan for an FFT by trying each of the candidate
+// factorizations of dimension 0, then of dimension 1 with the best of those,
+// and then toggling parallelism within the FFT.
+FftPlan search_plans(const FftBuilder &build,
+                     const vector<int> &size,
+                     const Target& target,
+                     const Fft2dDesc& desc,
+                     const vector<vector<int>> &R0_candidates,
+                     const vector<vector<int>> &R1_candidates) {
+    Fft2dDesc best = desc;
+    best.radix0 = R0_candidates.front();
+    best.radix1 = R1_candidates.front();
+    double best_time = time_fft(build(best), size, target);
+
+    auto try_plan = [&](const Fft2dDesc &candidate) {
+        double t = time_fft(build(candidate), size, target);
+        if (t < best_time) {
+            best = candidate;
+            best_time = t;
+        }
+    };
+
+    for (size_t i = 1; i < R0_candidates.size(); i++) {
+        Fft2dDesc candidate = best;
+        candidate.radix0 = R0_candidates[i];
+        try_plan(candidate);
+    }
+    for (size_t i = 1; i < R1_candidates.size(); i++) {
+        Fft2dDesc candidate = best;
+        candidate.radix1 = R1_candidates[i];
+        try_plan(candidate);
+    }
+    Fft2dDesc candidate = best;
+    candidate.parallel = !best.parallel;
+    try_plan(candidate);
+
+    return FftPlan{best.radix0, best.radix1, best.parallel, best_time};
+}
+
+}  // namespace
+
+Fft2dDesc fft2d_plan(FftType type, int N0, int N1,
+                     const Target& target,
+                     const Fft2dDesc& desc,
+                     int batch) {
+    std::stringstream key;
+    key << "fft2d_" << (int)type << "_" << N0 << "x" << N1 << "_" << batch
+        << "_" << desc.vector_width << "_" << target.to_string();
+
+    FftPlan plan;
+    if (find_plan(key.str(), &plan)) {
+        return apply_plan(desc, plan);
+    }
+
+    // The time to compute the FFT doesn't depend on the data, so time FFTs
+    // of a buffer of zeros, reading the same input for each FFT in the batch.
+    Image<float> zeros(N0, N1);
+    for (int n1 = 0; n1 < N1; n1++) {
+        for (int n0 = 0; n0 < N0; n0++) {
+            zeros(n0, n1) = 0.0f;
+        }
+    }
+
+    Var n0("n0"), n1("n1"), b("b");
+    FftBuilder build = [&](const Fft2dDesc &candidate) -> Func {
+        switch (type) {
+        case FftType::C2C: {
+            ComplexFunc c("c");
+            c(n0, n1, b) = ComplexExpr(zeros(n0, n1), zeros(n0, n1));
+            return fft2d_c2c(c, N0, N1, -1, target, candidate);
+        }
+        case FftType::R2C: {
+            Func r("r");
+            r(n0, n1, b) = zeros(n0, n1);
+            return fft2d_r2c(r, N0, N1, target, candidate);
+        }
+        case FftType::C2R:
+        default: {
+            ComplexFunc c("c");
+            c(n0, n1, b) = ComplexExpr(zeros(n0, n1), zeros(n0, n1));
+            return fft2d_c2r(c, N0, N1, target, candidate);
+        }
+        }
+    };
+    vector<int> size = { N0, type == FftType::R2C ? N1 / 2 + 1 : N1, batch };
+
+    plan = search_plans(build, size, target, desc, radix_candidates(N0), radix_candidates(N1));
+    add_plan(key.str(), plan);
+    return apply_plan(desc, plan);
+}
+
+Fft2dDesc fft1d_plan(int N,
+                     const Target& target,
+                     const Fft2dDesc& desc,
+                     int batch) {
+    std::stringstream key;
+    key << "fft1d_" << N << "_" << batch << "_" << target.to_string();
+
+    FftPlan plan;
+    if (find_plan(key.str(), &plan)) {
+        return apply_plan(desc, plan);
+    }
+
+    // As above, time FFTs of zeros.
+    Image<float> zeros(N);
+    for (int n = 0; n < N; n++) {
+        zeros(n) = 0.0f;
+    }
+
+    Var n("n"), row("row");
+    FftBuilder build = [&](const Fft2dDesc &candidate) -> Func {
+        ComplexFunc x("x");
+        if (batch > 1) {
+            x(n, row) = ComplexExpr(zeros(n), zeros(n));
+        } else {
+            x(n) = ComplexExpr(zeros(n), zeros(n));
+        }
+        return fft1d_c2c(x, N, -1, target, candidate);
+    };
+    vector<int> size = { N };
+    if (batch > 1) {
+        size.push_back(batch);
+    }
+
+    // A prime N can't be split for the four step algorithm, so a single FFT
+    // of that size must be computed directly.
+    vector<int> splits = four_step_candidates(N);
+
+    bool found = false;
+    if (batch > 1 || splits.empty()) {
+        // Try transforming the rows directly.
+        plan = search_plans(build, size, target, desc, radix_candidates(N), { vector<int>() });
+        found = true;
+    }
+
+    // Find the best way to split N for the four step algorithm, using the
+    // default factorization of each pass, and then search for the best plan
+    // with that split.
+    int best_N0 = 0;
+    double best_time = std::numeric_limits<double>::infinity();
+    for (int N0 : splits) {
+        Fft2dDesc candidate = desc;
+        candidate.radix0 = radix_factor(N0);
+        candidate.radix1 = radix_factor(N / N0);
+        double t = time_fft(build(candidate), size, target);
+        if (t < best_time) {
+            best_N0 = N0;
+            best_time = t;
+        }
+    }
+    if (best_N0 > 0) {
+        FftPlan four_step = search_plans(build, size, target, desc,
+                                         radix_candidates(best_N0),
+                                         radix_candidates(N / best_N0));
+        if (!found || four_step.time < plan.time) {
+            plan = four_step;
+            found = true;
+        }
+    }
+    assert(found);
+
+    add_plan(key.str(), plan);
+    return apply_plan(desc, plan);
 }
@@ -36,8 +36,20 @@ struct Fft2dDesc {
 
     // A name to prepend to the name of the Funcs the FFT defines.
     std::string name = "";
+
+    // The radix factorizations to use for dimensions 0 and 1 of the FFT,
+    // usually found by fft2d_plan or fft1d_plan. If these are empty, a
+    // default factorization of each dimension is used. For a 1D FFT of size N
+    // computed with the four step algorithm, radix0 and radix1 factor N0 and
+    // N1 where N = N0 * N1 (see fft1d_c2c); if radix1 is empty and radix0 is
+    // not, the 1D FFT is computed directly.
+    std::vector<int> radix0;
+    std::vector<int> radix1;
 };
 
+// The types of FFT that can be planned.
+enum class FftType { C2C, R2C, C2R };
+
 // Compute the N0 x N1 2D complex DFT of the first 2 dimensions of a complex
 // valued function x. The first 2 dimensions of x should be defined on at least
 // [0, N0) and [0, N1) for dimensions 0, 1, respectively. sign = -1 indicates a
@@ -66,4 +78,43 @@ Halide::Func fft2d_c2r(ComplexFunc c, int N0, int N1,
                        const Halide::Target& target,
                        const Fft2dDesc& desc = Fft2dDesc());
 
+// Compute the N point complex DFT of dimension 0 of x. Any further dimensions
+// of x are treated as a batch of independent rows to transform. If N is
+// large, or x has only one dimension, the FFT is computed with the four step
+// algorithm: x is viewed as an N0 x N1 matrix, the columns are transformed,
+// multiplied by twiddle factors, and then the rows are transformed. Each of
+// these passes is vectorized across the other dimension of the matrix, and
+// parallelized if desc.parallel is set. Otherwise, including when N is prime
+// and can't be split, the rows of x are transformed directly, in vectorized
+// groups, which requires x to be defined for a number of rows rounded up to a
+// multiple of the vector width. A single row is repeated to fill a group. In
+// either case, the intermediate results are computed at the first dimension of x
+// after the rows, so the caller may parallelize the rows of the result.
+ComplexFunc fft1d_c2c(ComplexFunc x, int N, int sign,
+                      const Halide::Target& target,
+                      const Fft2dDesc& desc = Fft2dDesc());
+
+// Find the fastest way to compute an N0 x N1 2D FFT of the given type for
+// target, by JIT compiling and timing FFTs with alternative radix
+// factorizations of each dimension, with and without parallelism within the
+// FFT. batch is the number of FFTs computed per realization when timing, and
+// should reflect how the FFT will be used. The returned description is desc
+// with radix0, radix1 and parallel set to the best plan found. Plans are
+// cached, so planning the same FFT again is cheap. target must be able to
+// run on the host.
+Fft2dDesc fft2d_plan(FftType type, int N0, int N1,
+                     const Halide::Target& target,
+                     const Fft2dDesc& desc = Fft2dDesc(),
+                     int batch = 1);
+
+// Find the fastest way to compute fft1d_c2c of size N for target, on batch
+// rows at once. This considers computing the rows directly (if batch > 1, or
+// N is prime) and four step algorithms for the divisors of N near sqrt(N), as
+// well as alternative radix factorizations of each pass. The result is cached as for
+// fft2d_plan.
+Fft2dDesc fft1d_plan(int N,
+                     const Halide::Target& target,
+                     const Fft2dDesc& desc = Fft2dDesc(),
+                     int batch = 1);
+
 #endif
@@ -1,16 +1,22 @@
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 #include "generated/fft_forward_r2c.h"
 #include "generated/fft_inverse_c2r.h"
 #include "generated/fft_forward_c2c.h"
 #include "generated/fft_inverse_c2c.h"
+#include "generated/fft_forward_c2c_1d.h"
 
 namespace {
 const float kPi = 3.14159265358979310000f;
 
 const size_t kSize = 16;
+
+// The size of the batched 1D FFT, which isn't a power of two.
+const int k1dSize = 60;
 }
 
 // Make a buffer_t for real input to the FFT.
@@ -28,16 +34,16 @@ buffer_t real_buffer(float *storage, int32_t y_size = kSize) {
 }
 
 // Make a buffer_t for complex input to the FFT.
-buffer_t complex_buffer(float *storage, int32_t y_size = kSize) {
+buffer_t complex_buffer(float *storage, int32_t y_size = kSize, int32_t x_size = kSize) {
     buffer_t buf = {0};
 
     buf.host = (uint8_t *)storage;
     buf.extent[0] = 2;
     buf.stride[0] = 1;
-    buf.extent[1] = kSize;
+    buf.extent[1] = x_size;
     buf.stride[1] = 2;
     buf.extent[2] = y_size;
-    buf.stride[2] = kSize * 2;
+    buf.stride[2] = x_size * 2;
     buf.elem_size = sizeof(float);
 
     return buf;
@@ -284,5 +290,52 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Forward complex to complex 1D test, of a batch of rows, compared with
+    // a naive DFT.
+    {
+        std::cout << "Forward complex to complex 1D test." << std::endl;
+
+        const int rows = 7;
+        std::vector<float> input_1d(k1dSize * rows * 2), output_1d(k1dSize * rows * 2);
+        for (int j = 0; j < rows; j++) {
+            for (int i = 0; i < k1dSize; i++) {
+                input_1d[(i + j * k1dSize) * 2] = cos(0.7f * i + 1.3f * j * j);
+                input_1d[(i + j * k1dSize) * 2 + 1] = sin(0.3f * i * i + 0.9f * j);
+            }
+        }
+
+        buffer_t in = complex_buffer(&input_1d[0], rows, k1dSize);
+        buffer_t out = complex_buffer(&output_1d[0], rows, k1dSize);
+
+        int halide_result;
+        halide_result = fft_forward_c2c_1d(&in, &out);
+        if (halide_result != 0) {
+            std::cerr << "fft_forward_c2c_1d failed returning " << halide_result << std::endl;
+            exit(1);
+        }
+
+        for (int j = 0; j < rows; j++) {
+            for (int k = 0; k < k1dSize; k++) {
+                double real_expected = 0, imaginary_expected = 0;
+                for (int i = 0; i < k1dSize; i++) {
+                    double w = -2 * M_PI * ((i * k) % k1dSize) / k1dSize;
+                    double re = input_1d[(i + j * k1dSize) * 2];
+                    double im = input_1d[(i + j * k1dSize) * 2 + 1];
+                    real_expected += re * cos(w) - im * sin(w);
+                    imaginary_expected += re * sin(w) + im * cos(w);
+                }
+                float real_sample = output_1d[(k + j * k1dSize) * 2];
+                float imaginary_sample = output_1d[(k + j * k1dSize) * 2 + 1];
+                if (fabs(real_sample - real_expected) > .001 ||
+                    fabs(imaginary_sample - imaginary_expected) > .001) {
+                    std::cerr << "fft_forward_c2c_1d mismatch at (" << k << ", " << j << ") ("
+                              << real_sample << ", " << imaginary_sample << ") vs. ("
+                              << real_expected << ", " << imaginary_expected << ")" << std::endl;
+                    exit(1);
+                }
+            }
+        }
+    }
+
     exit(0);
 }
@@ -49,6 +49,11 @@ public:
     // if there is no outer loop around FFTs that can be parallelized.
     GeneratorParam<bool> parallel{"parallel", false};
 
+    // Time alternative radix factorizations and schedules of the FFT when
+    // building it, and use the fastest. This is only meaningful if the
+    // target is the host, or close enough to it.
+    GeneratorParam<bool> plan{"plan", false};
+
     // Indicates forward or inverse Fourier transform --
     // "samples_to_frequency" maps to a forward FFT. (Other packages sometimes call this a sign of -1)
     // "frequency_to_samples" maps to a forward FFT. (Other packages sometimes call this a sign of +1)
@@ -64,7 +69,8 @@ public:
 
     // Size of first dimension, required to be greater than zero.
     GeneratorParam<int32_t> size0{"size0", 1};
-    // Size of second dimension, may be zero for 1D FFT.
+    // Size of second dimension, may be zero for 1D FFT. A 1D FFT transforms
+    // each row (the second dimension) of the input independently.
     GeneratorParam<int32_t> size1{"size1", 0};
     // TODO(zalman): Add support for 3D and maybe 4D FFTs
 
@@ -90,6 +96,24 @@ public:
 
         desc.gain = gain;
         desc.vector_width = vector_width;
+        desc.parallel = parallel;
+
+        if (size1 == 0) {
+            return build_1d(desc);
+        }
+
+        if (plan) {
+            FftType type = FftType::C2C;
+            if (input_number_type == FFTNumberType::Real &&
+                direction == FFTDirection::SamplesToFrequency) {
+                type = FftType::R2C;
+            } else if (input_number_type == FFTNumberType::Complex &&
+                       output_number_type == FFTNumberType::Real &&
+                       direction == FFTDirection::FrequencyToSamples) {
+                type = FftType::C2R;
+            }
+            desc = fft2d_plan(type, size0, size1, target, desc);
+        }
 
         // The logic below calls the specialized r2c or c2r version if
         // applicable to take advantae of better scheduling. It is
@@ -144,6 +168,55 @@ public:
 
         return result;
     }
+
+    // Build a batch of 1D FFTs of the rows of the input. These are always
+    // complex, so a real input is treated as complex with zero imaginary part.
+    Func build_1d(Fft2dDesc desc) {
+        Var c{"c"}, x{"x"}, y{"y"};
+
+        int sign = (direction == FFTDirection::SamplesToFrequency) ? -1 : 1;
+
+        // Rows may be transformed in vectorized groups, so clamp the row
+        // index to the rows of the input.
+        ComplexFunc in;
+        if (input_number_type == FFTNumberType::Real) {
+            input = ImageParam(Float(32), 2, "input");
+            Func clamped = BoundaryConditions::repeat_edge(input,
+                {{Expr(), Expr()}, {input.min(1), input.extent(1)}});
+            in(x, y) = ComplexExpr(clamped(x, y), 0);
+        } else {
+            input = ImageParam(Float(32), 3, "input");
+            input.set_bounds(0, 0, 2);
+            input.set_stride(1, 2);
+            Func clamped = BoundaryConditions::repeat_edge(input,
+                {{Expr(), Expr()}, {Expr(), Expr()}, {input.min(2), input.extent(2)}});
+            in(x, y) = ComplexExpr(clamped(0, x, y), clamped(1, x, y));
+        }
+
+        if (plan) {
+            // Plan for enough rows to fill a few vectors.
+            desc = fft1d_plan(size0, target, desc, 4 * natural_vector_size<float>());
+        }
+
+        ComplexFunc complex_result = fft1d_c2c(in, size0, sign, target, desc);
+
+        Func result;
+        if (output_number_type == FFTNumberType::Real) {
+            result(x, y) = re(complex_result(x, y));
+        } else {
+            result(c, x, y) = select(c == 0, re(complex_result(x, y)), im(complex_result(x, y)));
+            result.output_buffer().set_bounds(0, 0, 2);
+            result.output_buffer().set_stride(1, 2);
+        }
+
+        // Parallelize over groups of rows.
+        Var yo{"yo"};
+        result.split(y, yo, y, natural_vector_size<float>(), TailStrategy::GuardWithIf)
+            .parallel(yo);
+        complex_result.compute_at(result, yo);
+
+        return result;
+    }
 };
 
 Halide::RegisterGenerator<FFTGenerator> register_fft{"fft"};
@@ -4,6 +4,7 @@
 // algorithms.
 
 #include "Halide.h"
+#include <cmath>
 #include <cstdio>
 #include <vector>
 #include "fft.h"
@@ -35,6 +36,108 @@ double log2(double x) {
     return log(x)/log(2.0);
 }
 
+// Benchmark a Func computing reps FFTs of size extent0 x extent1, returning
+// the time per FFT in microseconds. All reps write to the same place in
+// memory, see the notes on R_c2c below.
+double benchmark_fft(Func fft, int extent0, int extent1, int reps, int samples,
+                     const Target &target) {
+    Realization R = fft.realize(extent0, extent1, reps, target);
+    for (size_t i = 0; i < R.size(); i++) {
+        R[i].raw_buffer()->stride[2] = 0;
+    }
+    return benchmark(samples, 1, [&]() { fft.realize(R, target); })*1e6/reps;
+}
+
+// Benchmark a Func computing 1D FFTs with output of the given size, returning
+// the time per realization in microseconds.
+double benchmark_fft_1d(Func fft, std::vector<int> size, int samples, int iterations,
+                        const Target &target) {
+    Realization R = fft.realize(size, target);
+    return benchmark(samples, iterations, [&]() { fft.realize(R, target); })*1e6;
+}
+
+// Describe the radix factorizations and parallelism of a plan.
+std::string plan_to_string(const Fft2dDesc &desc) {
+    std::string result;
+    for (const std::vector<int> &R : { desc.radix0, desc.radix1 }) {
+        if (R.empty()) {
+            continue;
+        }
+        if (!result.empty()) {
+            result += " | ";
+        }
+        for (size_t i = 0; i < R.size(); i++) {
+            result += (i > 0 ? "x" : "") + std::to_string(R[i]);
+        }
+    }
+    if (desc.parallel) {
+        result += " parallel";
+    }
+    return result;
+}
+
+// Compare 1D FFTs of size N with a naive DFT, for a single row and for a
+// batch of rows, using the default radix factorization or, if plan is set,
+// the ones found by fft1d_plan.
+bool check_fft1d(int N, bool plan, const Target &target) {
+    const int rows = 5;
+    Image<float> re_in(N, rows), im_in(N, rows);
+    for (int r = 0; r < rows; r++) {
+        for (int n = 0; n < N; n++) {
+            re_in(n, r) = (float)rand()/(float)RAND_MAX;
+            im_in(n, r) = (float)rand()/(float)RAND_MAX;
+        }
+    }
+
+    Fft2dDesc single_desc, batch_desc;
+    if (plan) {
+        single_desc = fft1d_plan(N, target, single_desc);
+        batch_desc = fft1d_plan(N, target, batch_desc, rows);
+    }
+
+    ComplexFunc single_in;
+    single_in(x) = {re_in(x, 0), im_in(x, 0)};
+    Realization single = Func(fft1d_c2c(single_in, N, -1, target, single_desc)).realize(N, target);
+
+    // The rows may be transformed in vectorized groups, so clamp the rows we
+    // read to the input.
+    ComplexFunc batch_in;
+    Expr row = clamp(y, 0, rows - 1);
+    batch_in(x, y) = {re_in(x, row), im_in(x, row)};
+    Realization batch = Func(fft1d_c2c(batch_in, N, -1, target, batch_desc)).realize(N, rows, target);
+
+    Image<float> single_re = single[0], single_im = single[1];
+    Image<float> batch_re = batch[0], batch_im = batch[1];
+
+    // The inputs are in [0, 1], so the outputs are at most about N.
+    const double tolerance = 1e-5 * N + 1e-4;
+    for (int r = 0; r < rows; r++) {
+        for (int k = 0; k < N; k++) {
+            double correct_re = 0, correct_im = 0;
+            for (int n = 0; n < N; n++) {
+                double w = -2 * M_PI * (double)((int64_t)n * k % N) / N;
+                correct_re += re_in(n, r) * std::cos(w) - im_in(n, r) * std::sin(w);
+                correct_im += re_in(n, r) * std::sin(w) + im_in(n, r) * std::cos(w);
+            }
+            if (r == 0 && (std::abs(single_re(k) - correct_re) > tolerance ||
+                           std::abs(single_im(k) - correct_im) > tolerance)) {
+                printf("1D FFT of size %d (%s): X(%d) = (%f, %f) instead of (%f, %f)\n",
+                       N, plan_to_string(single_desc).c_str(), k,
+                       single_re(k), single_im(k), correct_re, correct_im);
+                return false;
+            }
+            if (std::abs(batch_re(k, r) - correct_re) > tolerance ||
+                std::abs(batch_im(k, r) - correct_im) > tolerance) {
+                printf("1D FFT of %d rows of size %d (%s): X(%d, %d) = (%f, %f) instead of (%f, %f)\n",
+                       rows, N, plan_to_string(batch_desc).c_str(), k, r,
+                       batch_re(k, r), batch_im(k, r), correct_re, correct_im);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 int main(int argc, char **argv) {
     int W = 32;
     int H = 32;
@@ -127,6 +230,20 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Check the 1D FFTs, including sizes computed with the four step
+    // algorithm (1024, and any single row that isn't prime) and a prime size
+    // that must be computed directly.
+    for (int N : { 16, 60, 97, 1024 }) {
+        if (!check_fft1d(N, false, target)) {
+            return -1;
+        }
+    }
+    for (int N : { 60, 97, 1024 }) {
+        if (!check_fft1d(N, true, target)) {
+            return -1;
+        }
+    }
+
     // For a description of the methodology used here, see
     // http://www.fftw.org/speed/method.html
 
@@ -227,6 +344,63 @@ int main(int argc, char **argv) {
            2.5*W*H*(log2(W) + log2(H))/fftw_t,
            fftw_t / halide_t);
 
+    // Compare the fixed radix factorizations used above with the plans found
+    // by timing alternatives.
+    const int plan_batch = 16;
+    Fft2dDesc c2c_plan_desc = fft2d_plan(FftType::C2C, W, H, target, fwd_desc, plan_batch);
+    Fft2dDesc r2c_plan_desc = fft2d_plan(FftType::R2C, W, H, target, fwd_desc, plan_batch);
+    Fft2dDesc c2r_plan_desc = fft2d_plan(FftType::C2R, W, H, target, inv_desc, plan_batch);
+
+    printf("\n%12s %10s %10s %10s  %s\n", "DFT type", "Fixed (us)", "Plan (us)", "Speedup", "Plan");
+
+    double fixed_t = benchmark_fft(fft2d_c2c(c2c_in, W, H, -1, target, fwd_desc), W, H, reps, samples, target);
+    double plan_t = benchmark_fft(fft2d_c2c(c2c_in, W, H, -1, target, c2c_plan_desc), W, H, reps, samples, target);
+    printf("%12s %10.3f %10.3f %10.3g  %s\n", "c2c", fixed_t, plan_t, fixed_t / plan_t,
+           plan_to_string(c2c_plan_desc).c_str());
+
+    fixed_t = benchmark_fft(fft2d_r2c(r2c_in, W, H, target, fwd_desc), W, H/2 + 1, reps, samples, target);
+    plan_t = benchmark_fft(fft2d_r2c(r2c_in, W, H, target, r2c_plan_desc), W, H/2 + 1, reps, samples, target);
+    printf("%12s %10.3f %10.3f %10.3g  %s\n", "r2c", fixed_t, plan_t, fixed_t / plan_t,
+           plan_to_string(r2c_plan_desc).c_str());
+
+    fixed_t = benchmark_fft(fft2d_c2r(c2r_in, W, H, target, inv_desc), W, H, reps, samples, target);
+    plan_t = benchmark_fft(fft2d_c2r(c2r_in, W, H, target, c2r_plan_desc), W, H, reps, samples, target);
+    printf("%12s %10.3f %10.3f %10.3g  %s\n", "c2r", fixed_t, plan_t, fixed_t / plan_t,
+           plan_to_string(c2r_plan_desc).c_str());
+
+    // 1D FFTs: one large FFT of size W*H, computed with the four step
+    // algorithm, and a batch of H FFTs of size W, one per row.
+    const int reps_1d = 10;
+    Image<float> re_in_1d = lambda(x, 0.0f).realize(W * H);
+    ComplexFunc c1d_in;
+    c1d_in(x) = {re_in_1d(x), re_in_1d(x)};
+    Fft2dDesc c1d_plan_desc = fft1d_plan(W * H, target, fwd_desc);
+
+    fixed_t = benchmark_fft_1d(fft1d_c2c(c1d_in, W * H, -1, target, fwd_desc), {W * H}, samples, reps_1d, target);
+    plan_t = benchmark_fft_1d(fft1d_c2c(c1d_in, W * H, -1, target, c1d_plan_desc), {W * H}, samples, reps_1d, target);
+    printf("%12s %10.3f %10.3f %10.3g  %s\n", "c2c 1D", fixed_t, plan_t, fixed_t / plan_t,
+           plan_to_string(c1d_plan_desc).c_str());
+#ifdef WITH_FFTW
+    std::vector<std::pair<float, float>> fftw_1d1(W * H);
+    std::vector<std::pair<float, float>> fftw_1d2(W * H);
+    fftwf_plan c1d_plan = fftwf_plan_dft_1d(W * H, (fftwf_complex*)&fftw_1d1[0], (fftwf_complex*)&fftw_1d2[0], FFTW_FORWARD, FFTW_EXHAUSTIVE);
+    fftw_t = benchmark(samples, reps_1d, [&]() { fftwf_execute(c1d_plan); })*1e6;
+    printf("%12s %10.3f %10.2f (FFTW)\n", "c2c 1D", fftw_t, 5*W*H*log2(W*H)/fftw_t);
+    fftwf_destroy_plan(c1d_plan);
+#endif
+
+    // The rows may be transformed in vectorized groups, so clamp the rows we
+    // read to the input.
+    ComplexFunc rows_in;
+    Expr row = clamp(y, 0, H - 1);
+    rows_in(x, y) = {re_in(x, row), im_in(x, row)};
+    Fft2dDesc rows_plan_desc = fft1d_plan(W, target, fwd_desc, H);
+
+    fixed_t = benchmark_fft_1d(fft1d_c2c(rows_in, W, -1, target, fwd_desc), {W, H}, samples, reps_1d, target);
+    plan_t = benchmark_fft_1d(fft1d_c2c(rows_in, W, -1, target, rows_plan_desc), {W, H}, samples, reps_1d, target);
+    printf("%12s %10.3f %10.3f %10.3g  %s\n", "c2c 1D rows", fixed_t, plan_t, fixed_t / plan_t,
+           plan_to_string(rows_plan_desc).c_str());
+
 #ifdef WITH_FFTW
     fftwf_destroy_plan(c2c_plan);
     fftwf_destroy_plan(r2c_plan);
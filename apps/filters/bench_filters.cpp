@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "separable_convolution.h"
+#include "separable_convolution_naive.h"
+#include "gaussian_blur.h"
+#include "gaussian_blur_naive.h"
+#include "box_blur.h"
+#include "box_blur_naive.h"
+#include "first_order_iir.h"
+#include "first_order_iir_naive.h"
+#include "second_order_iir.h"
+#include "second_order_iir_naive.h"
+#include "deriche_blur.h"
+#include "deriche_blur_naive.h"
+
+#include "halide_image.h"
+#include "schedule_benchmark.h"
+
+using namespace Halide::Tools;
+
+// Check that the tuned and naive schedules of each filter agree, and
+// that they preserve a constant image, check the recursive filters
+// against a scalar reference and the Deriche blur against a Gaussian,
+// then compare their throughput over several thread counts.
+
+const int width = 1920, height = 1080, channels = 3;
+
+typedef std::function<int(buffer_t *, buffer_t *)> Filter;
+
+float max_difference(const Image<float> &a, const Image<float> &b) {
+    float worst = 0;
+    for (int c = 0; c < channels; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                worst = std::max(worst, std::abs(a(x, y, c) - b(x, y, c)));
+            }
+        }
+    }
+    return worst;
+}
+
+int check(const char *name, Filter tuned, Filter naive,
+          Image<float> &input, Image<float> &constant) {
+    Image<float> tuned_output(width, height, channels), naive_output(width, height, channels);
+    if (tuned(input, tuned_output) != 0 || naive(input, naive_output) != 0) {
+        printf("%s failed\n", name);
+        return -1;
+    }
+    float diff = max_difference(tuned_output, naive_output);
+    if (diff > 1e-4f) {
+        printf("The tuned and naive schedules of %s differ by %g\n", name, diff);
+        return -1;
+    }
+
+    tuned(constant, tuned_output);
+    diff = max_difference(constant, tuned_output);
+    if (diff > 1e-4f) {
+        printf("%s changed a constant image by %g\n", name, diff);
+        return -1;
+    }
+    return 0;
+}
+
+// A scalar reference for the recursive filters of filters.h, in double
+// precision, with the same boundary conditions.
+struct ReferenceRecursion {
+    std::vector<double> feedforward, feedback;
+    bool causal;
+};
+
+typedef std::vector<std::vector<ReferenceRecursion>> ReferenceFilter;
+
+// Apply a recursion to a line of samples.
+std::vector<double> reference_recurse(const std::vector<double> &in, const ReferenceRecursion &r) {
+    const int n = (int)in.size();
+    const int step = r.causal ? 1 : -1;
+
+    double feedforward_gain = 0, feedback_gain = 1;
+    for (double a : r.feedforward) {
+        feedforward_gain += a;
+    }
+    for (double b : r.feedback) {
+        feedback_gain -= b;
+    }
+    const double steady_state = in[r.causal ? 0 : n - 1] * feedforward_gain / feedback_gain;
+
+    std::vector<double> out(n);
+    for (int i = 0; i < n; i++) {
+        const int row = r.causal ? i : n - 1 - i;
+        double value = 0;
+        for (size_t j = 0; j < r.feedforward.size(); j++) {
+            int in_row = std::min(std::max(row - step * (int)j, 0), n - 1);
+            value += r.feedforward[j] * in[in_row];
+        }
+        for (size_t k = 0; k < r.feedback.size(); k++) {
+            int prev_row = row - step * (int)(k + 1);
+            value += r.feedback[k] * (prev_row >= 0 && prev_row < n ? out[prev_row] : steady_state);
+        }
+        out[row] = value;
+    }
+    return out;
+}
+
+// Apply each cascade of recursions of the filter to a line of
+// samples, and sum the results.
+std::vector<double> reference_filter_line(const std::vector<double> &in, const ReferenceFilter &filter) {
+    std::vector<double> result(in.size(), 0.0);
+    for (const std::vector<ReferenceRecursion> &branch : filter) {
+        std::vector<double> line = in;
+        for (const ReferenceRecursion &r : branch) {
+            line = reference_recurse(line, r);
+        }
+        for (size_t i = 0; i < line.size(); i++) {
+            result[i] += line[i];
+        }
+    }
+    return result;
+}
+
+// Filter the columns of the image, then the rows, as recursive_filter
+// does.
+Image<float> reference_filter(const Image<float> &in, const ReferenceFilter &filter) {
+    Image<float> out(width, height, channels);
+    std::vector<double> columns(width * height), line;
+    for (int c = 0; c < channels; c++) {
+        for (int x = 0; x < width; x++) {
+            line.resize(height);
+            for (int y = 0; y < height; y++) {
+                line[y] = in(x, y, c);
+            }
+            line = reference_filter_line(line, filter);
+            for (int y = 0; y < height; y++) {
+                columns[y * width + x] = line[y];
+            }
+        }
+        for (int y = 0; y < height; y++) {
+            line.assign(columns.begin() + y * width, columns.begin() + (y + 1) * width);
+            line = reference_filter_line(line, filter);
+            for (int x = 0; x < width; x++) {
+                out(x, y, c) = (float)line[x];
+            }
+        }
+    }
+    return out;
+}
+
+ReferenceFilter reference_deriche_filter(double sigma) {
+    const double alpha = 5.0 / (2.0 * std::sqrt(M_PI) * sigma);
+    const double e1 = std::exp(-alpha), e2 = std::exp(-2.0 * alpha);
+    const double k = (1.0 - e1) * (1.0 - e1) / (1.0 + 2.0 * alpha * e1 - e2);
+    const std::vector<double> feedback = {2.0 * e1, -e2};
+    ReferenceRecursion causal = {{k, k * e1 * (alpha - 1.0)}, feedback, true};
+    ReferenceRecursion anticausal = {{0.0, k * e1 * (alpha + 1.0), -k * e2}, feedback, false};
+    return {{causal}, {anticausal}};
+}
+
+int check_reference(const char *name, Filter tuned, const ReferenceFilter &filter,
+                    Image<float> &input) {
+    Image<float> output(width, height, channels);
+    if (tuned(input, output) != 0) {
+        printf("%s failed\n", name);
+        return -1;
+    }
+    float diff = max_difference(output, reference_filter(input, filter));
+    if (diff > 1e-4f) {
+        printf("%s differs from the scalar reference by %g\n", name, diff);
+        return -1;
+    }
+    return 0;
+}
+
+// The Deriche blur approximates a Gaussian with the kernel
+// (1 + alpha |x|) exp(-alpha |x|). Compare its response to an impulse
+// in the middle of the image with the normalized Gaussian kernel. For
+// sigma = 3 the peak of the Gaussian is 0.0177, and the second order
+// approximation is within 0.005 of it everywhere.
+int check_deriche_gaussian(Filter deriche, float sigma) {
+    const int cx = width / 2, cy = height / 2;
+    Image<float> impulse(width, height, channels), output(width, height, channels);
+    for (int c = 0; c < channels; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                impulse(x, y, c) = (x == cx && y == cy) ? 1.0f : 0.0f;
+            }
+        }
+    }
+    if (deriche(impulse, output) != 0) {
+        printf("deriche_blur failed\n");
+        return -1;
+    }
+
+    const int radius = (int)std::ceil(4 * sigma);
+    std::vector<double> gaussian(2 * radius + 1);
+    double total = 0;
+    for (int i = -radius; i <= radius; i++) {
+        gaussian[i + radius] = std::exp(-i * i / (2.0 * sigma * sigma));
+        total += gaussian[i + radius];
+    }
+
+    Image<float> expected(width, height, channels);
+    for (int c = 0; c < channels; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int dx = x - cx, dy = y - cy;
+                bool inside = std::abs(dx) <= radius && std::abs(dy) <= radius;
+                expected(x, y, c) = inside ?
+                    (float)(gaussian[dx + radius] * gaussian[dy + radius] / (total * total)) : 0.0f;
+            }
+        }
+    }
+    float diff = max_difference(output, expected);
+    if (diff > 5e-3f) {
+        printf("The impulse response of deriche_blur differs from a Gaussian by %g\n", diff);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Image<float> input(width, height, channels), constant(width, height, channels);
+    for (int c = 0; c < channels; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                input(x, y, c) = (float)rand() / RAND_MAX;
+                constant(x, y, c) = 0.5f;
+            }
+        }
+    }
+
+    // A binomial kernel for the rows and a box for the columns.
+    const float binomial[] = {1, 6, 15, 20, 15, 6, 1};
+    Image<float> kernel_x(7), kernel_y(5);
+    for (int i = 0; i < 7; i++) {
+        kernel_x(i) = binomial[i] / 64;
+    }
+    for (int i = 0; i < 5; i++) {
+        kernel_y(i) = 1.0f / 5;
+    }
+
+    // A second order Butterworth low pass filter, with a gain of one.
+    const float a1 = -1.1430f, a2 = 0.4128f;
+    const float b0 = (1 + a1 + a2) / 4, b1 = 2 * b0, b2 = b0;
+
+    struct {
+        const char *name;
+        const char *naive_name;
+        Filter tuned, naive;
+    } filters[] = {
+        {"separable_convolution", "separable_convolution_naive",
+         [&](buffer_t *in, buffer_t *out) { return separable_convolution(in, kernel_x, kernel_y, out); },
+         [&](buffer_t *in, buffer_t *out) { return separable_convolution_naive(in, kernel_x, kernel_y, out); }},
+        {"gaussian_blur", "gaussian_blur_naive",
+         [&](buffer_t *in, buffer_t *out) { return gaussian_blur(in, 3.0f, out); },
+         [&](buffer_t *in, buffer_t *out) { return gaussian_blur_naive(in, 3.0f, out); }},
+        {"box_blur", "box_blur_naive",
+         [&](buffer_t *in, buffer_t *out) { return box_blur(in, 4, out); },
+         [&](buffer_t *in, buffer_t *out) { return box_blur_naive(in, 4, out); }},
+        {"first_order_iir", "first_order_iir_naive",
+         [&](buffer_t *in, buffer_t *out) { return first_order_iir(in, 0.1f, out); },
+         [&](buffer_t *in, buffer_t *out) { return first_order_iir_naive(in, 0.1f, out); }},
+        {"second_order_iir", "second_order_iir_naive",
+         [&](buffer_t *in, buffer_t *out) { return second_order_iir(in, b0, b1, b2, a1, a2, out); },
+         [&](buffer_t *in, buffer_t *out) { return second_order_iir_naive(in, b0, b1, b2, a1, a2, out); }},
+        {"deriche_blur", "deriche_blur_naive",
+         [&](buffer_t *in, buffer_t *out) { return deriche_blur(in, 3.0f, out); },
+         [&](buffer_t *in, buffer_t *out) { return deriche_blur_naive(in, 3.0f, out); }},
+    };
+
+    for (auto &f : filters) {
+        if (check(f.name, f.tuned, f.naive, input, constant) != 0) {
+            return -1;
+        }
+    }
+
+    // The same filters as first_order_filter and second_order_filter.
+    ReferenceRecursion first_order_causal = {{0.1}, {0.9}, true};
+    ReferenceRecursion first_order_anticausal = {{0.1}, {0.9}, false};
+    ReferenceRecursion second_order_causal = {{b0, b1, b2}, {-a1, -a2}, true};
+    ReferenceRecursion second_order_anticausal = {{b0, b1, b2}, {-a1, -a2}, false};
+    ReferenceFilter first_order = {{first_order_causal, first_order_anticausal}};
+    ReferenceFilter second_order = {{second_order_causal, second_order_anticausal}};
+    if (check_reference("first_order_iir", filters[3].tuned, first_order, input) != 0 ||
+        check_reference("second_order_iir", filters[4].tuned, second_order, input) != 0 ||
+        check_reference("deriche_blur", filters[5].tuned, reference_deriche_filter(3.0), input) != 0 ||
+        check_deriche_gaussian(filters[5].tuned, 3.0f) != 0) {
+        return -1;
+    }
+
+    Image<float> output(width, height, channels);
+    schedule_benchmark::print_header();
+    for (auto &f : filters) {
+        std::vector<schedule_benchmark::Variant> variants = {
+            {f.name, [&]() { return f.tuned(input, output); }},
+            {f.naive_name, [&]() { return f.naive(input, output); }},
+        };
+        if (schedule_benchmark::compare(width, height, variants) != 0) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
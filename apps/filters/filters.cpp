@@ -0,0 +1,193 @@
+#include <cmath>
+
+#include "filters.h"
+
+using namespace Halide;
+
+namespace {
+
+const float pi = 3.14159265358979310000f;
+
+Var x("x"), y("y"), c("c");
+
+// Apply a recursion down the columns of f, which have the given
+// height.
+Func recurse_columns(Func f, Expr height, const Recursion &r, const std::string &name,
+                     bool tuned, int vector_width) {
+    Func result(name);
+    result(x, y, c) = undef<float>();
+
+    // The row computed at each step of the recursion, and the
+    // direction of the previous rows.
+    RDom ry(0, height);
+    Expr row = r.causal ? Expr(ry) : height - 1 - ry;
+    const int step = r.causal ? 1 : -1;
+
+    Expr value = 0.0f, feedforward_gain = 0.0f, feedback_gain = 1.0f;
+    for (size_t i = 0; i < r.feedforward.size(); i++) {
+        Expr in_row = row - step * (int)i;
+        if (i > 0) {
+            in_row = clamp(in_row, 0, height - 1);
+        }
+        value += r.feedforward[i] * f(x, in_row, c);
+        feedforward_gain += r.feedforward[i];
+    }
+    for (Expr b : r.feedback) {
+        feedback_gain -= b;
+    }
+
+    // The steady state response to the input at the start of the
+    // column stands in for the outputs before the start.
+    Expr start = f(x, r.causal ? 0 : height - 1, c);
+    Expr steady_state = start * (feedforward_gain / feedback_gain);
+    for (size_t k = 0; k < r.feedback.size(); k++) {
+        Expr prev_row = row - step * (int)(k + 1);
+        Expr prev = r.causal ?
+            select(prev_row >= 0, result(x, max(prev_row, 0), c), steady_state) :
+            select(prev_row < height, result(x, min(prev_row, height - 1), c), steady_state);
+        value += r.feedback[k] * prev;
+    }
+    result(x, row, c) = value;
+
+    if (tuned) {
+        // Step down the rows of the strip of columns, vectorized
+        // across the strip.
+        result.update().reorder(x, ry).vectorize(x, vector_width);
+    }
+    return result;
+}
+
+// Filter the columns of f, which have the given height, and return
+// the result transposed. The names of the Funcs start with prefix.
+Func filter_columns_transposed(Func f, Expr height, const RecursiveFilter &filter,
+                               const std::string &prefix, bool tuned, int vector_width) {
+    std::vector<Func> recursions;
+    Expr sum;
+    for (const std::vector<Recursion> &branch : filter) {
+        Func g = f;
+        for (const Recursion &r : branch) {
+            std::string name = prefix + (r.causal ? "causal_" : "anticausal_") +
+                std::to_string(recursions.size());
+            g = recurse_columns(g, height, r, name, tuned, vector_width);
+            recursions.push_back(g);
+        }
+        sum = sum.defined() ? sum + g(x, y, c) : g(x, y, c);
+    }
+
+    Func filtered(prefix + "filtered");
+    filtered(x, y, c) = sum;
+    Func transposed(prefix + "transposed");
+    transposed(x, y, c) = filtered(y, x, c);
+
+    if (tuned) {
+        // Each strip of rows of the transposed result is a strip of
+        // columns of the filter, which are filtered together. The
+        // transpose is done in square blocks, loaded as vectors from
+        // the rows of the filtered columns and stored as vectors in
+        // the rows of the result.
+        Var xo("xo"), yo("yo"), xi("xi"), yi("yi");
+        transposed.compute_root()
+            .tile(x, y, xo, yo, xi, yi, vector_width, vector_width)
+            .vectorize(xi).unroll(yi)
+            .parallel(yo).parallel(c);
+        filtered.compute_at(transposed, xo)
+            .vectorize(x, vector_width).unroll(y, vector_width);
+        for (Func r : recursions) {
+            r.compute_at(transposed, yo);
+        }
+    } else {
+        transposed.compute_root();
+        filtered.compute_root();
+        for (Func r : recursions) {
+            r.compute_root();
+        }
+    }
+    return transposed;
+}
+
+}  // namespace
+
+Func recursive_filter(Func f, Expr width, Expr height, const RecursiveFilter &filter,
+                      bool tuned, const Target &target) {
+    const int vector_width = target.natural_vector_size<float>();
+
+    // Filtering the columns of the transposed columns filters the
+    // rows, and transposes the result back.
+    Func columns = filter_columns_transposed(f, height, filter, "columns_", tuned, vector_width);
+    return filter_columns_transposed(columns, width, filter, "rows_", tuned, vector_width);
+}
+
+RecursiveFilter deriche_filter(Expr sigma) {
+    Expr alpha = 5.0f / (2.0f * std::sqrt(pi) * sigma);
+    Expr e1 = exp(-alpha);
+    Expr e2 = exp(-2.0f * alpha);
+    Expr k = (1.0f - e1) * (1.0f - e1) / (1.0f + 2.0f * alpha * e1 - e2);
+
+    std::vector<Expr> feedback = {2.0f * e1, -e2};
+    Recursion causal = {{k, k * e1 * (alpha - 1.0f)}, feedback, true};
+    Recursion anticausal = {{0.0f, k * e1 * (alpha + 1.0f), -k * e2}, feedback, false};
+    return {{causal}, {anticausal}};
+}
+
+RecursiveFilter first_order_filter(Expr alpha) {
+    Recursion causal = {{alpha}, {1.0f - alpha}, true};
+    Recursion anticausal = {{alpha}, {1.0f - alpha}, false};
+    return {{causal, anticausal}};
+}
+
+RecursiveFilter second_order_filter(Expr b0, Expr b1, Expr b2, Expr a1, Expr a2) {
+    Recursion causal = {{b0, b1, b2}, {-a1, -a2}, true};
+    Recursion anticausal = {{b0, b1, b2}, {-a1, -a2}, false};
+    return {{causal, anticausal}};
+}
+
+Func separable_convolution(Func f, Func kernel_x, Expr radius_x, Func kernel_y, Expr radius_y,
+                           bool tuned, const Target &target) {
+    const int vector_width = target.natural_vector_size<float>();
+
+    RDom rx(-radius_x, 2 * radius_x + 1), ry(-radius_y, 2 * radius_y + 1);
+    Func columns("convolve_columns");
+    columns(x, y, c) = sum(kernel_y(ry + radius_y) * f(x, y + ry, c));
+    Func rows("convolve_rows");
+    rows(x, y, c) = sum(kernel_x(rx + radius_x) * columns(x + rx, y, c));
+
+    if (tuned) {
+        // Each row of the output needs just the same row of the
+        // column convolution. Both are vectorized along the row, and
+        // strips of rows are computed in parallel.
+        Var yo("yo");
+        rows.compute_root()
+            .split(y, yo, y, 8)
+            .parallel(yo).parallel(c)
+            .vectorize(x, vector_width);
+        columns.compute_at(rows, y).vectorize(x, vector_width);
+    } else {
+        rows.compute_root();
+        columns.compute_root();
+    }
+    return rows;
+}
+
+Func gaussian_kernel(Expr sigma, Expr radius) {
+    Func weights("gaussian_weights");
+    Expr d = cast<float>(x - radius);
+    weights(x) = exp(-d * d / (2.0f * sigma * sigma));
+
+    RDom r(0, 2 * radius + 1);
+    Func total("gaussian_total");
+    total() = sum(weights(r));
+
+    Func kernel("gaussian_kernel");
+    kernel(x) = weights(x) / total();
+
+    weights.compute_root();
+    total.compute_root();
+    kernel.compute_root();
+    return kernel;
+}
+
+Func box_kernel(Expr radius) {
+    Func kernel("box_kernel");
+    kernel(x) = 1.0f / cast<float>(2 * radius + 1);
+    return kernel;
+}
@@ -0,0 +1,83 @@
+#ifndef HALIDE_FILTERS_H
+#define HALIDE_FILTERS_H
+
+#include <vector>
+
+#include <Halide.h>
+
+// Separable and recursive linear filters of the first two dimensions
+// of three dimensional Funcs of floats, such as images with the
+// channels in the third dimension. Each filter can be scheduled in two
+// ways:
+//
+// - tuned: the recursive filters run down strips of columns in
+//   parallel, vectorized across the columns of each strip, and write
+//   their results transposed in blocks, so that the rows are also
+//   filtered as columns. The convolutions are vectorized across the
+//   rows, and slide down parallel strips of the output.
+//
+// - naive: each stage is computed in full, one after the other, with
+//   the default loop order, which runs the recursive filters along
+//   each column in turn. This is the baseline for the benchmarks.
+
+// A linear recursive filter of a single column, running down the
+// column (causal) or up it (anticausal). For a causal filter, the
+// output at row y is
+//
+//   out(y) = sum_i feedforward[i] * in(y - i) + sum_k feedback[k] * out(y - 1 - k)
+//
+// An anticausal filter adds i and 1 + k instead. Rows of the input
+// outside the column take the value of the nearest row in it, and the
+// outputs before the first are taken to be the steady state response
+// to the first input, so the filter must be stable.
+struct Recursion {
+    std::vector<Halide::Expr> feedforward;
+    std::vector<Halide::Expr> feedback;
+    bool causal;
+};
+
+// A recursive filter made of branches, the results of which are
+// summed. Each branch is a cascade of recursions, applied in order.
+typedef std::vector<std::vector<Recursion>> RecursiveFilter;
+
+// Apply a recursive filter to the columns and then the rows of f,
+// which have the given width and height. The tuned schedule computes
+// the columns in strips a vector wide, so f should also be defined on
+// the columns up to a vector beyond the width, e.g. with a boundary
+// condition.
+Halide::Func recursive_filter(Halide::Func f, Halide::Expr width, Halide::Expr height,
+                              const RecursiveFilter &filter, bool tuned,
+                              const Halide::Target &target);
+
+// The recursive filters of Deriche's second order approximation of a
+// Gaussian blur with standard deviation sigma, and of a symmetric
+// first order low pass filter in which alpha is the weight of the
+// input.
+RecursiveFilter deriche_filter(Halide::Expr sigma);
+RecursiveFilter first_order_filter(Halide::Expr alpha);
+
+// A forward and backward pass of the second order section
+//
+//   out(y) = b0 * in(y) + b1 * in(y - 1) + b2 * in(y - 2) - a1 * out(y - 1) - a2 * out(y - 2)
+//
+// which has zero phase.
+RecursiveFilter second_order_filter(Halide::Expr b0, Halide::Expr b1, Halide::Expr b2,
+                                    Halide::Expr a1, Halide::Expr a2);
+
+// Convolve the rows of f with kernel_x, and the columns with
+// kernel_y. The kernels are defined on [0, 2 * radius] and centered on
+// radius. f should be defined beyond the region to be computed by the
+// radius of the kernels, e.g. with a boundary condition.
+Halide::Func separable_convolution(Halide::Func f,
+                                   Halide::Func kernel_x, Halide::Expr radius_x,
+                                   Halide::Func kernel_y, Halide::Expr radius_y,
+                                   bool tuned, const Halide::Target &target);
+
+// A normalized Gaussian kernel with standard deviation sigma, and a
+// box kernel, as convolution kernels of the given radius for
+// separable_convolution. The Gaussian is usually truncated at a
+// radius of 3 sigma.
+Halide::Func gaussian_kernel(Halide::Expr sigma, Halide::Expr radius);
+Halide::Func box_kernel(Halide::Expr radius);
+
+#endif
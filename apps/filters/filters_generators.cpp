@@ -0,0 +1,107 @@
+#include "Halide.h"
+
+#include "filters.h"
+
+namespace {
+
+using namespace Halide;
+
+// Each filter takes and returns a 3D image of floats, with the
+// channels in the third dimension, and has a GeneratorParam to pick
+// the tuned or the naive schedule (see filters.h).
+
+class SeparableConvolution : public Generator<SeparableConvolution> {
+public:
+    GeneratorParam<bool> tuned{"tuned", true};
+    ImageParam input{Float(32), 3, "input"};
+    // The kernels of the rows and the columns, which have an odd
+    // number of taps, and are centered on the middle tap.
+    ImageParam kernel_x{Float(32), 1, "kernel_x"};
+    ImageParam kernel_y{Float(32), 1, "kernel_y"};
+
+    Func build() {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        return separable_convolution(clamped, kernel_x, (kernel_x.width() - 1) / 2,
+                                     kernel_y, (kernel_y.width() - 1) / 2,
+                                     tuned, get_target());
+    }
+};
+
+class GaussianBlur : public Generator<GaussianBlur> {
+public:
+    GeneratorParam<bool> tuned{"tuned", true};
+    ImageParam input{Float(32), 3, "input"};
+    Param<float> sigma{"sigma"};
+
+    Func build() {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        Expr radius = cast<int>(ceil(3.0f * sigma));
+        Func kernel = gaussian_kernel(sigma, radius);
+        return separable_convolution(clamped, kernel, radius, kernel, radius,
+                                     tuned, get_target());
+    }
+};
+
+class BoxBlur : public Generator<BoxBlur> {
+public:
+    GeneratorParam<bool> tuned{"tuned", true};
+    ImageParam input{Float(32), 3, "input"};
+    Param<int> radius{"radius"};
+
+    Func build() {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        Func kernel = box_kernel(radius);
+        return separable_convolution(clamped, kernel, radius, kernel, radius,
+                                     tuned, get_target());
+    }
+};
+
+class FirstOrderIir : public Generator<FirstOrderIir> {
+public:
+    GeneratorParam<bool> tuned{"tuned", true};
+    ImageParam input{Float(32), 3, "input"};
+    // The weight of the input to the filter.
+    Param<float> alpha{"alpha"};
+
+    Func build() {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        return recursive_filter(clamped, input.width(), input.height(),
+                                first_order_filter(alpha), tuned, get_target());
+    }
+};
+
+class SecondOrderIir : public Generator<SecondOrderIir> {
+public:
+    GeneratorParam<bool> tuned{"tuned", true};
+    ImageParam input{Float(32), 3, "input"};
+    // The coefficients of the second order section, with a0 = 1.
+    Param<float> b0{"b0"}, b1{"b1"}, b2{"b2"}, a1{"a1"}, a2{"a2"};
+
+    Func build() {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        return recursive_filter(clamped, input.width(), input.height(),
+                                second_order_filter(b0, b1, b2, a1, a2), tuned, get_target());
+    }
+};
+
+class DericheBlur : public Generator<DericheBlur> {
+public:
+    GeneratorParam<bool> tuned{"tuned", true};
+    ImageParam input{Float(32), 3, "input"};
+    Param<float> sigma{"sigma"};
+
+    Func build() {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        return recursive_filter(clamped, input.width(), input.height(),
+                                deriche_filter(sigma), tuned, get_target());
+    }
+};
+
+RegisterGenerator<SeparableConvolution> register_separable_convolution{"separable_convolution"};
+RegisterGenerator<GaussianBlur> register_gaussian_blur{"gaussian_blur"};
+RegisterGenerator<BoxBlur> register_box_blur{"box_blur"};
+RegisterGenerator<FirstOrderIir> register_first_order_iir{"first_order_iir"};
+RegisterGenerator<SecondOrderIir> register_second_order_iir{"second_order_iir"};
+RegisterGenerator<DericheBlur> register_deriche_blur{"deriche_blur"};
+
+}  // namespace
@@ -7,7 +7,10 @@
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
 //    L2: gemv_notrans, gemv_trans
-//    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB
+//    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB,
+//        gemm_skinnyN (size x 32 result), gemm_skinnyK (sum over 32)
+//    Batched: axpy_batched, gemv_batched, gemm_batched (a batch of
+//        size x size problems)
 //
 
 #include <iomanip>
@@ -57,13 +60,25 @@ struct BenchmarksBase {
     }
 
     Matrix random_matrix(int N) {
-        Matrix buff(N * N);
-        for (int i=0; i<N*N; ++i) {
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix buff(M * N);
+        for (int i=0; i<M*N; ++i) {
             buff[i] = random_scalar();
         }
         return buff;
     }
 
+    Vector random_vector_batch(int N, int batch) {
+        return random_vector(N * batch);
+    }
+
+    Matrix random_matrix_batch(int N, int batch) {
+        return random_matrix(N, N * batch);
+    }
+
     BenchmarksBase(std::string n) : name(n) {}
 
     void run(std::string benchmark, int size) {
@@ -91,6 +106,16 @@ struct BenchmarksBase {
             this->bench_gemm_transB(size);
         } else if (benchmark == "gemm_transAB") {
             this->bench_gemm_transAB(size);
+        } else if (benchmark == "gemm_skinnyN") {
+            this->bench_gemm_skinnyN(size);
+        } else if (benchmark == "gemm_skinnyK") {
+            this->bench_gemm_skinnyK(size);
+        } else if (benchmark == "axpy_batched") {
+            this->bench_axpy_batched(size);
+        } else if (benchmark == "gemv_batched") {
+            this->bench_gemv_batched(size);
+        } else if (benchmark == "gemm_batched") {
+            this->bench_gemm_batched(size);
         }
     }
 
@@ -106,6 +131,11 @@ struct BenchmarksBase {
     virtual void bench_gemm_transA(int N) =0;
     virtual void bench_gemm_transB(int N) =0;
     virtual void bench_gemm_transAB(int N) =0;
+    virtual void bench_gemm_skinnyN(int N) =0;
+    virtual void bench_gemm_skinnyK(int N) =0;
+    virtual void bench_axpy_batched(int N) =0;
+    virtual void bench_gemv_batched(int N) =0;
+    virtual void bench_gemm_batched(int N) =0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -147,6 +177,35 @@ struct BenchmarksFloat : public BenchmarksBase<float> {
     L3Benchmark(gemm_transAB, "s", cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N,
                                                alpha, &(A[0]), N, &(B[0]), N,
                                                beta, &(C[0]), N))
+
+    L3ShapeBenchmark(gemm_skinnyN, "s", size, 32, size,
+                     cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                 alpha, &(A[0]), M, &(B[0]), K,
+                                 beta, &(C[0]), M))
+
+    L3ShapeBenchmark(gemm_skinnyK, "s", size, size, 32,
+                     cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                 alpha, &(A[0]), M, &(B[0]), K,
+                                 beta, &(C[0]), M))
+
+    L1BatchedBenchmark(axpy_batched, "s",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_saxpy(N, alpha, &(x[b * N]), 1, &(y[b * N]), 1);
+                       })
+
+    L2BatchedBenchmark(gemv_batched, "s",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_sgemv(CblasColMajor, CblasNoTrans, N, N,
+                                       alpha, &(A[b * N * N]), N, &(x[b * N]), 1,
+                                       beta, &(y[b * N]), 1);
+                       })
+
+    L3BatchedBenchmark(gemm_batched, "s",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N,
+                                       alpha, &(A[b * N * N]), N, &(B[b * N * N]), N,
+                                       beta, &(C[b * N * N]), N);
+                       })
 };
 
 struct BenchmarksDouble : public BenchmarksBase<double> {
@@ -188,6 +247,35 @@ struct BenchmarksDouble : public BenchmarksBase<double> {
     L3Benchmark(gemm_transAB, "d", cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N,
                                                alpha, &(A[0]), N, &(B[0]), N,
                                                beta, &(C[0]), N))
+
+    L3ShapeBenchmark(gemm_skinnyN, "d", size, 32, size,
+                     cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                 alpha, &(A[0]), M, &(B[0]), K,
+                                 beta, &(C[0]), M))
+
+    L3ShapeBenchmark(gemm_skinnyK, "d", size, size, 32,
+                     cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                 alpha, &(A[0]), M, &(B[0]), K,
+                                 beta, &(C[0]), M))
+
+    L1BatchedBenchmark(axpy_batched, "d",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_daxpy(N, alpha, &(x[b * N]), 1, &(y[b * N]), 1);
+                       })
+
+    L2BatchedBenchmark(gemv_batched, "d",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_dgemv(CblasColMajor, CblasNoTrans, N, N,
+                                       alpha, &(A[b * N * N]), N, &(x[b * N]), 1,
+                                       beta, &(y[b * N]), 1);
+                       })
+
+    L3BatchedBenchmark(gemm_batched, "d",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N,
+                                       alpha, &(A[b * N * N]), N, &(B[b * N * N]), N,
+                                       beta, &(C[b * N * N]), N);
+                       })
 };
 
 int main(int argc, char* argv[]) {
@@ -7,7 +7,10 @@
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
 //    L2: gemv_notrans, gemv_trans
-//    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB
+//    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB,
+//        gemm_skinnyN (size x 32 result), gemm_skinnyK (sum over 32)
+//    Batched: axpy_batched, gemv_batched, gemm_batched (a batch of
+//        size x size problems)
 //
 
 #include <iomanip>
@@ -45,11 +48,24 @@ struct Benchmarks {
     }
 
     Matrix random_matrix(int N) {
-        Matrix A(N, N);
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix A(M, N);
         A.setRandom();
         return A;
     }
 
+    // Batches are stored side by side, as the columns of a matrix.
+    Matrix random_vector_batch(int N, int batch) {
+        return random_matrix(N, batch);
+    }
+
+    Matrix random_matrix_batch(int N, int batch) {
+        return random_matrix(N, N * batch);
+    }
+
     Benchmarks(std::string n) : name(n) {}
 
     void run(std::string benchmark, int size) {
@@ -77,6 +93,16 @@ struct Benchmarks {
             bench_gemm_transB(size);
         } else if (benchmark == "gemm_transAB") {
             bench_gemm_transAB(size);
+        } else if (benchmark == "gemm_skinnyN") {
+            bench_gemm_skinnyN(size);
+        } else if (benchmark == "gemm_skinnyK") {
+            bench_gemm_skinnyK(size);
+        } else if (benchmark == "axpy_batched") {
+            bench_axpy_batched(size);
+        } else if (benchmark == "gemv_batched") {
+            bench_gemv_batched(size);
+        } else if (benchmark == "gemm_batched") {
+            bench_gemm_batched(size);
         }
     }
 
@@ -97,6 +123,23 @@ struct Benchmarks {
     L3Benchmark(gemm_transB, type_name<T>(), C = alpha * A * B.transpose() + beta * C);
     L3Benchmark(gemm_transAB, type_name<T>(), C = alpha * A.transpose() * B.transpose() + beta * C);
 
+    L3ShapeBenchmark(gemm_skinnyN, type_name<T>(), size, 32, size, C = alpha * A * B + beta * C);
+    L3ShapeBenchmark(gemm_skinnyK, type_name<T>(), size, size, 32, C = alpha * A * B + beta * C);
+
+    L1BatchedBenchmark(axpy_batched, type_name<T>(),
+                       for (int b = 0; b < batch; b++) {
+                           y.col(b) = alpha * x.col(b) + y.col(b);
+                       });
+    L2BatchedBenchmark(gemv_batched, type_name<T>(),
+                       for (int b = 0; b < batch; b++) {
+                           y.col(b) = alpha * A.block(0, b * N, N, N) * x.col(b) + beta * y.col(b);
+                       });
+    L3BatchedBenchmark(gemm_batched, type_name<T>(),
+                       for (int b = 0; b < batch; b++) {
+                           C.block(0, b * N, N, N) = (alpha * A.block(0, b * N, N, N) * B.block(0, b * N, N, N) +
+                                                      beta * C.block(0, b * N, N, N));
+                       });
+
   private:
     std::string name;
 };
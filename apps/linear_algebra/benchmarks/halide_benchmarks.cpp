@@ -7,7 +7,10 @@
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
 //    L2: gemv_notrans, gemv_trans
-//    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB
+//    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB,
+//        gemm_skinnyN (size x 32 result), gemm_skinnyK (sum over 32)
+//    Batched: axpy_batched, gemv_batched, gemm_batched (a batch of
+//        size x size problems)
 //
 
 #include <iomanip>
@@ -46,9 +49,26 @@ struct BenchmarksBase {
     }
 
     Matrix random_matrix(int N) {
-        Matrix buff(Halide::type_of<T>(), N, N);
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix buff(Halide::type_of<T>(), M, N);
+        Scalar *A = (Scalar*)buff.host_ptr();
+        for (int i=0; i<M*N; ++i) {
+            A[i] = random_scalar();
+        }
+        return buff;
+    }
+
+    Vector random_vector_batch(int N, int batch) {
+        return random_matrix(N, batch);
+    }
+
+    Matrix random_matrix_batch(int N, int batch) {
+        Matrix buff(Halide::type_of<T>(), N, N, batch);
         Scalar *A = (Scalar*)buff.host_ptr();
-        for (int i=0; i<N*N; ++i) {
+        for (int i=0; i<N*N*batch; ++i) {
             A[i] = random_scalar();
         }
         return buff;
@@ -81,6 +101,16 @@ struct BenchmarksBase {
             bench_gemm_transB(size);
         } else if (benchmark == "gemm_transAB") {
             bench_gemm_transAB(size);
+        } else if (benchmark == "gemm_skinnyN") {
+            bench_gemm_skinnyN(size);
+        } else if (benchmark == "gemm_skinnyK") {
+            bench_gemm_skinnyK(size);
+        } else if (benchmark == "axpy_batched") {
+            bench_axpy_batched(size);
+        } else if (benchmark == "gemv_batched") {
+            bench_gemv_batched(size);
+        } else if (benchmark == "gemm_batched") {
+            bench_gemm_batched(size);
         }
     }
 
@@ -96,6 +126,11 @@ struct BenchmarksBase {
     virtual void bench_gemm_transA(int N) =0;
     virtual void bench_gemm_transB(int N) =0;
     virtual void bench_gemm_transAB(int N) =0;
+    virtual void bench_gemm_skinnyN(int N) =0;
+    virtual void bench_gemm_skinnyK(int N) =0;
+    virtual void bench_axpy_batched(int N) =0;
+    virtual void bench_gemv_batched(int N) =0;
+    virtual void bench_gemm_batched(int N) =0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -131,6 +166,22 @@ struct BenchmarksFloat : public BenchmarksBase<float> {
 
     L3Benchmark(gemm_transAB, "s", halide_sgemm(true, true, alpha, A.raw_buffer(),
                                                 B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3ShapeBenchmark(gemm_skinnyN, "s", size, 32, size,
+                     halide_sgemm(false, false, alpha, A.raw_buffer(),
+                                  B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3ShapeBenchmark(gemm_skinnyK, "s", size, size, 32,
+                     halide_sgemm(false, false, alpha, A.raw_buffer(),
+                                  B.raw_buffer(), beta, C.raw_buffer()))
+
+    L1BatchedBenchmark(axpy_batched, "s", halide_saxpy_batched(alpha, x.raw_buffer(), y.raw_buffer()))
+
+    L2BatchedBenchmark(gemv_batched, "s", halide_sgemv_batched(alpha, A.raw_buffer(), x.raw_buffer(),
+                                                        beta, y.raw_buffer()))
+
+    L3BatchedBenchmark(gemm_batched, "s", halide_sgemm_batched(alpha, A.raw_buffer(), B.raw_buffer(),
+                                                        beta, C.raw_buffer()))
 };
 
 struct BenchmarksDouble : public BenchmarksBase<double> {
@@ -166,6 +217,22 @@ struct BenchmarksDouble : public BenchmarksBase<double> {
 
     L3Benchmark(gemm_transAB, "d", halide_dgemm(true, true, alpha, A.raw_buffer(),
                                                 B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3ShapeBenchmark(gemm_skinnyN, "d", size, 32, size,
+                     halide_dgemm(false, false, alpha, A.raw_buffer(),
+                                  B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3ShapeBenchmark(gemm_skinnyK, "d", size, size, 32,
+                     halide_dgemm(false, false, alpha, A.raw_buffer(),
+                                  B.raw_buffer(), beta, C.raw_buffer()))
+
+    L1BatchedBenchmark(axpy_batched, "d", halide_daxpy_batched(alpha, x.raw_buffer(), y.raw_buffer()))
+
+    L2BatchedBenchmark(gemv_batched, "d", halide_dgemv_batched(alpha, A.raw_buffer(), x.raw_buffer(),
+                                                        beta, y.raw_buffer()))
+
+    L3BatchedBenchmark(gemm_batched, "d", halide_dgemm_batched(alpha, A.raw_buffer(), B.raw_buffer(),
+                                                        beta, C.raw_buffer()))
 };
 
 int main(int argc, char* argv[]) {
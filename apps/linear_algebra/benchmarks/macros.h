@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "../support/benchmark.h"
 
 #define time_it(code)                                        \
@@ -68,3 +69,85 @@
                   << std::setw(20) << L3GFLOPS(N)                       \
                   << std::endl;                                         \
     }
+
+// Benchmarks a non-square gemm, where C is M x N, and the sum is over
+// K. The shape is given in terms of the size argument.
+#define L3ShapeGFLOPS(M, N, K) (3.0 + K) * M * N * 1e-3 / elapsed
+#define L3ShapeBenchmark(benchmark, type, rows, cols, depth, code)     \
+    virtual void bench_##benchmark(int size) {                          \
+        const int M = rows, N = cols, K = depth;                        \
+        Scalar alpha = random_scalar();                                 \
+        Scalar beta = random_scalar();                                  \
+        Matrix A(random_matrix(M, K));                                  \
+        Matrix B(random_matrix(K, N));                                  \
+        Matrix C(random_matrix(M, N));                                  \
+                                                                        \
+        time_it(code)                                                   \
+                                                                        \
+        std::cout << std::setw(8) << name                               \
+                  << std::setw(15) << type << #benchmark                \
+                  << std::setw(8) << std::to_string(size)               \
+                  << std::setw(20) << std::to_string(elapsed)           \
+                  << std::setw(20) << L3ShapeGFLOPS(M, N, K)            \
+                  << std::endl;                                         \
+    }
+
+// Batched benchmarks run a batch of problems of size N, with enough of
+// them to make up about a million matrix elements.
+#define BATCH_COUNT(N) std::max(1, (1 << 20) / ((N) * (N)))
+
+#define L1BatchedBenchmark(benchmark, type, code)                       \
+    virtual void bench_##benchmark(int N) {                             \
+        const int batch = BATCH_COUNT(N);                               \
+        Scalar alpha = random_scalar();                                 \
+        (void) alpha;                                                   \
+        auto x = random_vector_batch(N, batch);                         \
+        auto y = random_vector_batch(N, batch);                         \
+                                                                        \
+        time_it(code)                                                   \
+                                                                        \
+        std::cout << std::setw(8) << name                               \
+                  << std::setw(15) << type << #benchmark                \
+                  << std::setw(8) << std::to_string(N)                  \
+                  << std::setw(20) << std::to_string(elapsed)           \
+                  << std::setw(20) << batch * L1GFLOPS(N)               \
+                  << std::endl;                                         \
+    }
+
+#define L2BatchedBenchmark(benchmark, type, code)                       \
+    virtual void bench_##benchmark(int N) {                             \
+        const int batch = BATCH_COUNT(N);                               \
+        Scalar alpha = random_scalar();                                 \
+        Scalar beta = random_scalar();                                  \
+        auto x = random_vector_batch(N, batch);                         \
+        auto y = random_vector_batch(N, batch);                         \
+        auto A = random_matrix_batch(N, batch);                         \
+                                                                        \
+        time_it(code)                                                   \
+                                                                        \
+        std::cout << std::setw(8) << name                               \
+                  << std::setw(15) << type << #benchmark                \
+                  << std::setw(8) << std::to_string(N)                  \
+                  << std::setw(20) << std::to_string(elapsed)           \
+                  << std::setw(20) << batch * L2GFLOPS(N)               \
+                  << std::endl;                                         \
+    }
+
+#define L3BatchedBenchmark(benchmark, type, code)                       \
+    virtual void bench_##benchmark(int N) {                             \
+        const int batch = BATCH_COUNT(N);                               \
+        Scalar alpha = random_scalar();                                 \
+        Scalar beta = random_scalar();                                  \
+        auto A = random_matrix_batch(N, batch);                         \
+        auto B = random_matrix_batch(N, batch);                         \
+        auto C = random_matrix_batch(N, batch);                         \
+                                                                        \
+        time_it(code)                                                   \
+                                                                        \
+        std::cout << std::setw(8) << name                               \
+                  << std::setw(15) << type << #benchmark                \
+                  << std::setw(8) << std::to_string(N)                  \
+                  << std::setw(20) << std::to_string(elapsed)           \
+                  << std::setw(20) << batch * L3GFLOPS(N)               \
+                  << std::endl;                                         \
+    }
@@ -0,0 +1,241 @@
+#include <vector>
+#include "Halide.h"
+
+using namespace Halide;
+
+namespace {
+
+// Base class for the batched BLAS generators, which apply the same
+// small operation to every slice of a batch, given as the outermost
+// dimension of the inputs and output. The batch is processed in
+// parallel, a few problems per task. If the size GeneratorParam is
+// non-zero, the kernel only handles problems of that size, which
+// lets the inner loops be fully unrolled.
+template<class Derived, class T>
+class BatchedGenerator :
+        public Generator<Derived> {
+  public:
+    typedef Generator<Derived> Base;
+    using Base::target;
+    using Base::get_target;
+    using Base::natural_vector_size;
+
+    GeneratorParam<bool> assertions_enabled_ = {"assertions_enabled", false};
+    GeneratorParam<int>  size_ = {"size", 0};
+    GeneratorParam<int>  batch_per_task_ = {"batch_per_task", 16};
+
+    void SetupTarget() {
+        if (!assertions_enabled_) {
+            target.set(get_target()
+                       .with_feature(Target::NoAsserts)
+                       .with_feature(Target::NoBoundsQuery));
+        }
+    }
+
+    // Fully unroll a loop over a fixed-size dimension, vectorizing
+    // it by as many lanes as evenly divide it.
+    template<class F>
+    void unroll_fixed(F &f, Var v) {
+        const int size = size_;
+        const int vec = natural_vector_size(type_of<T>());
+        int lanes = size < vec ? size : vec;
+        while (size % lanes != 0) {
+            lanes /= 2;
+        }
+        if (lanes > 1) {
+            f.vectorize(v, lanes);
+        }
+        f.unroll(v);
+    }
+
+    // The extent of a dimension, which is a compile-time constant if
+    // the size GeneratorParam was set.
+    Expr extent(ImageParam p, int dim) {
+        if (size_ > 0) {
+            return (int)size_;
+        }
+        return p.extent(dim);
+    }
+};
+
+// Generator class for batched axpy operations, on a batch of vectors
+// stored as the columns of a matrix.
+template<class T>
+class BatchedAXPYGenerator :
+        public BatchedGenerator<BatchedAXPYGenerator<T>, T> {
+  public:
+    typedef BatchedGenerator<BatchedAXPYGenerator<T>, T> Base;
+    using Base::natural_vector_size;
+    using Base::size_;
+    using Base::batch_per_task_;
+
+    Param<T>   a_ = {"a", 1.0};
+    ImageParam x_ = {type_of<T>(), 2, "x"};
+    ImageParam y_ = {type_of<T>(), 2, "y"};
+
+    Func build() {
+        this->SetupTarget();
+
+        const int vec = natural_vector_size(type_of<T>());
+        const Expr size = this->extent(x_, 0);
+        const Expr batch = x_.height();
+
+        Var i("i"), n("n"), no("no");
+        Func result("result");
+        result(i, n) = a_ * x_(i, n) + y_(i, n);
+
+        result.split(n, no, n, batch_per_task_, TailStrategy::GuardWithIf).parallel(no);
+        if (size_ > 0) {
+            result.bound(i, 0, size);
+            this->unroll_fixed(result, i);
+        } else {
+            result.specialize(size >= vec).vectorize(i, vec);
+        }
+
+        x_.set_bounds(0, 0, size).set_min(1, 0);
+        y_.set_bounds(0, 0, size).set_bounds(1, 0, batch);
+        result.output_buffer().set_bounds(0, 0, size).set_bounds(1, 0, batch);
+
+        return result;
+    }
+};
+
+// Generator class for batched gemv operations. A is a batch of
+// matrices, and x and y are batches of vectors.
+template<class T>
+class BatchedGEMVGenerator :
+        public BatchedGenerator<BatchedGEMVGenerator<T>, T> {
+  public:
+    typedef BatchedGenerator<BatchedGEMVGenerator<T>, T> Base;
+    using Base::natural_vector_size;
+    using Base::size_;
+    using Base::batch_per_task_;
+
+    Param<T>   a_ = {"a", 1.0};
+    ImageParam A_ = {type_of<T>(), 3, "A"};
+    ImageParam x_ = {type_of<T>(), 2, "x"};
+    Param<T>   b_ = {"b", 1.0};
+    ImageParam y_ = {type_of<T>(), 2, "y"};
+
+    Func build() {
+        this->SetupTarget();
+
+        const int vec = natural_vector_size(type_of<T>());
+        const Expr num_rows = this->extent(A_, 0);
+        const Expr sum_size = this->extent(A_, 1);
+        const Expr batch = A_.channels();
+
+        Var i("i"), n("n"), no("no");
+        RDom k(0, sum_size, "k");
+        Func Ax("Ax");
+        Ax(i, n) += A_(i, k, n) * x_(k, n);
+
+        Func result("result");
+        result(i, n) = a_ * Ax(i, n) + b_ * y_(i, n);
+
+        result.split(n, no, n, batch_per_task_, TailStrategy::GuardWithIf).parallel(no);
+        if (size_ > 0) {
+            result.bound(i, 0, num_rows);
+            this->unroll_fixed(result, i);
+            Ax.compute_at(result, n);
+            this->unroll_fixed(Ax, i);
+            Stage update = Ax.update();
+            update.reorder(i, k).unroll(k);
+            this->unroll_fixed(update, i);
+        } else {
+            result.specialize(num_rows >= vec).vectorize(i, vec);
+            Ax.compute_at(result, i);
+            Ax.specialize(num_rows >= vec).vectorize(i, vec);
+            Ax.update().reorder(i, k)
+                .specialize(num_rows >= vec).vectorize(i, vec);
+        }
+
+        A_.set_bounds(0, 0, num_rows).set_bounds(1, 0, sum_size).set_min(2, 0);
+        x_.set_bounds(0, 0, sum_size).set_bounds(1, 0, batch);
+        y_.set_bounds(0, 0, num_rows).set_bounds(1, 0, batch);
+        result.output_buffer().set_bounds(0, 0, num_rows).set_bounds(1, 0, batch);
+
+        return result;
+    }
+};
+
+// Generator class for batched gemm operations. A, B and C are all
+// batches of matrices.
+template<class T>
+class BatchedGEMMGenerator :
+        public BatchedGenerator<BatchedGEMMGenerator<T>, T> {
+  public:
+    typedef BatchedGenerator<BatchedGEMMGenerator<T>, T> Base;
+    using Base::natural_vector_size;
+    using Base::size_;
+    using Base::batch_per_task_;
+
+    Param<T>   a_ = {"a", 1.0};
+    ImageParam A_ = {type_of<T>(), 3, "A"};
+    ImageParam B_ = {type_of<T>(), 3, "B"};
+    Param<T>   b_ = {"b", 1.0};
+    ImageParam C_ = {type_of<T>(), 3, "C"};
+
+    Func build() {
+        this->SetupTarget();
+
+        const int vec = natural_vector_size(type_of<T>());
+        const Expr num_rows = this->extent(A_, 0);
+        const Expr sum_size = this->extent(A_, 1);
+        const Expr num_cols = this->extent(B_, 1);
+        const Expr batch = A_.channels();
+
+        Var i("i"), j("j"), n("n"), no("no");
+        RDom k(0, sum_size, "k");
+        Func AB("AB");
+        AB(i, j, n) += A_(i, k, n) * B_(k, j, n);
+
+        Func result("result");
+        result(i, j, n) = a_ * AB(i, j, n) + b_ * C_(i, j, n);
+
+        result.split(n, no, n, batch_per_task_, TailStrategy::GuardWithIf).parallel(no);
+        if (size_ > 0) {
+            // Accumulate the product one column at a time, so that
+            // the column stays in registers. The loop over columns is
+            // only unrolled for the smallest sizes, to keep the code
+            // size down.
+            result.bound(i, 0, num_rows).bound(j, 0, num_cols);
+            this->unroll_fixed(result, i);
+            AB.compute_at(result, n);
+            this->unroll_fixed(AB, i);
+            Stage update = AB.update();
+            update.reorder(i, k, j).unroll(k);
+            this->unroll_fixed(update, i);
+            if (size_ <= 8) {
+                result.unroll(j);
+                AB.unroll(j);
+                update.unroll(j);
+            }
+        } else {
+            result.specialize(num_rows >= vec).vectorize(i, vec);
+            AB.compute_at(result, i);
+            AB.specialize(num_rows >= vec).vectorize(i, vec);
+            AB.update().reorder(i, k)
+                .specialize(num_rows >= vec).vectorize(i, vec);
+        }
+
+        A_.set_bounds(0, 0, num_rows).set_bounds(1, 0, sum_size).set_min(2, 0);
+        B_.set_bounds(0, 0, sum_size).set_bounds(1, 0, num_cols).set_bounds(2, 0, batch);
+        C_.set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols).set_bounds(2, 0, batch);
+        result.output_buffer()
+            .set_bounds(0, 0, num_rows)
+            .set_bounds(1, 0, num_cols)
+            .set_bounds(2, 0, batch);
+
+        return result;
+    }
+};
+
+RegisterGenerator<BatchedAXPYGenerator<float>>  register_saxpy_batched("saxpy_batched");
+RegisterGenerator<BatchedAXPYGenerator<double>> register_daxpy_batched("daxpy_batched");
+RegisterGenerator<BatchedGEMVGenerator<float>>  register_sgemv_batched("sgemv_batched");
+RegisterGenerator<BatchedGEMVGenerator<double>> register_dgemv_batched("dgemv_batched");
+RegisterGenerator<BatchedGEMMGenerator<float>>  register_sgemm_batched("sgemm_batched");
+RegisterGenerator<BatchedGEMMGenerator<double>> register_dgemm_batched("dgemm_batched");
+
+}  // namespace
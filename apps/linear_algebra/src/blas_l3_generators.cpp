@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include "Halide.h"
 
@@ -6,6 +7,19 @@ using namespace Halide;
 namespace {
 
 // Generator class for BLAS gemm operations.
+//
+// The schedule follows the usual structure of an optimized GEMM: the
+// output is divided into mc x nc blocks, which are computed in
+// parallel. Within a block the sum is split into slices of length kc,
+// and for each slice the corresponding panels of A (mc x kc) and B
+// (kc x nc) are copied into contiguous buffers, so that they stay
+// resident in the L2 and L3 caches respectively. The innermost
+// micro-kernel then computes an mr x nr tile of the block, with the
+// accumulators kept in registers. The block sizes default to values
+// derived from the cache sizes and the number of vector registers of
+// the target, but can be overridden with GeneratorParams. The blocks of
+// B are narrowed at run time when that's needed for there to be a
+// block for each thread.
 template<class T>
 class GEMMGenerator :
         public Generator<GEMMGenerator<T>> {
@@ -18,6 +32,23 @@ class GEMMGenerator :
     GeneratorParam<bool> transpose_A_ = {"transpose_A", false};
     GeneratorParam<bool> transpose_B_ = {"transpose_B", false};
 
+    // Cache sizes in bytes, used to pick the block sizes.
+    GeneratorParam<int> l1_cache_size_ = {"l1_cache_size", 32 * 1024};
+    GeneratorParam<int> l2_cache_size_ = {"l2_cache_size", 256 * 1024};
+    GeneratorParam<int> l3_cache_size_ = {"l3_cache_size", 4 * 1024 * 1024};
+
+    // Size of the register tile (mr x nr), and of the blocks of A
+    // (mc x kc) and B (kc x nc). Zero means derive from the target.
+    GeneratorParam<int> mr_ = {"mr", 0};
+    GeneratorParam<int> nr_ = {"nr", 0};
+    GeneratorParam<int> kc_ = {"kc", 0};
+    GeneratorParam<int> mc_ = {"mc", 0};
+    GeneratorParam<int> nc_ = {"nc", 0};
+
+    // The number of threads the blocks of the output should be spread
+    // over.
+    GeneratorParam<int> threads_ = {"threads", 8};
+
     // Standard ordering of parameters in GEMM functions.
     Param<T>   a_ = {"a", 1.0};
     ImageParam A_ = {type_of<T>(), 2, "A"};
@@ -25,16 +56,37 @@ class GEMMGenerator :
     Param<T>   b_ = {"b", 1.0};
     ImageParam C_ = {type_of<T>(), 2, "C"};
 
-    Func build() {
-        // Matrices are interpreted as column-major by default. The
-        // transpose GeneratorParams are used to handle cases where
-        // one or both is actually row major.
-        const Expr num_rows = A_.width();
-        const Expr num_cols = B_.height();
-        const Expr sum_size = A_.height();
+    // The number of vector registers available to the micro-kernel.
+    int vector_registers() {
+        const Target &t = get_target();
+        if (t.arch == Target::X86) {
+            return t.bits == 64 ? 16 : 8;
+        } else if (t.arch == Target::ARM) {
+            return t.bits == 64 ? 32 : 16;
+        }
+        return 16;
+    }
 
+    Func build() {
         const int vec = natural_vector_size(a_.type());
-        const int s = vec * 2;
+        const int elem_size = sizeof(T);
+
+        // The micro-kernel holds an mr x nr tile of the result in
+        // registers, along with a column of A and one broadcast
+        // element of B.
+        const int mr = mr_ > 0 ? (int)mr_ : 2 * vec;
+        const int mr_vectors = (mr + vec - 1) / vec;
+        const int nr = nr_ > 0 ? (int)nr_ :
+            std::max(1, std::min(12, (vector_registers() - mr_vectors - 1) / mr_vectors));
+
+        // An mr x kc panel of A and a kc x nr panel of B should fit in
+        // half of L1, an mc x kc block of A in half of L2, and a kc x
+        // nc block of B in half of L3. The block sizes are rounded
+        // down to a whole number of register tiles.
+        const int kc = kc_ > 0 ? (int)kc_ :
+            std::min(512, std::max(64, l1_cache_size_ / (2 * (mr + nr) * elem_size) / 8 * 8));
+        const int mc = std::max(1, (mc_ > 0 ? (int)mc_ : l2_cache_size_ / (2 * kc * elem_size)) / mr) * mr;
+        const int nc = std::max(1, (nc_ > 0 ? (int)nc_ : l3_cache_size_ / (2 * kc * elem_size)) / nr) * nr;
 
         ImageParam A_in, B_in;
 
@@ -51,38 +103,69 @@ class GEMMGenerator :
             B_in = B_;
         }
 
-        Var i, j, ii, ji, jii, iii, io, jo, t;
-        Var ti[3], tj[3];
+        // Matrices are interpreted as column-major by default. The
+        // transpose GeneratorParams are used to handle cases where
+        // one or both is actually row major.
+        const Expr ab_rows  = transpose_A_ ? A_in.height() : A_in.width();
+        const Expr sum_size = transpose_A_ ? A_in.width() : A_in.height();
+        const Expr ab_cols  = transpose_B_ ? B_in.width() : B_in.height();
+        const Expr num_rows = transpose_AB ? ab_cols : ab_rows;
+        const Expr num_cols = transpose_AB ? ab_rows : ab_cols;
+
+        // The default nc is larger than most matrices, which would
+        // leave only as many blocks as there are blocks of rows. If
+        // that's fewer than the number of threads, narrow the blocks
+        // of B so that each thread gets one, keeping them a whole
+        // number of register tiles wide. The dimension of the result
+        // that's split by nc is transposed along with A*B.
+        const Expr m_extent = transpose_AB ? num_cols : num_rows;
+        const Expr n_extent = transpose_AB ? num_rows : num_cols;
+        const int threads = std::max(1, (int)threads_);
+        Expr m_blocks = (m_extent + mc - 1) / mc;
+        Expr n_blocks = max(1, (threads + m_blocks - 1) / m_blocks);
+        Expr n_tiles = ((n_extent + n_blocks - 1) / n_blocks + nr - 1) / nr;
+        Expr block_cols = min(nc, max(1, n_tiles) * nr);
+
+        Var i("i"), j("j"), k("k"), ii("ii"), ji("ji"), io("io"), jo("jo");
+        Var ir("ir"), jr("jr"), ti("ti"), tj("tj"), t("t");
         Func result("result");
 
-        // Swizzle A for better memory order in the inner loop.
-        Func A("A"), B("B"), Btmp("Btmp"), As("As"), Atmp("Atmp");
+        // Pad A and B with zeros, so that the blocks and tiles never
+        // need to be clamped.
+        Func A("A"), B("B"), Atmp("Atmp"), Btmp("Btmp");
         Atmp(i, j) = BoundaryConditions::constant_exterior(A_in, cast<T>(0))(i, j);
+        Btmp(i, j) = BoundaryConditions::constant_exterior(B_in, cast<T>(0))(i, j);
 
         if (transpose_A_) {
-            As(i, j, io) = Atmp(j, io*s + i);
+            A(i, k) = Atmp(k, i);
         } else {
-            As(i, j, io) = Atmp(io*s + i, j);
+            A(i, k) = Atmp(i, k);
         }
 
-        A(i, j) = As(i % s, j, i / s);
-
-        Btmp(i, j) = B_in(i, j);
         if (transpose_B_) {
-            B(i, j) = Btmp(j, i);
+            B(k, j) = Btmp(j, k);
         } else {
-            B(i, j) = Btmp(i, j);
+            B(k, j) = Btmp(k, j);
         }
 
-        Var k("k");
-        Func prod;
-        // Express all the products we need to do a matrix multiply as a 3D Func.
-        prod(k, i, j) = A(i, k) * B(k, j);
-
-        // Reduce the products along k.
+        // Pack A into panels mr rows wide, and B into panels nr
+        // columns wide, so that the micro-kernel reads both
+        // contiguously.
+        Func Apack("Apack"), Bpack("Bpack");
+        Apack(ii, k, io) = A(io * mr + ii, k);
+        Bpack(ji, k, jo) = B(k, jo * nr + ji);
+
+        // The micro-kernel reduces one slice of the sum.
+        Var ko("ko");
+        Func micro("micro");
+        RDom rk(0, kc, "rk");
+        micro(i, j, ko) += (Apack(i % mr, ko * kc + rk, i / mr) *
+                            Bpack(j % nr, ko * kc + rk, j / nr));
+
+        // Accumulate the slices.
         Func AB("AB");
-        RDom rv(0, sum_size);
-        AB(i, j) += prod(rv, i, j);
+        RDom rko(0, (sum_size + kc - 1) / kc, "rko");
+        AB(i, j) += micro(i, j, rko);
 
         Func ABt("ABt");
         if (transpose_AB) {
@@ -95,64 +178,54 @@ class GEMMGenerator :
         // Do the part that makes it a 'general' matrix multiply.
         result(i, j) = (a_ * ABt(i, j) + b_ * C_(i, j));
 
-        result.tile(i, j, ti[1], tj[1], i, j, 2*s, 2*s, TailStrategy::GuardWithIf);
+        // Compute the result in parallel blocks, each of which
+        // corresponds to an mc x block_cols block of A*B.
         if (transpose_AB) {
             result
-                .tile(i, j, ii, ji, 4, s)
-                .tile(i, j, ti[0], tj[0], i, j, s/4, 1);
-
+                .tile(i, j, ti, tj, i, j, block_cols, mc, TailStrategy::GuardWithIf)
+                .fuse(ti, tj, t).parallel(t)
+                .tile(i, j, ii, ji, vec, vec)
+                .vectorize(ii).unroll(ji);
+            ABt.compute_at(result, i)
+                .bound_extent(i, vec).unroll(i)
+                .bound_extent(j, vec).vectorize(j);
         } else {
             result
-                .tile(i, j, ii, ji, s, 4)
-                .tile(i, j, ti[0], tj[0], i, j, 1, s/4);
+                .tile(i, j, ti, tj, i, j, mc, block_cols, TailStrategy::GuardWithIf)
+                .fuse(ti, tj, t).parallel(t)
+                .vectorize(i, vec);
         }
 
-        // If we have enough work per task, parallelize over these tiles.
-        result.specialize(num_rows >= 512 && num_cols >= 512)
-            .fuse(tj[1], ti[1], t).parallel(t);
-
-        // Otherwise tile one more time before parallelizing, or don't
-        // parallelize at all.
-        result.specialize(num_rows >= 128 && num_cols >= 128)
-            .tile(ti[1], tj[1], ti[2], tj[2], ti[1], tj[1], 2, 2)
-            .fuse(tj[2], ti[2], t).parallel(t);
-
-        result.rename(tj[0], t);
-
         result.bound(i, 0, num_rows).bound(j, 0, num_cols);
 
-        As.compute_root()
-            .split(j, jo, ji, s).reorder(i, ji, io, jo)
-            .unroll(i).vectorize(ji)
-            .specialize(A_.width() >= 256 && A_.height() >= 256).parallel(jo, 4);
+        AB.compute_at(result, t)
+            .vectorize(i, vec);
 
-        Atmp.compute_at(As, io)
-            .vectorize(i).unroll(j);
+        // Walk over the slices of the sum, then over the register
+        // tiles of the block.
+        AB.update()
+            .split(i, ir, ii, mr).split(j, jr, ji, nr)
+            .reorder(ii, ji, ir, jr, rko)
+            .vectorize(ii, vec).unroll(ii).unroll(ji);
 
-        if (transpose_B_) {
-            B.compute_at(result, t)
-                .tile(i, j, ii, ji, 8, 8)
-                .vectorize(ii).unroll(ji);
-            Btmp.reorder_storage(j, i)
-                .compute_at(B, i)
-                .vectorize(i)
-                .unroll(j);
+        Apack.compute_at(AB, rko)
+            .vectorize(ii, vec).unroll(ii);
+        Bpack.compute_at(AB, rko)
+            .unroll(ji);
+        if (transpose_A_) {
+            Atmp.compute_at(Apack, io)
+                .vectorize(i, vec).unroll(j);
         }
 
-
-        AB.compute_at(result, i)
-            .bound_extent(j, 4).unroll(j)
-            .bound_extent(i, s).vectorize(i)
+        micro.compute_at(AB, ir)
+            .bound_extent(i, mr).vectorize(i, vec).unroll(i)
+            .bound_extent(j, nr).unroll(j)
             .update()
-            .reorder(i, j, rv).unroll(j).unroll(rv, 2).vectorize(i);
-        if (transpose_AB) {
-            ABt.compute_at(result, i)
-                .bound_extent(i, 4).unroll(i)
-                .bound_extent(j, s).vectorize(j);
-        }
+            .reorder(i, j, rk)
+            .vectorize(i, vec).unroll(i).unroll(j);
 
         A_.set_min(0, 0).set_min(1, 0);
-        B_.set_bounds(0, 0, sum_size).set_min(1, 0);
+        B_.set_min(0, 0).set_min(1, 0);
         C_.set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
         result.output_buffer().set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
 
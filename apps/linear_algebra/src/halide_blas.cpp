@@ -61,6 +61,37 @@ void init_matrix_buffer(const int M, const int N, const double *A, const int lda
     buff->elem_size = sizeof(double);
 }
 
+void init_matrix_batch_buffer(const int M, const int N, const int batch, const float *A,
+                              const int lda, const int stride, buffer_t *buff) {
+    init_matrix_buffer(M, N, A, lda, buff);
+    buff->extent[2] = batch;
+    buff->stride[2] = stride;
+}
+
+void init_matrix_batch_buffer(const int M, const int N, const int batch, const double *A,
+                              const int lda, const int stride, buffer_t *buff) {
+    init_matrix_buffer(M, N, A, lda, buff);
+    buff->extent[2] = batch;
+    buff->stride[2] = stride;
+}
+
+// Batches of matrices up to this size are handled by the batched
+// kernels, which parallelize across the batch rather than within each
+// multiplication.
+const int max_small_matrix_size = 32;
+
+bool use_batched_kernel(bool tA, bool tB, const int M, const int N, const int K,
+                        long long stride_A, long long stride_B, long long stride_C) {
+    const long long max_stride = 0x7fffffff;
+    return (!tA && !tB &&
+            M <= max_small_matrix_size &&
+            N <= max_small_matrix_size &&
+            K <= max_small_matrix_size &&
+            stride_A <= max_stride &&
+            stride_B <= max_stride &&
+            stride_C <= max_stride);
+}
+
 }
 
 #ifdef __cplusplus
@@ -359,6 +390,83 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
     assert_no_error(halide_dgemm(tA, tB, alpha, &buff_A, &buff_B, beta, &buff_C));
 }
 
+//////////////////
+// gemm_batched //
+//////////////////
+
+// Each multiplication is parallelized internally, so a batch of
+// separately allocated matrices is processed in order. A strided
+// batch of small matrices is instead handed to a batched kernel in a
+// single call.
+
+void hblas_sgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const float alpha, const float **A,
+                         const int lda, const float **B, const int ldb,
+                         const float beta, float **C, const int ldc,
+                         const int batch_count) {
+    for (int i = 0; i < batch_count; i++) {
+        hblas_sgemm(Order, TransA, TransB, M, N, K, alpha, A[i], lda, B[i], ldb, beta, C[i], ldc);
+    }
+}
+
+void hblas_dgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const double alpha, const double **A,
+                         const int lda, const double **B, const int ldb,
+                         const double beta, double **C, const int ldc,
+                         const int batch_count) {
+    for (int i = 0; i < batch_count; i++) {
+        hblas_dgemm(Order, TransA, TransB, M, N, K, alpha, A[i], lda, B[i], ldb, beta, C[i], ldc);
+    }
+}
+
+void hblas_sgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const float alpha, const float *A,
+                                 const int lda, const long long stride_A, const float *B,
+                                 const int ldb, const long long stride_B, const float beta,
+                                 float *C, const int ldc, const long long stride_C,
+                                 const int batch_count) {
+    bool tA = TransA != HblasNoTrans, tB = TransB != HblasNoTrans;
+    if (use_batched_kernel(tA, tB, M, N, K, stride_A, stride_B, stride_C)) {
+        buffer_t buff_A, buff_B, buff_C;
+        init_matrix_batch_buffer(M, K, batch_count, A, lda, stride_A, &buff_A);
+        init_matrix_batch_buffer(K, N, batch_count, B, ldb, stride_B, &buff_B);
+        init_matrix_batch_buffer(M, N, batch_count, C, ldc, stride_C, &buff_C);
+        assert_no_error(halide_sgemm_batched(alpha, &buff_A, &buff_B, beta, &buff_C));
+        return;
+    }
+
+    for (int i = 0; i < batch_count; i++) {
+        hblas_sgemm(Order, TransA, TransB, M, N, K, alpha, A + i * stride_A, lda,
+                    B + i * stride_B, ldb, beta, C + i * stride_C, ldc);
+    }
+}
+
+void hblas_dgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const double alpha, const double *A,
+                                 const int lda, const long long stride_A, const double *B,
+                                 const int ldb, const long long stride_B, const double beta,
+                                 double *C, const int ldc, const long long stride_C,
+                                 const int batch_count) {
+    bool tA = TransA != HblasNoTrans, tB = TransB != HblasNoTrans;
+    if (use_batched_kernel(tA, tB, M, N, K, stride_A, stride_B, stride_C)) {
+        buffer_t buff_A, buff_B, buff_C;
+        init_matrix_batch_buffer(M, K, batch_count, A, lda, stride_A, &buff_A);
+        init_matrix_batch_buffer(K, N, batch_count, B, ldb, stride_B, &buff_B);
+        init_matrix_batch_buffer(M, N, batch_count, C, ldc, stride_C, &buff_C);
+        assert_no_error(halide_dgemm_batched(alpha, &buff_A, &buff_B, beta, &buff_C));
+        return;
+    }
+
+    for (int i = 0; i < batch_count; i++) {
+        hblas_dgemm(Order, TransA, TransB, M, N, K, alpha, A + i * stride_A, lda,
+                    B + i * stride_B, ldb, beta, C + i * stride_C, ldc);
+    }
+}
+
 
 #ifdef __cplusplus
 }
@@ -28,6 +28,22 @@
 #include "halide_dgemm_transB.h"
 #include "halide_sgemm_transAB.h"
 #include "halide_dgemm_transAB.h"
+#include "halide_saxpy_batched_impl.h"
+#include "halide_daxpy_batched_impl.h"
+#include "halide_sgemv_batched_impl.h"
+#include "halide_dgemv_batched_impl.h"
+#include "halide_sgemv_batched_4.h"
+#include "halide_dgemv_batched_4.h"
+#include "halide_sgemv_batched_8.h"
+#include "halide_dgemv_batched_8.h"
+#include "halide_sgemm_batched_impl.h"
+#include "halide_dgemm_batched_impl.h"
+#include "halide_sgemm_batched_4.h"
+#include "halide_dgemm_batched_4.h"
+#include "halide_sgemm_batched_8.h"
+#include "halide_dgemm_batched_8.h"
+#include "halide_sgemm_batched_16.h"
+#include "halide_dgemm_batched_16.h"
 
 inline int halide_scopy(buffer_t *x, buffer_t *y) {
     return halide_scopy_impl(0, x, nullptr, y);
@@ -103,6 +119,66 @@ inline int halide_dgemm(bool transA, bool transB, double a, buffer_t *A, buffer_
     return -1;
 }
 
+// Batched routines, which apply the same operation to every slice of
+// a batch, given as the outermost dimension of each buffer. Batches
+// of small square matrices are dispatched to kernels specialized for
+// that size.
+inline bool halide_is_square_batch(const buffer_t *A, int size) {
+    return A->extent[0] == size && A->extent[1] == size;
+}
+
+inline int halide_saxpy_batched(float a, buffer_t *x, buffer_t *y) {
+    return halide_saxpy_batched_impl(a, x, y, y);
+}
+
+inline int halide_daxpy_batched(double a, buffer_t *x, buffer_t *y) {
+    return halide_daxpy_batched_impl(a, x, y, y);
+}
+
+inline int halide_sgemv_batched(float a, buffer_t *A, buffer_t *x, float b, buffer_t *y) {
+    if (halide_is_square_batch(A, 4)) {
+        return halide_sgemv_batched_4(a, A, x, b, y, y);
+    } else if (halide_is_square_batch(A, 8)) {
+        return halide_sgemv_batched_8(a, A, x, b, y, y);
+    } else {
+        return halide_sgemv_batched_impl(a, A, x, b, y, y);
+    }
+}
+
+inline int halide_dgemv_batched(double a, buffer_t *A, buffer_t *x, double b, buffer_t *y) {
+    if (halide_is_square_batch(A, 4)) {
+        return halide_dgemv_batched_4(a, A, x, b, y, y);
+    } else if (halide_is_square_batch(A, 8)) {
+        return halide_dgemv_batched_8(a, A, x, b, y, y);
+    } else {
+        return halide_dgemv_batched_impl(a, A, x, b, y, y);
+    }
+}
+
+inline int halide_sgemm_batched(float a, buffer_t *A, buffer_t *B, float b, buffer_t *C) {
+    if (halide_is_square_batch(A, 4) && halide_is_square_batch(B, 4)) {
+        return halide_sgemm_batched_4(a, A, B, b, C, C);
+    } else if (halide_is_square_batch(A, 8) && halide_is_square_batch(B, 8)) {
+        return halide_sgemm_batched_8(a, A, B, b, C, C);
+    } else if (halide_is_square_batch(A, 16) && halide_is_square_batch(B, 16)) {
+        return halide_sgemm_batched_16(a, A, B, b, C, C);
+    } else {
+        return halide_sgemm_batched_impl(a, A, B, b, C, C);
+    }
+}
+
+inline int halide_dgemm_batched(double a, buffer_t *A, buffer_t *B, double b, buffer_t *C) {
+    if (halide_is_square_batch(A, 4) && halide_is_square_batch(B, 4)) {
+        return halide_dgemm_batched_4(a, A, B, b, C, C);
+    } else if (halide_is_square_batch(A, 8) && halide_is_square_batch(B, 8)) {
+        return halide_dgemm_batched_8(a, A, B, b, C, C);
+    } else if (halide_is_square_batch(A, 16) && halide_is_square_batch(B, 16)) {
+        return halide_dgemm_batched_16(a, A, B, b, C, C);
+    } else {
+        return halide_dgemm_batched_impl(a, A, B, b, C, C);
+    }
+}
+
 enum HBLAS_ORDER {HblasRowMajor=101, HblasColMajor=102};
 enum HBLAS_TRANSPOSE {HblasNoTrans=111, HblasTrans=112, HblasConjTrans=113};
 enum HBLAS_UPLO {HblasUpper=121, HblasLower=122};
@@ -244,6 +320,42 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
                  const int lda, const double *B, const int ldb,
                  const double beta, double *C, const int ldc);
 
+/*
+ * Batched routines, which compute C[i] = alpha*op(A[i])*op(B[i]) + beta*C[i]
+ * for each matrix in a batch. The matrices are either given as arrays of
+ * pointers, or as a base pointer and a stride in elements between
+ * consecutive matrices.
+ */
+void hblas_sgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const float alpha, const float **A,
+                         const int lda, const float **B, const int ldb,
+                         const float beta, float **C, const int ldc,
+                         const int batch_count);
+
+void hblas_dgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const double alpha, const double **A,
+                         const int lda, const double **B, const int ldb,
+                         const double beta, double **C, const int ldc,
+                         const int batch_count);
+
+void hblas_sgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const float alpha, const float *A,
+                                 const int lda, const long long stride_A, const float *B,
+                                 const int ldb, const long long stride_B, const float beta,
+                                 float *C, const int ldc, const long long stride_C,
+                                 const int batch_count);
+
+void hblas_dgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const double alpha, const double *A,
+                                 const int lda, const long long stride_A, const double *B,
+                                 const int ldb, const long long stride_B, const double beta,
+                                 double *C, const int ldc, const long long stride_C,
+                                 const int batch_count);
+
 #ifdef __cplusplus
 }
 #endif
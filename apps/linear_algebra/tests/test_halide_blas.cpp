@@ -1,4 +1,5 @@
 #include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -112,6 +113,123 @@
         return compareMatrices(N, eC, aC);      \
     }
 
+#define L3_SHAPED_TEST(method, rows, cols, depth, cblas_code, hblas_code) \
+    bool test_##method(int N) {                             \
+        const int M = rows, P = cols, K = depth;            \
+        Scalar alpha = random_scalar();                     \
+        Scalar beta = random_scalar();                      \
+        Matrix eA(random_vector(M * K));                    \
+        Matrix eB(random_vector(K * P));                    \
+        Matrix eC(random_vector(M * P));                    \
+        Matrix aA(eA), aB(eB), aC(eC);                      \
+                                                            \
+        {                                                   \
+            Scalar *A = &(eA[0]);                           \
+            Scalar *B = &(eB[0]);                           \
+            Scalar *C = &(eC[0]);                           \
+            cblas_code;                                     \
+        }                                                   \
+                                                            \
+        {                                                   \
+            Scalar *A = &(aA[0]);                           \
+            Scalar *B = &(aB[0]);                           \
+            Scalar *C = &(aC[0]);                           \
+            hblas_code;                                     \
+        }                                                   \
+                                                            \
+        return compareVectors(M * P, eC, aC);               \
+    }
+
+#define L3_BATCHED_TEST(method, cblas_code, hblas_code)     \
+    bool test_##method(int N) {                             \
+        const int batch = 3;                                \
+        Scalar alpha = random_scalar();                     \
+        Scalar beta = random_scalar();                      \
+        Matrix eA(random_vector(batch * N * N));            \
+        Matrix eB(random_vector(batch * N * N));            \
+        Matrix eC(random_vector(batch * N * N));            \
+        Matrix aA(eA), aB(eB), aC(eC);                      \
+                                                            \
+        {                                                   \
+            Scalar *A = &(eA[0]);                           \
+            Scalar *B = &(eB[0]);                           \
+            Scalar *C = &(eC[0]);                           \
+            for (int b = 0; b < batch; ++b) {               \
+                cblas_code;                                 \
+                A += N * N; B += N * N; C += N * N;         \
+            }                                               \
+        }                                                   \
+                                                            \
+        {                                                   \
+            Scalar *A = &(aA[0]);                           \
+            Scalar *B = &(aB[0]);                           \
+            Scalar *C = &(aC[0]);                           \
+            hblas_code;                                     \
+        }                                                   \
+                                                            \
+        return compareVectors(batch * N * N, eC, aC);       \
+    }
+
+
+// The batched kernels have no BLAS interface, so these call them with
+// buffer_t's, and compare with calling cblas for each slice. The batch
+// isn't a multiple of the number of slices each task computes.
+#define L1_BATCHED_TEST(method, size, cblas_code, halide_code) \
+    bool test_##method(int N) {                             \
+        const int M = size, batch = 37;                     \
+        Scalar alpha = random_scalar();                     \
+        Vector ex(random_vector(M * batch));                \
+        Vector ey(random_vector(M * batch));                \
+        Vector ax(ex), ay(ey);                              \
+                                                            \
+        for (int b = 0; b < batch; ++b) {                   \
+            Scalar *x = &(ex[b * M]);                       \
+            Scalar *y = &(ey[b * M]);                       \
+            cblas_code;                                     \
+        }                                                   \
+                                                            \
+        {                                                   \
+            buffer_t x = vector_batch_buffer(&(ax[0]), M, batch); \
+            buffer_t y = vector_batch_buffer(&(ay[0]), M, batch); \
+            if (halide_code != 0) {                         \
+                std::cerr << "FAIL! " #method " returned an error\n"; \
+                return false;                               \
+            }                                               \
+        }                                                   \
+                                                            \
+        return compareVectors(M * batch, ey, ay);           \
+    }
+
+#define L2_BATCHED_TEST(method, size, cblas_code, halide_code) \
+    bool test_##method(int N) {                             \
+        const int M = size, batch = 37;                     \
+        Scalar alpha = random_scalar();                     \
+        Scalar beta = random_scalar();                      \
+        Vector ex(random_vector(M * batch));                \
+        Vector ey(random_vector(M * batch));                \
+        Matrix eA(random_vector(M * M * batch));            \
+        Vector ax(ex), ay(ey);                              \
+        Matrix aA(eA);                                      \
+                                                            \
+        for (int b = 0; b < batch; ++b) {                   \
+            Scalar *x = &(ex[b * M]);                       \
+            Scalar *y = &(ey[b * M]);                       \
+            Scalar *A = &(eA[b * M * M]);                   \
+            cblas_code;                                     \
+        }                                                   \
+                                                            \
+        {                                                   \
+            buffer_t x = vector_batch_buffer(&(ax[0]), M, batch); \
+            buffer_t y = vector_batch_buffer(&(ay[0]), M, batch); \
+            buffer_t A = matrix_batch_buffer(&(aA[0]), M, batch); \
+            if (halide_code != 0) {                         \
+                std::cerr << "FAIL! " #method " returned an error\n"; \
+                return false;                               \
+            }                                               \
+        }                                                   \
+                                                            \
+        return compareVectors(M * batch, ey, ay);           \
+    }
 
 template<class T>
 struct BLASTestBase {
@@ -145,6 +263,28 @@ struct BLASTestBase {
         return buff;
     }
 
+    // A batch of densely packed vectors of the given size, one per
+    // column.
+    buffer_t vector_batch_buffer(Scalar *x, int size, int batch) {
+        buffer_t buff;
+        memset(&buff, 0, sizeof(buff));
+        buff.host = (uint8_t *)x;
+        buff.extent[0] = size;
+        buff.extent[1] = batch;
+        buff.stride[0] = 1;
+        buff.stride[1] = size;
+        buff.elem_size = sizeof(Scalar);
+        return buff;
+    }
+
+    // A batch of densely packed square matrices of the given size.
+    buffer_t matrix_batch_buffer(Scalar *A, int size, int batch) {
+        buffer_t buff = vector_batch_buffer(A, size, size);
+        buff.extent[2] = batch;
+        buff.stride[2] = size * size;
+        return buff;
+    }
+
     bool compareScalars(Scalar x, Scalar y, Scalar epsilon = 4 * std::numeric_limits<Scalar>::epsilon()) {
         if (x == y) {
             return true;
@@ -207,10 +347,20 @@ struct BLASFloatTests : public BLASTestBase<float> {
         RUN_TEST(sgemv_notrans);
         RUN_TEST(sgemv_trans);
         RUN_TEST(sger);
+        RUN_TEST(saxpy_batched);
+        RUN_TEST(sgemv_batched);
+        RUN_TEST(sgemv_batched_4);
+        RUN_TEST(sgemv_batched_8);
         RUN_TEST(sgemm_notrans);
         RUN_TEST(sgemm_transA);
         RUN_TEST(sgemm_transB);
         RUN_TEST(sgemm_transAB);
+        RUN_TEST(sgemm_skinny_n);
+        RUN_TEST(sgemm_skinny_m_transA);
+        RUN_TEST(sgemm_skinny_k_transB);
+        RUN_TEST(sgemm_wide_transAB);
+        RUN_TEST(sgemm_strided_batched);
+        RUN_TEST(sgemm_strided_batched_notrans);
     }
 
     L1_VECTOR_TEST(scopy, scopy(N, x, 1, y, 1))
@@ -230,6 +380,19 @@ struct BLASFloatTests : public BLASTestBase<float> {
             cblas_sger(CblasColMajor, N, N, alpha, x, 1, y, 1, A, N),
             hblas_sger(HblasColMajor, N, N, alpha, x, 1, y, 1, A, N));
 
+    L1_BATCHED_TEST(saxpy_batched, N,
+            cblas_saxpy(M, alpha, x, 1, y, 1),
+            halide_saxpy_batched(alpha, &x, &y));
+    L2_BATCHED_TEST(sgemv_batched, N,
+            cblas_sgemv(CblasColMajor, CblasNoTrans, M, M, alpha, A, M, x, 1, beta, y, 1),
+            halide_sgemv_batched_impl(alpha, &A, &x, beta, &y, &y));
+    L2_BATCHED_TEST(sgemv_batched_4, 4,
+            cblas_sgemv(CblasColMajor, CblasNoTrans, M, M, alpha, A, M, x, 1, beta, y, 1),
+            halide_sgemv_batched(alpha, &A, &x, beta, &y));
+    L2_BATCHED_TEST(sgemv_batched_8, 8,
+            cblas_sgemv(CblasColMajor, CblasNoTrans, M, M, alpha, A, M, x, 1, beta, y, 1),
+            halide_sgemv_batched(alpha, &A, &x, beta, &y));
+
     L3_TEST(sgemm_notrans,
             cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_sgemm(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
@@ -242,6 +405,28 @@ struct BLASFloatTests : public BLASTestBase<float> {
     L3_TEST(sgemm_transAB,
             cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_sgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+    // Products that aren't square, so that there are few blocks of
+    // the result along one dimension, or the sum is short.
+    L3_SHAPED_TEST(sgemm_skinny_n, 4 * N + 5, 3, N,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, P, K, alpha, A, M, B, K, beta, C, M),
+            hblas_sgemm(HblasColMajor, HblasNoTrans, HblasNoTrans, M, P, K, alpha, A, M, B, K, beta, C, M));
+    L3_SHAPED_TEST(sgemm_skinny_m_transA, 3, 4 * N + 5, N,
+            cblas_sgemm(CblasColMajor, CblasTrans, CblasNoTrans, M, P, K, alpha, A, K, B, K, beta, C, M),
+            hblas_sgemm(HblasColMajor, HblasTrans, HblasNoTrans, M, P, K, alpha, A, K, B, K, beta, C, M));
+    L3_SHAPED_TEST(sgemm_skinny_k_transB, N + 1, 2 * N + 3, 3,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, M, P, K, alpha, A, M, B, P, beta, C, M),
+            hblas_sgemm(HblasColMajor, HblasNoTrans, HblasTrans, M, P, K, alpha, A, M, B, P, beta, C, M));
+    L3_SHAPED_TEST(sgemm_wide_transAB, 2 * N + 3, N + 1, N / 2 + 1,
+            cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, M, P, K, alpha, A, K, B, P, beta, C, M),
+            hblas_sgemm(HblasColMajor, HblasTrans, HblasTrans, M, P, K, alpha, A, K, B, P, beta, C, M));
+    L3_BATCHED_TEST(sgemm_strided_batched,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_sgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasTrans, N, N, N,
+                                        alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, batch));
+    L3_BATCHED_TEST(sgemm_strided_batched_notrans,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_sgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N,
+                                        alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, batch));
 };
 
 struct BLASDoubleTests : public BLASTestBase<double> {
@@ -254,10 +439,20 @@ struct BLASDoubleTests : public BLASTestBase<double> {
         RUN_TEST(dgemv_notrans);
         RUN_TEST(dgemv_trans);
         RUN_TEST(dger);
+        RUN_TEST(daxpy_batched);
+        RUN_TEST(dgemv_batched);
+        RUN_TEST(dgemv_batched_4);
+        RUN_TEST(dgemv_batched_8);
         RUN_TEST(dgemm_notrans);
         RUN_TEST(dgemm_transA);
         RUN_TEST(dgemm_transB);
         RUN_TEST(dgemm_transAB);
+        RUN_TEST(dgemm_skinny_n);
+        RUN_TEST(dgemm_skinny_m_transA);
+        RUN_TEST(dgemm_skinny_k_transB);
+        RUN_TEST(dgemm_wide_transAB);
+        RUN_TEST(dgemm_strided_batched);
+        RUN_TEST(dgemm_strided_batched_notrans);
     }
 
     L1_VECTOR_TEST(dcopy, dcopy(N, x, 1, y, 1))
@@ -277,6 +472,19 @@ struct BLASDoubleTests : public BLASTestBase<double> {
             cblas_dger(CblasColMajor, N, N, alpha, x, 1, y, 1, A, N),
             hblas_dger(HblasColMajor, N, N, alpha, x, 1, y, 1, A, N));
 
+    L1_BATCHED_TEST(daxpy_batched, N,
+            cblas_daxpy(M, alpha, x, 1, y, 1),
+            halide_daxpy_batched(alpha, &x, &y));
+    L2_BATCHED_TEST(dgemv_batched, N,
+            cblas_dgemv(CblasColMajor, CblasNoTrans, M, M, alpha, A, M, x, 1, beta, y, 1),
+            halide_dgemv_batched_impl(alpha, &A, &x, beta, &y, &y));
+    L2_BATCHED_TEST(dgemv_batched_4, 4,
+            cblas_dgemv(CblasColMajor, CblasNoTrans, M, M, alpha, A, M, x, 1, beta, y, 1),
+            halide_dgemv_batched(alpha, &A, &x, beta, &y));
+    L2_BATCHED_TEST(dgemv_batched_8, 8,
+            cblas_dgemv(CblasColMajor, CblasNoTrans, M, M, alpha, A, M, x, 1, beta, y, 1),
+            halide_dgemv_batched(alpha, &A, &x, beta, &y));
+
     L3_TEST(dgemm_notrans,
             cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_dgemm(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
@@ -289,6 +497,28 @@ struct BLASDoubleTests : public BLASTestBase<double> {
     L3_TEST(dgemm_transAB,
             cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_dgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+    // Products that aren't square, so that there are few blocks of
+    // the result along one dimension, or the sum is short.
+    L3_SHAPED_TEST(dgemm_skinny_n, 4 * N + 5, 3, N,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, P, K, alpha, A, M, B, K, beta, C, M),
+            hblas_dgemm(HblasColMajor, HblasNoTrans, HblasNoTrans, M, P, K, alpha, A, M, B, K, beta, C, M));
+    L3_SHAPED_TEST(dgemm_skinny_m_transA, 3, 4 * N + 5, N,
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, M, P, K, alpha, A, K, B, K, beta, C, M),
+            hblas_dgemm(HblasColMajor, HblasTrans, HblasNoTrans, M, P, K, alpha, A, K, B, K, beta, C, M));
+    L3_SHAPED_TEST(dgemm_skinny_k_transB, N + 1, 2 * N + 3, 3,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, M, P, K, alpha, A, M, B, P, beta, C, M),
+            hblas_dgemm(HblasColMajor, HblasNoTrans, HblasTrans, M, P, K, alpha, A, M, B, P, beta, C, M));
+    L3_SHAPED_TEST(dgemm_wide_transAB, 2 * N + 3, N + 1, N / 2 + 1,
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, M, P, K, alpha, A, K, B, P, beta, C, M),
+            hblas_dgemm(HblasColMajor, HblasTrans, HblasTrans, M, P, K, alpha, A, K, B, P, beta, C, M));
+    L3_BATCHED_TEST(dgemm_strided_batched,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_dgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasTrans, N, N, N,
+                                        alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, batch));
+    L3_BATCHED_TEST(dgemm_strided_batched_notrans,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_dgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N,
+                                        alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, batch));
 };
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "local_laplacian_strips.h"
+#include "local_laplacian_tiled.h"
+#include "local_laplacian_parallel_channels.h"
+#include "local_laplacian_streaming.h"
+
+#include "halide_image.h"
+#include "schedule_benchmark.h"
+
+using namespace Halide::Tools;
+
+// Compare the throughput and the peak memory use of the CPU schedules
+// of the local Laplacian filter, over several image sizes and thread
+// counts.
+
+int main(int argc, char **argv) {
+    const int levels = 8;
+    const float alpha = 1.0f / (levels - 1), beta = 1.0f;
+    const int sizes[][2] = {{640, 480}, {1920, 1080}, {3840, 2160}};
+
+    schedule_benchmark::print_header();
+    for (auto size : sizes) {
+        const int width = size[0], height = size[1];
+
+        // Smooth gradients with noise in each channel.
+        Image<uint16_t> input(width, height, 3);
+        for (int c = 0; c < 3; c++) {
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    int noise = rand() & 0xfff;
+                    input(x, y, c) = (uint16_t)((60000 * (x + c * y)) / (width + 2 * height) + noise);
+                }
+            }
+        }
+        Image<uint16_t> output(width, height, 3);
+
+        std::vector<schedule_benchmark::Variant> variants = {
+            {"strips", [&]() { return local_laplacian_strips(levels, alpha, beta, input, output); }},
+            {"tiled", [&]() { return local_laplacian_tiled(levels, alpha, beta, input, output); }},
+            {"parallel_channels", [&]() { return local_laplacian_parallel_channels(levels, alpha, beta, input, output); }},
+            {"streaming", [&]() { return local_laplacian_streaming(levels, alpha, beta, input, output); }},
+        };
+        if (schedule_benchmark::compare(width, height, variants) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
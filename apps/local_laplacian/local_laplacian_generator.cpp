@@ -0,0 +1,281 @@
+#include "Halide.h"
+
+namespace {
+
+using namespace Halide;
+
+Var x("x"), y("y");
+
+// Downsample with a 1 3 3 1 filter
+Func downsample(Func f) {
+    Func downx, downy;
+
+    downx(x, y, _) = (f(2*x-1, y, _) + 3.0f * (f(2*x, y, _) + f(2*x+1, y, _)) + f(2*x+2, y, _)) / 8.0f;
+    downy(x, y, _) = (downx(x, 2*y-1, _) + 3.0f * (downx(x, 2*y, _) + downx(x, 2*y+1, _)) + downx(x, 2*y+2, _)) / 8.0f;
+
+    return downy;
+}
+
+// Upsample using bilinear interpolation
+Func upsample(Func f) {
+    Func upx, upy;
+
+    upx(x, y, _) = 0.25f * f((x/2) - 1 + 2*(x % 2), y, _) + 0.75f * f(x/2, y, _);
+    upy(x, y, _) = 0.25f * upx(x, (y/2) - 1 + 2*(y % 2), _) + 0.75f * upx(x, y/2, _);
+
+    return upy;
+
+}
+
+const int maxJ = 20;
+
+enum class Schedule { Strips, Tiled, ParallelChannels, Streaming };
+
+class LocalLaplacian : public Halide::Generator<LocalLaplacian> {
+public:
+    // Number of pyramid levels
+    GeneratorParam<int> pyramid_levels{"pyramid_levels", 8, 1, maxJ};
+    // The CPU schedule. GPU targets always use the GPU schedule.
+    //  strips: computes the input pyramids over the whole image, and
+    //    slides the fine levels of the output pyramid down parallel
+    //    strips of the output. This is the tuned default.
+    //  tiled: computes the output pyramid in square tiles of the
+    //    output, in parallel, from the input pyramids, which are
+    //    computed over the whole image.
+    //  parallel_channels: computes the pyramids over the whole image,
+    //    with the processed pyramid in parallel over its intensity
+    //    levels.
+    //  streaming: computes the fine levels of all of the pyramids
+    //    for parallel strips of the output, sliding the output
+    //    pyramid down each strip one row at a time, so that only the
+    //    small coarse levels are stored for the whole image. This
+    //    uses the least memory.
+    GeneratorParam<Schedule> schedule{"schedule", Schedule::Strips,
+                                      {{"strips", Schedule::Strips},
+                                       {"tiled", Schedule::Tiled},
+                                       {"parallel_channels", Schedule::ParallelChannels},
+                                       {"streaming", Schedule::Streaming}}};
+    // The height in pixels of the strips of the strips and streaming
+    // schedules, and the size of the tiles of the tiled
+    // schedule. Each strip of the streaming schedule also computes the
+    // rows of the input pyramids that overlap the neighbouring strips,
+    // and the overlap is a larger fraction of each coarser level, so
+    // the levels whose strips would be less than 8 rows tall are
+    // computed over the whole image instead.
+    GeneratorParam<int> tile_size{"tile_size", 64};
+
+    // number of intensity levels
+    Param<int> levels{"levels"};
+    // Parameters controlling the filter
+    Param<float> alpha{"alpha"}, beta{"beta"};
+    // Takes a 16-bit input
+    ImageParam input{UInt(16), 3, "input"};
+
+    Func build() {
+        /* THE ALGORITHM */
+        const int J = pyramid_levels;
+
+        // loop variables
+        Var c("c"), k("k");
+
+        // Make the remapping function as a lookup table.
+        Func remap("remap");
+        Expr fx = cast<float>(x) / 256.0f;
+        remap(x) = alpha*fx*exp(-fx*fx/2.0f);
+
+        // Set a boundary condition
+        Func clamped = BoundaryConditions::repeat_edge(input);
+
+        // Convert to floating point
+        Func floating("floating");
+        floating(x, y, c) = clamped(x, y, c) / 65535.0f;
+
+        // Get the luminance channel
+        Func gray("gray");
+        gray(x, y) = 0.299f * floating(x, y, 0) + 0.587f * floating(x, y, 1) + 0.114f * floating(x, y, 2);
+
+        // Make the processed Gaussian pyramid.
+        Func gPyramid[maxJ];
+        // Do a lookup into a lut with 256 entires per intensity level
+        Expr level = k * (1.0f / (levels - 1));
+        Expr idx = gray(x, y)*cast<float>(levels-1)*256.0f;
+        idx = clamp(cast<int>(idx), 0, (levels-1)*256);
+        gPyramid[0](x, y, k) = beta*(gray(x, y) - level) + level + remap(idx - 256*k);
+        for (int j = 1; j < J; j++) {
+            gPyramid[j](x, y, k) = downsample(gPyramid[j-1])(x, y, k);
+        }
+
+        // Get its laplacian pyramid
+        Func lPyramid[maxJ];
+        lPyramid[J-1](x, y, k) = gPyramid[J-1](x, y, k);
+        for (int j = J-2; j >= 0; j--) {
+            lPyramid[j](x, y, k) = gPyramid[j](x, y, k) - upsample(gPyramid[j+1])(x, y, k);
+        }
+
+        // Make the Gaussian pyramid of the input
+        Func inGPyramid[maxJ];
+        inGPyramid[0](x, y) = gray(x, y);
+        for (int j = 1; j < J; j++) {
+            inGPyramid[j](x, y) = downsample(inGPyramid[j-1])(x, y);
+        }
+
+        // Make the laplacian pyramid of the output
+        Func outLPyramid[maxJ];
+        for (int j = 0; j < J; j++) {
+            // Split input pyramid value into integer and floating parts
+            Expr level = inGPyramid[j](x, y) * cast<float>(levels-1);
+            Expr li = clamp(cast<int>(level), 0, levels-2);
+            Expr lf = level - cast<float>(li);
+            // Linearly interpolate between the nearest processed pyramid levels
+            outLPyramid[j](x, y) = (1.0f - lf) * lPyramid[j](x, y, li) + lf * lPyramid[j](x, y, li+1);
+        }
+
+        // Make the Gaussian pyramid of the output
+        Func outGPyramid[maxJ];
+        outGPyramid[J-1](x, y) = outLPyramid[J-1](x, y);
+        for (int j = J-2; j >= 0; j--) {
+            outGPyramid[j](x, y) = upsample(outGPyramid[j+1])(x, y) + outLPyramid[j](x, y);
+        }
+
+        // Reintroduce color (Connelly: use eps to avoid scaling up noise w/ apollo3.png input)
+        Func color("color");
+        float eps = 0.01f;
+        color(x, y, c) = outGPyramid[0](x, y) * (floating(x, y, c)+eps) / (gray(x, y)+eps);
+
+        Func output("local_laplacian");
+        // Convert back to 16-bit
+        output(x, y, c) = cast<uint16_t>(clamp(color(x, y, c), 0.0f, 1.0f) * 65535.0f);
+
+
+
+        /* THE SCHEDULE */
+        remap.compute_root();
+
+        // The levels of the pyramids below this one are big enough to
+        // be worth parallelizing and vectorizing.
+        const int fine_levels = std::min(J, 5);
+        const int tile = tile_size;
+
+        if (get_target().has_gpu_feature()) {
+            // gpu schedule
+            output.compute_root().gpu_tile(x, y, 16, 8);
+            for (int j = 0; j < J; j++) {
+                int blockw = 16, blockh = 8;
+                if (j > 3) {
+                    blockw = 2;
+                    blockh = 2;
+                }
+                if (j > 0) {
+                    inGPyramid[j].compute_root().gpu_tile(x, y, blockw, blockh);
+                    gPyramid[j].compute_root().reorder(k, x, y).gpu_tile(x, y, blockw, blockh);
+                }
+                outGPyramid[j].compute_root().gpu_tile(x, y, blockw, blockh);
+            }
+        } else if (schedule == Schedule::Strips) {
+            // Compute the input pyramids over the whole image, and
+            // slide the fine levels of the output pyramid down each
+            // strip of the output.
+            Var yo("yo");
+            output.reorder(c, x, y).split(y, yo, y, tile).parallel(yo).vectorize(x, 8);
+            gray.compute_root().parallel(y, 32).vectorize(x, 8);
+            for (int j = 1; j < fine_levels; j++) {
+                inGPyramid[j]
+                    .compute_root().parallel(y, 32).vectorize(x, 8);
+                gPyramid[j]
+                    .compute_root().reorder_storage(x, k, y)
+                    .reorder(k, y).parallel(y, 8).vectorize(x, 8);
+                outGPyramid[j]
+                    .store_at(output, yo).compute_at(output, y)
+                    .vectorize(x, 8);
+            }
+            outGPyramid[0]
+                .compute_at(output, y).vectorize(x, 8);
+            for (int j = fine_levels; j < J; j++) {
+                inGPyramid[j].compute_root();
+                gPyramid[j].compute_root().parallel(k);
+                outGPyramid[j].compute_root();
+            }
+        } else if (schedule == Schedule::Tiled) {
+            // Compute the input pyramids over the whole image, and
+            // the fine levels of the output pyramid per tile of the
+            // output.
+            Var xo("xo"), yo("yo"), xi("xi"), yi("yi");
+            output.reorder(c, x, y).tile(x, y, xo, yo, xi, yi, tile, tile)
+                .parallel(yo).vectorize(xi, 8);
+            gray.compute_root().parallel(y, 32).vectorize(x, 8);
+            for (int j = 1; j < fine_levels; j++) {
+                inGPyramid[j]
+                    .compute_root().parallel(y, 32).vectorize(x, 8);
+                gPyramid[j]
+                    .compute_root().reorder_storage(x, k, y)
+                    .reorder(k, y).parallel(y, 8).vectorize(x, 8);
+            }
+            for (int j = 0; j < fine_levels; j++) {
+                outGPyramid[j]
+                    .compute_at(output, xo).vectorize(x, 8);
+            }
+            for (int j = fine_levels; j < J; j++) {
+                inGPyramid[j].compute_root();
+                gPyramid[j].compute_root().parallel(k);
+                outGPyramid[j].compute_root();
+            }
+        } else if (schedule == Schedule::ParallelChannels) {
+            // Compute each level of the pyramids over the whole
+            // image, with the processed pyramid in parallel over its
+            // intensity levels, which are independent until the
+            // output pyramid interpolates between them.
+            output.reorder(c, x, y).parallel(y, 8).vectorize(x, 8);
+            gray.compute_root().parallel(y, 32).vectorize(x, 8);
+            for (int j = 1; j < J; j++) {
+                inGPyramid[j].compute_root();
+                gPyramid[j].compute_root().reorder(x, y, k).parallel(k);
+                outGPyramid[j].compute_root();
+                if (j < fine_levels) {
+                    inGPyramid[j].parallel(y, 8).vectorize(x, 8);
+                    gPyramid[j].vectorize(x, 8);
+                    outGPyramid[j].parallel(y, 8).vectorize(x, 8);
+                }
+            }
+            outGPyramid[0].compute_at(output, y).vectorize(x, 8);
+        } else {
+            // Compute the fine levels of all of the pyramids for each
+            // strip of the output. The input pyramids are computed
+            // once per strip, and the output pyramid slides down the
+            // strip with the output, in storage folded to the few rows
+            // each level needs at a time. The coarser levels are
+            // computed over the whole image, as described at
+            // tile_size.
+            int strip_levels = 1;
+            while (strip_levels < J && (tile >> strip_levels) >= 8) {
+                strip_levels++;
+            }
+            Var yo("yo");
+            output.reorder(c, x, y).split(y, yo, y, tile).parallel(yo).vectorize(x, 8);
+            gray.compute_at(output, yo).vectorize(x, 8);
+            for (int j = 1; j < J; j++) {
+                if (j < strip_levels) {
+                    inGPyramid[j].compute_at(output, yo).vectorize(x, 8);
+                    gPyramid[j].compute_at(output, yo).reorder_storage(x, k, y)
+                        .reorder(k, y).vectorize(x, 8);
+                    outGPyramid[j].store_at(output, yo).compute_at(output, y).vectorize(x, 8);
+                } else if (j < fine_levels) {
+                    inGPyramid[j].compute_root().parallel(y, 8).vectorize(x, 8);
+                    gPyramid[j].compute_root().reorder_storage(x, k, y)
+                        .reorder(k, y).parallel(y, 8).vectorize(x, 8);
+                    outGPyramid[j].compute_root().parallel(y, 8).vectorize(x, 8);
+                } else {
+                    inGPyramid[j].compute_root();
+                    gPyramid[j].compute_root().parallel(k);
+                    outGPyramid[j].compute_root();
+                }
+            }
+            outGPyramid[0].compute_at(output, y).vectorize(x, 8);
+        }
+
+        return output;
+    }
+};
+
+Halide::RegisterGenerator<LocalLaplacian> register_local_laplacian{"local_laplacian"};
+
+}  // namespace
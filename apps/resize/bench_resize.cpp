@@ -0,0 +1,147 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "resize_box.h"
+#include "resize_linear.h"
+#include "resize_cubic.h"
+#include "resize_lanczos.h"
+#include "box_downscale_2.h"
+#include "box_downscale_4.h"
+#include "resize_box_float.h"
+#include "resize_linear_float.h"
+#include "resize_cubic_float.h"
+#include "resize_lanczos_float.h"
+#include "box_downscale_2_float.h"
+#include "box_downscale_4_float.h"
+
+#include "HalideRuntime.h"
+#include "benchmark.h"
+#include "halide_image.h"
+
+using namespace Halide::Tools;
+
+// Check that each interpolation preserves a constant image, and that
+// its 8-bit fixed point results are within one of its floating point
+// results, then print the throughput of each over a range of scale
+// factors, in megapixels of the output and of the input per second.
+// The first call for each scale factor computes the tables of weights,
+// which later calls find in the cache, so its time is shown separately.
+
+const int width = 1920, height = 1080, channels = 3;
+
+typedef int (*ResizeFunction)(buffer_t *, float, buffer_t *);
+
+struct Variant {
+    const char *name;
+    float scale_factor;
+    std::function<int(buffer_t *, buffer_t *)> run;
+    // The same in floating point, for images in [0, 1].
+    std::function<int(buffer_t *, buffer_t *)> run_float;
+};
+
+int main(int argc, char **argv) {
+    Image<uint8_t> input(width, height, channels), constant(width, height, channels);
+    Image<float> input_float(width, height, channels);
+    for (int c = 0; c < channels; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                input(x, y, c) = rand() & 0xff;
+                input_float(x, y, c) = input(x, y, c) / 255.0f;
+                constant(x, y, c) = 100;
+            }
+        }
+    }
+
+    struct {
+        const char *name;
+        ResizeFunction resize, resize_float;
+    } interpolations[] = {
+        { "box", resize_box, resize_box_float },
+        { "linear", resize_linear, resize_linear_float },
+        { "cubic", resize_cubic, resize_cubic_float },
+        { "lanczos", resize_lanczos, resize_lanczos_float }
+    };
+    const float scale_factors[] = {0.25f, 1.0f / 3, 0.5f, 0.7f, 1.5f, 2.0f};
+
+    std::vector<Variant> variants;
+    for (float s : scale_factors) {
+        for (auto &i : interpolations) {
+            ResizeFunction resize = i.resize, resize_float = i.resize_float;
+            variants.push_back({i.name, s,
+                                [=](buffer_t *in, buffer_t *out) { return resize(in, s, out); },
+                                [=](buffer_t *in, buffer_t *out) { return resize_float(in, s, out); }});
+        }
+        if (s == 0.5f) {
+            variants.push_back({"box_downscale_2", s, box_downscale_2, box_downscale_2_float});
+        } else if (s == 0.25f) {
+            variants.push_back({"box_downscale_4", s, box_downscale_4, box_downscale_4_float});
+        }
+    }
+
+    for (const Variant &v : variants) {
+        int out_width = width * v.scale_factor, out_height = height * v.scale_factor;
+        Image<uint8_t> output(out_width, out_height, channels);
+        if (v.run(constant, output) != 0) {
+            printf("%s failed\n", v.name);
+            return -1;
+        }
+        for (int c = 0; c < channels; c++) {
+            for (int y = 0; y < out_height; y++) {
+                for (int x = 0; x < out_width; x++) {
+                    if (output(x, y, c) != 100) {
+                        printf("%s with scale factor %g changed a constant image at %d %d %d: %d\n",
+                               v.name, v.scale_factor, x, y, c, output(x, y, c));
+                        return -1;
+                    }
+                }
+            }
+        }
+
+        // The rounding of the fixed point weights and of the
+        // intermediate result of the vertical pass may move the result
+        // by at most one from the floating point one.
+        Image<float> output_float(out_width, out_height, channels);
+        if (v.run(input, output) != 0 || v.run_float(input_float, output_float) != 0) {
+            printf("%s failed\n", v.name);
+            return -1;
+        }
+        for (int c = 0; c < channels; c++) {
+            for (int y = 0; y < out_height; y++) {
+                for (int x = 0; x < out_width; x++) {
+                    float expected = output_float(x, y, c) * 255.0f;
+                    if (std::abs(output(x, y, c) - expected) > 1.0f) {
+                        printf("%s with scale factor %g is %d at %d %d %d, but %g in floating point\n",
+                               v.name, v.scale_factor, output(x, y, c), x, y, c, expected);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("%-16s %7s %11s %14s %10s %15s\n",
+           "interpolation", "scale", "output size", "first call ms", "MPix/s", "input MPix/s");
+    for (const Variant &v : variants) {
+        int out_width = width * v.scale_factor, out_height = height * v.scale_factor;
+        Image<uint8_t> output(out_width, out_height, channels);
+
+        // Empty the cache, so that the first call computes the tables
+        // of weights again.
+        halide_memoization_cache_cleanup();
+        double first = benchmark(1, 1, [&]() { v.run(input, output); });
+        double t = benchmark(5, 1, [&]() { v.run(input, output); });
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", out_width, out_height);
+        printf("%-16s %7.3f %11s %14.3f %10.2f %15.2f\n",
+               v.name, v.scale_factor, size, first * 1e3,
+               out_width * out_height / t * 1e-6, width * height / t * 1e-6);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
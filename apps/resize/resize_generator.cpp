@@ -0,0 +1,252 @@
+#include "Halide.h"
+
+namespace {
+
+using namespace Halide;
+
+enum class Interpolation { Box, Linear, Cubic, Lanczos };
+
+Expr kernel_box(Expr x) {
+    Expr xx = abs(x);
+    return select(xx <= 0.5f, 1.0f, 0.0f);
+}
+
+Expr kernel_linear(Expr x) {
+    Expr xx = abs(x);
+    return select(xx < 1.0f, 1.0f - xx, 0.0f);
+}
+
+Expr kernel_cubic(Expr x) {
+    Expr xx = abs(x);
+    Expr xx2 = xx * xx;
+    Expr xx3 = xx2 * xx;
+    float a = -0.5f;
+
+    return select(xx < 1.0f, (a + 2.0f) * xx3 - (a + 3.0f) * xx2 + 1,
+                  select (xx < 2.0f, a * xx3 - 5 * a * xx2 + 8 * a * xx - 4.0f * a,
+                          0.0f));
+}
+
+Expr sinc(Expr x) {
+    return sin(float(M_PI) * x) / x;
+}
+
+Expr kernel_lanczos(Expr x) {
+    Expr value = sinc(x) * sinc(x/3);
+    value = select(x == 0.0f, 1.0f, value); // Take care of singularity at zero
+    value = select(x > 3 || x < -3, 0.0f, value); // Clamp to zero out of bounds
+    return value;
+}
+
+struct KernelInfo {
+    const char *name;
+    float size;
+    Expr (*kernel)(Expr);
+};
+
+const KernelInfo kernel_info[] = {
+    { "box", 0.5f, kernel_box },
+    { "linear", 1.0f, kernel_linear },
+    { "cubic", 2.0f, kernel_cubic },
+    { "lanczos", 3.0f, kernel_lanczos }
+};
+
+// The 8-bit path computes in fixed point. The weights have 14
+// fractional bits, so that the largest fits in an int16, and the
+// intermediate result of the vertical pass keeps 6 fractional bits.
+const int weight_bits = 14;
+const int intermediate_bits = 6;
+
+// The taps of the kernel along one dimension of the resize, for each
+// output coordinate.
+struct Taps {
+    // The first input coordinate that contributes to the output
+    // coordinate, as a function of the output coordinate.
+    Expr begin;
+    // The number of taps, which is the same for every output
+    // coordinate.
+    Expr count;
+    // The table of the weights, indexed by the output coordinate and
+    // the tap. The weights sum to one, or to 1 << weight_bits in fixed
+    // point.
+    Func weights;
+};
+
+// Make the taps of the kernel for the output coordinate v. The weights
+// depend only on the scale factor, so the table is memoized, and is
+// only recomputed when the scale factor or the size of the output
+// changes.
+Taps make_taps(Var v, Var k, Expr scale_factor, const KernelInfo &info,
+               bool fixed_point, const std::string &name) {
+    // For downscaling, widen the interpolation kernel to perform lowpass
+    // filtering.
+    Expr kernel_scaling = min(scale_factor, 1.0f);
+    Expr kernel_size = info.size / kernel_scaling;
+
+    // The (non-integer) coordinate inside the source image.
+    Expr source = (v + 0.5f) / scale_factor;
+
+    Taps taps;
+    taps.begin = cast<int>(floor(source - kernel_size));
+    taps.count = cast<int>(ceil(2.0f * kernel_size)) + 1;
+
+    RDom r(0, taps.count, name + "_r");
+    Func unnormalized(name + "_unnormalized");
+    unnormalized(v, k) = info.kernel((taps.begin + k + 0.5f - source) * kernel_scaling);
+    Func total(name + "_total");
+    total(v) = sum(unnormalized(v, r));
+    Func normalized(name + "_normalized");
+    normalized(v, k) = unnormalized(v, k) / total(v);
+
+    // Each row of the table is computed together, so that the kernel
+    // is evaluated once per tap, rather than once per tap for each of
+    // the sums over the row.
+    taps.weights = Func(name);
+    std::vector<Func> per_row = {unnormalized, total, normalized};
+    if (fixed_point) {
+        Func rounded(name + "_rounded");
+        rounded(v, k) = cast<int16_t>(round(normalized(v, k) * (1 << weight_bits)));
+        // Add the rounding error to the tap nearest the source
+        // coordinate, so that the weights sum exactly to one and flat
+        // areas stay flat.
+        Func error(name + "_error");
+        error(v) = (1 << weight_bits) - sum(cast<int32_t>(rounded(v, r)));
+        Expr center = clamp(cast<int>(floor(source)) - taps.begin, 0, taps.count - 1);
+        taps.weights(v, k) = rounded(v, k) + select(k == center, cast<int16_t>(error(v)), cast<int16_t>(0));
+        per_row.push_back(rounded);
+        per_row.push_back(error);
+    } else {
+        taps.weights(v, k) = normalized(v, k);
+    }
+    taps.weights.compute_root().memoize();
+    for (Func f : per_row) {
+        f.compute_at(taps.weights, v);
+    }
+    return taps;
+}
+
+// Resize an image with arbitrary scale factor, with a separable
+// kernel. 8-bit images are resized in fixed point.
+class Resize : public Generator<Resize> {
+public:
+    GeneratorParam<Interpolation> interpolation{"interpolation", Interpolation::Cubic,
+            {{"box", Interpolation::Box},
+             {"linear", Interpolation::Linear},
+             {"cubic", Interpolation::Cubic},
+             {"lanczos", Interpolation::Lanczos}}};
+    // The type of the input and output, UInt(8) or Float(32). Images
+    // of floats are in [0, 1].
+    GeneratorParam<Type> input_type{"input_type", UInt(8)};
+
+    ImageParam input{UInt(8), 3, "input"};
+    Param<float> scale_factor{"scale_factor"};
+
+    Func build() {
+        input = ImageParam(input_type, input.dimensions(), input.name());
+        user_assert(input.type() == UInt(8) || input.type() == Float(32))
+            << "resize only supports UInt(8) and Float(32) images\n";
+        const bool fixed_point = input.type() == UInt(8);
+        const KernelInfo &info = kernel_info[(int)(Interpolation)interpolation];
+
+        Var x("x"), y("y"), c("c"), k("k");
+
+        Func clamped = BoundaryConditions::repeat_edge(input);
+
+        Taps taps_x = make_taps(x, k, scale_factor, info, fixed_point, "kernel_x");
+        Taps taps_y = make_taps(y, k, scale_factor, info, fixed_point, "kernel_y");
+        RDom rx(0, taps_x.count, "rx"), ry(0, taps_y.count, "ry");
+
+        // The columns are resized first, so that each row of the
+        // output needs just one row of the intermediate, which is the
+        // width of the input.
+        Func resized_y("resized_y");
+        Func resized_x("resized_x");
+        if (fixed_point) {
+            Expr in = cast<int32_t>(clamped(x, taps_y.begin + ry, c));
+            Expr total = sum(cast<int32_t>(taps_y.weights(y, ry)) * in);
+            const int shift = weight_bits - intermediate_bits;
+            resized_y(x, y, c) = cast<int16_t>((total + (1 << (shift - 1))) >> shift);
+
+            Expr col = cast<int32_t>(resized_y(taps_x.begin + rx, y, c));
+            total = sum(cast<int32_t>(taps_x.weights(x, rx)) * col);
+            const int bits = weight_bits + intermediate_bits;
+            resized_x(x, y, c) = cast<uint8_t>(clamp((total + (1 << (bits - 1))) >> bits, 0, 255));
+        } else {
+            resized_y(x, y, c) = sum(taps_y.weights(y, ry) * clamped(x, taps_y.begin + ry, c));
+            resized_x(x, y, c) = clamp(sum(taps_x.weights(x, rx) * resized_y(taps_x.begin + rx, y, c)),
+                                       0.0f, 1.0f);
+        }
+
+        // Strips of rows of the output are computed in parallel,
+        // vectorized along the rows, with all the channels of each row
+        // together.
+        const int vector_width = get_target().natural_vector_size(fixed_point ? Int(16) : Float(32));
+        Var yo("yo");
+        resized_x
+            .reorder(x, c, y)
+            .split(y, yo, y, 8)
+            .parallel(yo)
+            .vectorize(x, vector_width);
+        resized_y
+            .compute_at(resized_x, y)
+            .vectorize(x, vector_width);
+
+        return resized_x;
+    }
+};
+
+// Downscale an image by an integer factor, usually 2 or 4, by
+// averaging each square block of the input. This is much cheaper than
+// the box interpolation of Resize for the same factor, because the
+// weights are known at compile time.
+class BoxDownscale : public Generator<BoxDownscale> {
+public:
+    GeneratorParam<int> factor{"factor", 2, 2, 8};
+    GeneratorParam<Type> input_type{"input_type", UInt(8)};
+
+    ImageParam input{UInt(8), 3, "input"};
+
+    Func build() {
+        input = ImageParam(input_type, input.dimensions(), input.name());
+        user_assert(input.type() == UInt(8) || input.type() == Float(32))
+            << "box_downscale only supports UInt(8) and Float(32) images\n";
+        const bool fixed_point = input.type() == UInt(8);
+        const int f = factor;
+
+        Var x("x"), y("y"), c("c");
+
+        // The sum of the block is unrolled, so that the loads of each
+        // row of it can be vectorized. A uint16 holds the sum of up to
+        // 257 8-bit values.
+        Type sum_type = fixed_point ? UInt(16) : Float(32);
+        Expr total;
+        for (int j = 0; j < f; j++) {
+            for (int i = 0; i < f; i++) {
+                Expr in = cast(sum_type, input(f * x + i, f * y + j, c));
+                total = total.defined() ? total + in : in;
+            }
+        }
+
+        Func downscaled("downscaled");
+        if (fixed_point) {
+            downscaled(x, y, c) = cast<uint8_t>((total + f * f / 2) / (f * f));
+        } else {
+            downscaled(x, y, c) = total / (f * f);
+        }
+
+        const int vector_width = get_target().natural_vector_size(sum_type);
+        Var yo("yo");
+        downscaled
+            .reorder(x, c, y)
+            .split(y, yo, y, 8)
+            .parallel(yo)
+            .vectorize(x, vector_width);
+
+        return downscaled;
+    }
+};
+
+RegisterGenerator<Resize> register_resize{"resize"};
+RegisterGenerator<BoxDownscale> register_box_downscale{"box_downscale"};
+
+}  // namespace
@@ -0,0 +1,106 @@
+#ifndef SCHEDULE_BENCHMARK_H
+#define SCHEDULE_BENCHMARK_H
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "HalideRuntime.h"
+#include "benchmark.h"
+
+// Compare the throughput and the peak memory use of several ahead of
+// time compiled variants of a pipeline, such as a Generator compiled
+// with each of its schedules, over a range of thread counts. The
+// peak memory is of the buffers the pipelines allocate with
+// halide_malloc. It doesn't include the inputs and outputs, or the
+// small intermediates that Halide places on the stack.
+
+namespace schedule_benchmark {
+
+static std::atomic<size_t> current_bytes(0), peak_bytes(0);
+
+static void *tracking_malloc(void *user_context, size_t x) {
+    // Halide requires halide_malloc to return memory aligned to the
+    // natural vector width that can be read a little beyond either
+    // end. Keep the original pointer and the size just before the
+    // aligned pointer.
+    void *orig = malloc(x + 96);
+    if (orig == NULL) {
+        return NULL;
+    }
+    void *ptr = (void *)((((size_t)orig + 64) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    ((size_t *)ptr)[-2] = x;
+
+    size_t now = (current_bytes += x);
+    size_t peak = peak_bytes;
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now)) {
+    }
+    return ptr;
+}
+
+static void tracking_free(void *user_context, void *ptr) {
+    current_bytes -= ((size_t *)ptr)[-2];
+    free(((void **)ptr)[-1]);
+}
+
+struct Variant {
+    const char *name;
+    // Runs the pipeline once, and returns its error code.
+    std::function<int()> run;
+};
+
+// The thread counts to compare: the powers of two less than the
+// number of cores, and the number of cores.
+static std::vector<int> thread_counts() {
+    int cores = std::thread::hardware_concurrency();
+    if (cores < 1) {
+        cores = 1;
+    }
+    std::vector<int> counts;
+    for (int t = 1; t < cores; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(cores);
+    return counts;
+}
+
+static void print_header() {
+    printf("%-28s %11s %7s %10s %14s\n", "schedule", "size", "threads", "MPix/s", "peak memory MB");
+}
+
+// Run each variant on an image of the given size with each thread
+// count, and print a row of the table for each. Returns zero, or the
+// first error code returned by a variant.
+static int compare(int width, int height, const std::vector<Variant> &variants, int samples = 3) {
+    halide_set_custom_malloc(tracking_malloc);
+    halide_set_custom_free(tracking_free);
+
+    for (int threads : thread_counts()) {
+        halide_set_num_threads(threads);
+        for (const Variant &v : variants) {
+            // The first run also warms up the thread pool and the caches.
+            peak_bytes = current_bytes.load();
+            int result = v.run();
+            if (result != 0) {
+                printf("%s failed with error code %d\n", v.name, result);
+                return result;
+            }
+            double peak_mb = (peak_bytes - current_bytes) / (1024.0 * 1024.0);
+
+            double t = benchmark(samples, 1, [&]() { v.run(); });
+            char size[32];
+            snprintf(size, sizeof(size), "%dx%d", width, height);
+            printf("%-28s %11s %7d %10.2f %14.2f\n",
+                   v.name, size, threads, width * height / t * 1e-6, peak_mb);
+        }
+    }
+    return 0;
+}
+
+}  // namespace schedule_benchmark
+
+#endif
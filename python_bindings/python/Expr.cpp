@@ -49,9 +49,10 @@ void defineExpr()
                                       "The following math global functions are also available::\n" \
                                       "Unary:\n" \
                                       "  abs acos acosh asin asinh atan atanh ceil cos cosh exp\n" \
-                                      "  fast_exp fast_log floor log round sin sinh sqrt tan tanh\n" \
+                                      "  fast_atan fast_cos fast_exp fast_log fast_sin fast_tanh floor log\n" \
+                                      "  round sin sinh sqrt tan tanh\n" \
                                       "Binary:\n" \
-                                      "  hypot fast_pow max min pow\n\n" \
+                                      "  hypot fast_atan2 fast_pow max min pow\n\n" \
                                       "Ternary:\n" \
                                       "  clamp(x, lo, hi)                  -- Clamp expression to [lo, hi]\n" \
                                       "  select(cond, if_true, if_false)   -- Return if_true if cond else if_false\n")
@@ -12,6 +12,7 @@
 #include "Func_Stage.h"
 #include "Func_VarOrRVar.h"
 #include "Func_gpu.h"
+#include "Image.h"
 
 #include <vector>
 #include <string>
@@ -20,8 +21,27 @@ namespace h = Halide;
 namespace p = boost::python;
 
 
+/// Releases the GIL for the lifetime of the object, so that other python threads
+/// can run while a pipeline executes. Nothing in between may touch python objects.
+struct ScopedGILRelease
+{
+    PyThreadState *thread_state;
+
+    ScopedGILRelease()
+    {
+        thread_state = PyEval_SaveThread();
+    }
+
+    ~ScopedGILRelease()
+    {
+        PyEval_RestoreThread(thread_state);
+    }
+};
+
+
 h::Realization func_realize0(h::Func &that, std::vector<int32_t> sizes, const h::Target &target = h::Target())
 {
+    ScopedGILRelease gil_release;
     return that.realize(sizes, target);
 }
 
@@ -31,6 +51,7 @@ BOOST_PYTHON_FUNCTION_OVERLOADS( func_realize0_overloads, func_realize0, 2, 3)
 h::Realization func_realize1(h::Func &that, int x_size=0, int y_size=0, int z_size=0, int w_size=0,
                              const h::Target &target = h::Target())
 {
+    ScopedGILRelease gil_release;
     return that.realize(x_size, y_size, z_size, w_size, target);
 }
 
@@ -39,6 +60,7 @@ BOOST_PYTHON_FUNCTION_OVERLOADS(func_realize1_overloads, func_realize1, 1, 6)
 
 void func_realize2(h::Func &that, h::Realization dst, const h::Target &target = h::Target())
 {
+    ScopedGILRelease gil_release;
     that.realize(dst, target);
     return;
 }
@@ -48,6 +70,7 @@ BOOST_PYTHON_FUNCTION_OVERLOADS(func_realize2_overloads, func_realize2, 2, 3)
 
 void func_realize3(h::Func &that, h::Buffer dst, const h::Target &target = h::Target())
 {
+    ScopedGILRelease gil_release;
     that.realize(dst, target);
     return;
 }
@@ -55,6 +78,18 @@ void func_realize3(h::Func &that, h::Buffer dst, const h::Target &target = h::Ta
 BOOST_PYTHON_FUNCTION_OVERLOADS(func_realize3_overloads, func_realize3, 2, 3)
 
 
+/// Realize directly into the memory of a numpy array (no copy).
+void func_realize4(h::Func &that, p::object dst_array, const h::Target &target = h::Target())
+{
+    h::Buffer dst = ndarray_to_buffer(dst_array);
+    ScopedGILRelease gil_release;
+    that.realize(dst, target);
+    return;
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(func_realize4_overloads, func_realize4, 2, 3)
+
+
 void func_compile_jit0(h::Func &that)
 {
     that.compile_jit();
@@ -404,6 +439,14 @@ void defineFunc()
                    "may result in a non-deterministic routine that returns "
                    "different values at different times or on different machines.");
 
+    // Registered first so that it is tried last: it accepts any python object,
+    // and only numpy arrays that did not match the other overloads should reach it.
+    func_class.def("realize", &func_realize4, func_realize4_overloads(
+                       p::args("self", "dst", "target"),
+                       "Evaluate this function directly into a numpy array. "
+                       "The array memory and strides are used as-is (no copy), "
+                       "and the array dtype must match the type of the function."));
+
     func_class.def("realize", &func_realize1,
                    func_realize1_overloads(
                        p::args("self", "x_size", "y_size", "z_size", "w_size", "target"),
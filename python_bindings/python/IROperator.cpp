@@ -486,22 +486,62 @@ void defineOperators()
            "Float(32). Accurate up to the last three bits of the "
            "mantissa. Vectorizes cleanly.");
 
-    p::def("fast_log", &h::fast_log, p::args("x"),
+    p::enum_<h::ApproximationPrecision>("ApproximationPrecision",
+                                        "The accuracy tiers of the fast approximate transcendentals. "
+                                        "Low, Medium and High bound the maximum error by 1e-3, 1e-5 "
+                                        "and 5e-7.")
+            .value("Low", h::ApproximationPrecision::Low)
+            .value("Medium", h::ApproximationPrecision::Medium)
+            .value("High", h::ApproximationPrecision::High)
+            .export_values()
+            ;
+
+    p::def("fast_log", &h::fast_log,
+           (p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
            "Fast approximate cleanly vectorizable log for Float(32). Returns "
-           "nonsense for x <= 0.0f. Accurate up to the last 5 bits of the "
+           "nonsense for x <= 0.0f, except with ApproximationPrecision.High. "
+           "The default precision is accurate up to the last 5 bits of the "
            "mantissa. Vectorizes cleanly.");
 
-    p::def("fast_exp", &h::fast_exp, p::args("x"),
+    p::def("fast_exp", &h::fast_exp,
+           (p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
            "Fast approximate cleanly vectorizable exp for Float(32). Returns "
-           "nonsense for inputs that would overflow or underflow. Typically "
+           "nonsense for inputs that would overflow or underflow, except with "
+           "ApproximationPrecision.High. The default precision is typically "
            "accurate up to the last 5 bits of the mantissa. Gets worse when "
            "approaching overflow. Vectorizes cleanly.");
 
-    p::def("fast_pow", &h::fast_pow, p::args("x"),
+    p::def("fast_pow", &h::fast_pow,
+           (p::arg("x"), p::arg("y"), p::arg("precision") = h::ApproximationPrecision::Medium),
            "Fast approximate cleanly vectorizable pow for Float(32). Returns "
            "nonsense for x < 0.0f. Accurate up to the last 5 bits of the "
-           "mantissa for typical exponents. Gets worse when approaching "
-           "overflow. Vectorizes cleanly.");
+           "mantissa for typical exponents at the default precision. Gets "
+           "worse when approaching overflow. Vectorizes cleanly.");
+
+    p::def("fast_sin", &h::fast_sin,
+           (p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
+           "Fast approximate cleanly vectorizable sine for Float(32). The error "
+           "bound of the precision holds for |x| < 10^4. Vectorizes cleanly.");
+
+    p::def("fast_cos", &h::fast_cos,
+           (p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
+           "Fast approximate cleanly vectorizable cosine for Float(32). The error "
+           "bound of the precision holds for |x| < 10^4. Vectorizes cleanly.");
+
+    p::def("fast_atan", &h::fast_atan,
+           (p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
+           "Fast approximate cleanly vectorizable arctangent for Float(32). "
+           "Vectorizes cleanly.");
+
+    p::def("fast_atan2", &h::fast_atan2,
+           (p::arg("y"), p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
+           "Fast approximate cleanly vectorizable atan2 for Float(32). "
+           "Vectorizes cleanly.");
+
+    p::def("fast_tanh", &h::fast_tanh,
+           (p::arg("x"), p::arg("precision") = h::ApproximationPrecision::Medium),
+           "Fast approximate cleanly vectorizable hyperbolic tangent for "
+           "Float(32). Vectorizes cleanly.");
 
     p::def("fast_inverse", &h::fast_inverse, p::args("x"),
            "Fast approximate inverse for Float(32). Corresponds to the rcpps "
@@ -600,8 +600,14 @@ buffer_t ndarray_to_buffer_t(bn::ndarray &array)
         if (c < array.get_nd())
         {
             raw_buffer.extent[c] = array.shape(c);
-            // numpy counts stride in bytes, while Halide counts in number of elements
-            user_assert((array.strides(c) % raw_buffer.elem_size) == 0);
+            // numpy counts stride in bytes, while Halide counts in number of elements.
+            // Views such as a[:, ::2] or a.T keep their strides, so no copy is needed,
+            // but a byte stride that is not a whole number of elements cannot be wrapped.
+            if ((array.strides(c) % raw_buffer.elem_size) != 0)
+            {
+                throw std::invalid_argument("numpy_to_image received an array whose strides "
+                                            "are not a multiple of its element size");
+            }
             raw_buffer.stride[c] = array.strides(c) / raw_buffer.elem_size;
         }
         else
@@ -622,6 +628,19 @@ p::object ndarray_to_image(bn::ndarray &array, const std::string name="")
     return raw_buffer_to_image(array, raw_buffer, name);
 }
 
+h::Buffer ndarray_to_buffer(p::object array_object, const std::string &name)
+{
+    p::extract<bn::ndarray> array_extract(array_object);
+    if(array_extract.check() == false)
+    {
+        throw std::invalid_argument("ndarray_to_buffer received an object that is not a numpy array");
+    }
+
+    bn::ndarray array = array_extract();
+    p::object image = ndarray_to_image(array, name);
+    return p::extract<h::Buffer>(image.attr("buffer")());
+}
+
 
 namespace std
 {
@@ -686,26 +705,21 @@ bn::ndarray image_to_ndarray(p::object image_object)
     const h::Type& t = p::extract<h::Type &>(image_object.attr("type")());
 
     buffer_t &raw_buffer = *b.raw_buffer();
-    std::vector<std::int32_t> shape_array(4), stride_array(4);
-    std::copy(raw_buffer.extent, raw_buffer.extent + 4, shape_array.begin());
-    std::copy(raw_buffer.stride, raw_buffer.stride + 4, stride_array.begin());
 
-
-    // we make sure the array shape does not include the "0 extent" dimensions
+    // we make sure the array shape does not include the trailing "0 extent" dimensions
     // we always keep at least one dimension (even if zero size)
-    for(size_t i = 3; i > 0; i -= 1)
+    int dimensions = 4;
+    while(dimensions > 1 && raw_buffer.extent[dimensions - 1] == 0)
     {
-        if(shape_array[i] == 0)
-        {
-            shape_array.pop_back();
-            stride_array.pop_back();
-        }
+        dimensions -= 1;
     }
 
-    // numpy counts stride in bytes, while Halide counts in number of elements
-    for(size_t i = 0; i < 4; i += 1)
+    std::vector<Py_intptr_t> shape_array(dimensions), stride_array(dimensions);
+    for(int i = 0; i < dimensions; i += 1)
     {
-        stride_array[i] *= raw_buffer.elem_size;
+        shape_array[i] = raw_buffer.extent[i];
+        // numpy counts stride in bytes, while Halide counts in number of elements
+        stride_array[i] = static_cast<Py_intptr_t>(raw_buffer.stride[i]) * raw_buffer.elem_size;
     }
 
     return bn::from_data(
@@ -716,6 +730,12 @@ bn::ndarray image_to_ndarray(p::object image_object)
                 image_object);
 }
 
+#else
+
+h::Buffer ndarray_to_buffer(p::object array_object, const std::string &name)
+{
+    throw std::runtime_error("ndarray_to_buffer requires the bindings to be built with numpy support");
+}
 
 #endif
 
@@ -898,6 +918,12 @@ void defineImage()
            "Creates a numpy array from a Halide::Image."
            "Will take into account the Image size, dimensions, and type."
            "Created ndarray refers to the Image data (no copy).");
+
+    p::def("ndarray_to_buffer", &ndarray_to_buffer, (p::arg("array"), p::arg("name")=""),
+           p::with_custodian_and_ward_postcall<0, 1>(), // the array reference count is increased
+           "Wrap a numpy array in a Halide::Buffer. "
+           "The buffer_t uses the array memory and strides directly (no copy), "
+           "so non-contiguous views such as a[:, ::2] or a.T can be passed as well.");
 #endif
 
     return;
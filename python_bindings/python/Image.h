@@ -1,8 +1,17 @@
 #ifndef IMAGE_H
 #define IMAGE_H
 
+// to avoid compiler confusion, python.hpp must be include before Halide headers
+#include <boost/python.hpp>
+#include "../../src/Buffer.h"
+
+#include <string>
 
 void defineImage();
 
+/// Wraps the memory and strides of a numpy array as a Halide::Buffer, without copying.
+/// The array must stay alive for as long as the returned Buffer is used.
+Halide::Buffer ndarray_to_buffer(boost::python::object array, const std::string &name = "");
+
 
 #endif // IMAGE_H
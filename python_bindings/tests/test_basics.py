@@ -270,6 +270,39 @@ def test_image_to_ndarray():
 
     return
 
+def test_ndarray_zero_copy():
+
+    if "ndarray_to_buffer" not in globals():
+        print("Skipping test_ndarray_zero_copy")
+        return
+
+    import numpy
+
+    # A strided view must be wrapped as-is, without a copy.
+    a0 = numpy.arange(40*30, dtype=numpy.int32).reshape((40, 30))
+    v0 = a0[::2, 1::3]
+    b0 = ndarray_to_buffer(v0)
+    assert b0.stride(0) == v0.strides[0] // 4
+    assert b0.stride(1) == v0.strides[1] // 4
+    i0 = Image(Int(32), b0)
+    assert i0(3, 4) == v0[3, 4]
+    i0[3, 4] = -1
+    assert a0[6, 13] == -1
+
+    # Realizing into an array writes straight into its memory.
+    x, y = Var("x"), Var("y")
+    f = Func("f")
+    f[x, y] = cast(Int(32), x + y*100)
+    a1 = numpy.zeros((64, 32), dtype=numpy.int32, order="F")
+    f.realize(a1)
+    assert a1[5, 7] == 5 + 7*100
+
+    a2 = numpy.zeros((32, 64), dtype=numpy.int32).T
+    f.realize(a2)
+    assert a2[5, 7] == 5 + 7*100
+
+    return
+
 def test_param_bug():
     "see https://github.com/rodrigob/Halide/issues/1"
 
@@ -297,6 +330,7 @@ if __name__ == "__main__":
     test_float_or_int()
     test_ndarray_to_image()
     test_image_to_ndarray()
+    test_ndarray_zero_copy()
     test_types()
     test_operator_order()
     test_basics()
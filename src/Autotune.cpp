@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "Autotune.h"
+#include "Debug.h"
+#include "JITModule.h"
+
+namespace Halide {
+
+using Internal::GeneratorParamValues;
+using Internal::GeneratorRegistry;
+using Internal::JITModule;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Tuned params are recorded for the target an AOT build would use,
+// which doesn't have the JIT feature.
+string target_key(const Target &t) {
+    return t.without_feature(Target::JIT).to_string();
+}
+
+// Time one call of the function, as in test/performance/benchmark.h.
+double time_calls(JITModule::argv_wrapper f, const vector<const void *> &args,
+                  int samples, int iterations) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < samples; i++) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (int j = 0; j < iterations; j++) {
+            if (f(const_cast<const void **>(args.data())) != 0) {
+                return std::numeric_limits<double>::infinity();
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double dt = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+        best = std::min(best, dt);
+    }
+    return best / iterations;
+}
+
+// Build, compile and time one configuration. Returns infinity if it
+// fails.
+double evaluate(const string &generator_name, const GeneratorParamValues &params,
+                const vector<const void *> &args, const AutotuneOptions &options) {
+    #ifdef WITH_EXCEPTIONS
+    try {
+    #endif
+        auto gen = GeneratorRegistry::create(generator_name, params);
+        user_assert(gen != nullptr) << "Unknown generator: " << generator_name << "\n";
+        Module m = gen->build_module(generator_name);
+        JITModule jit(m, m.functions().back());
+        JITModule::argv_wrapper f = jit.argv_function();
+
+        // Run once untimed, so that one-time costs (e.g. touching the
+        // inputs for the first time) aren't counted.
+        if (f(const_cast<const void **>(args.data())) != 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return time_calls(f, args, options.samples, options.iterations);
+    #ifdef WITH_EXCEPTIONS
+    } catch (const CompileError &e) {
+        Internal::debug(1) << "Configuration failed to compile: " << e.what() << "\n";
+        return std::numeric_limits<double>::infinity();
+    }
+    #endif
+}
+
+}
+
+AutotuneResult autotune(const string &generator_name,
+                        const GeneratorParamValues &fixed_params,
+                        const vector<TunableParam> &space,
+                        const vector<const void *> &args,
+                        const AutotuneOptions &options) {
+    auto target_param = fixed_params.find("target");
+    user_assert(target_param != fixed_params.end())
+        << "autotune: the fixed params must include a target\n";
+    Target target(target_param->second);
+
+    size_t num_configs = 1;
+    for (const TunableParam &p : space) {
+        user_assert(!p.values.empty())
+            << "autotune: no values given for GeneratorParam " << p.name << "\n";
+        user_assert(!fixed_params.count(p.name))
+            << "autotune: GeneratorParam " << p.name << " is both fixed and tuned\n";
+        num_configs = std::min(num_configs * p.values.size(), (size_t)std::numeric_limits<int>::max());
+    }
+    size_t budget = std::min(num_configs, (size_t)std::max(1, options.max_evaluations));
+
+    // A configuration is the index of the value used for each param.
+    typedef vector<int> Config;
+    std::map<Config, double> times;
+
+    auto params_of = [&](const Config &c) {
+        GeneratorParamValues params;
+        for (size_t i = 0; i < space.size(); i++) {
+            params[space[i].name] = space[i].values[c[i]];
+        }
+        return params;
+    };
+
+    auto time_of = [&](const Config &c) {
+        auto it = times.find(c);
+        if (it != times.end()) {
+            return it->second;
+        }
+        GeneratorParamValues params = params_of(c);
+        GeneratorParamValues all_params = fixed_params;
+        all_params.insert(params.begin(), params.end());
+        all_params["target"] = target.with_feature(Target::JIT).to_string();
+        double t = evaluate(generator_name, all_params, args, options);
+        if (Internal::debug::debug_level >= 1) {
+            std::ostringstream desc;
+            for (const auto &p : params) {
+                desc << " " << p.first << "=" << p.second;
+            }
+            Internal::debug(1) << "autotune:" << desc.str() << ": " << t * 1e3 << " ms\n";
+        }
+        times[c] = t;
+        return t;
+    };
+
+    std::mt19937 rng(options.seed);
+
+    Config current(space.size());
+    for (size_t i = 0; i < space.size(); i++) {
+        current[i] = (int)space[i].values.size() / 2;
+    }
+    double current_time = time_of(current);
+
+    while (times.size() < budget) {
+        // Move to the first neighbour that's faster.
+        bool moved = false;
+        for (size_t i = 0; i < space.size() && !moved && times.size() < budget; i++) {
+            for (int d : {-1, 1}) {
+                Config next = current;
+                next[i] += d;
+                if (next[i] < 0 || next[i] >= (int)space[i].values.size()) {
+                    continue;
+                }
+                double t = time_of(next);
+                if (t < current_time) {
+                    current = next;
+                    current_time = t;
+                    moved = true;
+                    break;
+                }
+                if (times.size() >= budget) {
+                    break;
+                }
+            }
+        }
+        if (moved || times.size() >= budget) {
+            continue;
+        }
+
+        // We're at a local minimum. Restart from a random
+        // configuration that hasn't been tried yet.
+        bool restarted = false;
+        for (int attempt = 0; attempt < 100 && !restarted; attempt++) {
+            Config c(space.size());
+            for (size_t i = 0; i < space.size(); i++) {
+                c[i] = std::uniform_int_distribution<int>(0, (int)space[i].values.size() - 1)(rng);
+            }
+            if (!times.count(c)) {
+                current = c;
+                current_time = time_of(c);
+                restarted = true;
+            }
+        }
+        if (!restarted) {
+            break;
+        }
+    }
+
+    auto best = times.begin();
+    for (auto it = times.begin(); it != times.end(); it++) {
+        if (it->second < best->second) {
+            best = it;
+        }
+    }
+    user_assert(best->second < std::numeric_limits<double>::infinity())
+        << "autotune: no configuration of " << generator_name << " ran successfully\n";
+
+    AutotuneResult result;
+    result.params = params_of(best->first);
+    result.time = best->second;
+    result.evaluations = (int)times.size();
+
+    if (!options.output_file.empty()) {
+        save_tuned_params(options.output_file, generator_name, target, result.params);
+    }
+    return result;
+}
+
+void save_tuned_params(const string &filename,
+                       const string &generator_name,
+                       const Target &target,
+                       const GeneratorParamValues &params) {
+    string target_string = target_key(target);
+
+    // Keep the entries for everything else.
+    vector<string> lines;
+    {
+        std::ifstream in(filename);
+        string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            string g, t;
+            fields >> g >> t;
+            if (g != generator_name || t != target_string) {
+                lines.push_back(line);
+            }
+        }
+    }
+
+    std::ostringstream entry;
+    entry << generator_name << " " << target_string;
+    for (const auto &p : params) {
+        user_assert(p.second.find_first_of(" \t\n") == string::npos)
+            << "Can't save the value of GeneratorParam " << p.first
+            << " because it contains whitespace: \"" << p.second << "\"\n";
+        entry << " " << p.first << "=" << p.second;
+    }
+    lines.push_back(entry.str());
+
+    std::ofstream out(filename);
+    user_assert(out.is_open()) << "Could not open " << filename << " for writing\n";
+    for (const string &line : lines) {
+        out << line << "\n";
+    }
+}
+
+bool load_tuned_params(const string &filename,
+                       const string &generator_name,
+                       const Target &target,
+                       GeneratorParamValues &params) {
+    std::ifstream in(filename);
+    user_assert(in.is_open()) << "Could not open " << filename << " for reading\n";
+
+    string target_string = target_key(target);
+    string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        string g, t;
+        fields >> g >> t;
+        if (g != generator_name || t != target_string) {
+            continue;
+        }
+        string param;
+        while (fields >> param) {
+            size_t eq = param.find('=');
+            user_assert(eq != string::npos && eq > 0)
+                << "Malformed entry \"" << param << "\" in " << filename << "\n";
+            params[param.substr(0, eq)] = param.substr(eq + 1);
+        }
+        return true;
+    }
+    return false;
+}
+
+}
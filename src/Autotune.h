@@ -0,0 +1,100 @@
+#ifndef HALIDE_AUTOTUNE_H
+#define HALIDE_AUTOTUNE_H
+
+/** \file
+ *
+ * Defines a simple autotuner for the GeneratorParams of a Generator,
+ * and a file format for handing the results to an AOT build.
+ */
+
+#include <string>
+#include <vector>
+
+#include "Generator.h"
+
+namespace Halide {
+
+/** A GeneratorParam to tune, and the values to try for it. Values are
+ * given in the same string form accepted on the generator command
+ * line. They should be ordered so that neighbouring values behave
+ * similarly (e.g. increasing tile sizes), as the search moves between
+ * neighbours. */
+struct TunableParam {
+    std::string name;
+    std::vector<std::string> values;
+};
+
+/** Controls for autotune(). Each candidate is timed as in
+ * test/performance/benchmark.h: the mean time of a run of
+ * 'iterations' calls, minimized over 'samples' runs. */
+struct AutotuneOptions {
+    /** The maximum number of distinct configurations to compile and
+     * time. */
+    int max_evaluations;
+
+    int samples, iterations;
+
+    /** The seed for the random restarts of the search. */
+    uint32_t seed;
+
+    /** If non-empty, the best configuration found is recorded in this
+     * file (see save_tuned_params). */
+    std::string output_file;
+
+    AutotuneOptions() : max_evaluations(50), samples(3), iterations(5), seed(0) {}
+};
+
+/** The best configuration found by autotune(). */
+struct AutotuneResult {
+    /** The values for the tuned GeneratorParams. */
+    Internal::GeneratorParamValues params;
+
+    /** The time taken by one call, in seconds. */
+    double time;
+
+    /** How many configurations were compiled and timed. */
+    int evaluations;
+};
+
+/** Search for the fastest values of some GeneratorParams of the
+ * registered Generator with the given name. Each candidate is built
+ * with the given fixed params (which must include a target), JIT
+ * compiled, and run on the given arguments.
+ *
+ * The arguments are passed as to the argv form of the generated
+ * function: a pointer to a buffer_t for each buffer argument, and a
+ * pointer to the value for each scalar argument, in the order of the
+ * Generator's filter arguments, followed by a buffer_t pointer for
+ * each output.
+ *
+ * The search is a hill climb, moving to the neighbouring value of
+ * one parameter at a time, with random restarts when no neighbour is
+ * faster. It starts from the middle value of each parameter.
+ * Configurations that fail to compile (when exceptions are enabled)
+ * or return an error when run are skipped. */
+EXPORT AutotuneResult autotune(const std::string &generator_name,
+                               const Internal::GeneratorParamValues &fixed_params,
+                               const std::vector<TunableParam> &space,
+                               const std::vector<const void *> &args,
+                               const AutotuneOptions &options = AutotuneOptions());
+
+/** Record tuned GeneratorParam values for a Generator and Target in a
+ * text file, replacing any previous entry for that pair. Each line of
+ * the file holds a generator name, a target string, and then
+ * name=value pairs, separated by spaces. */
+EXPORT void save_tuned_params(const std::string &filename,
+                              const std::string &generator_name,
+                              const Target &target,
+                              const Internal::GeneratorParamValues &params);
+
+/** Look up the tuned GeneratorParam values for a Generator and Target
+ * in a file written by save_tuned_params, and add them to
+ * params. Returns false if the file has no entry for that pair. */
+EXPORT bool load_tuned_params(const std::string &filename,
+                              const std::string &generator_name,
+                              const Target &target,
+                              Internal::GeneratorParamValues &params);
+
+}
+
+#endif
@@ -199,8 +199,8 @@ private:
     }
 
     void visit(const Variable *op) {
-        if (scope.contains(op->name)) {
-            interval = scope.get(op->name);
+        if (scope.contains(op->symbol())) {
+            interval = scope.get(op->symbol());
         } else if (op->type.is_vector()) {
             // Uh oh, we need to take the min/max lane of some unknown vector. Treat as unbounded.
             bounds_of_type(op->type);
@@ -711,9 +711,9 @@ private:
             }
         }
 
-        scope.push(op->name, var);
+        scope.push(op->symbol(), var);
         op->body.accept(this);
-        scope.pop(op->name);
+        scope.pop(op->symbol());
 
         if (interval.has_lower_bound()) {
             if (val.min.defined() && expr_uses_var(interval.min, min_name)) {
@@ -1046,17 +1046,17 @@ private:
 
         if (is_small_enough_to_substitute(value_bounds.min) &&
             (fixed || is_small_enough_to_substitute(value_bounds.max))) {
-            scope.push(op->name, value_bounds);
+            scope.push(op->symbol(), value_bounds);
             op->body.accept(this);
-            scope.pop(op->name);
+            scope.pop(op->symbol());
         } else {
             string max_name = unique_name('t');
             string min_name = unique_name('t');
 
-            scope.push(op->name, Interval(Variable::make(op->value.type(), min_name),
+            scope.push(op->symbol(), Interval(Variable::make(op->value.type(), min_name),
                                           Variable::make(op->value.type(), max_name)));
             op->body.accept(this);
-            scope.pop(op->name);
+            scope.pop(op->symbol());
 
             for (pair<const string, Box> &i : boxes) {
                 Box &box = i.second;
@@ -1266,9 +1266,9 @@ private:
             max_val -= 1;
         }
 
-        scope.push(op->name, Interval(min_val, max_val));
+        scope.push(op->symbol(), Interval(min_val, max_val));
         op->body.accept(this);
-        scope.pop(op->name);
+        scope.pop(op->symbol());
     }
 
     void visit(const Provide *op) {
@@ -106,8 +106,8 @@ public:
 
         // If e is a var, check if it has been redirected to an existing numbering.
         if (const Variable *var = e.as<Variable>()) {
-            if (let_substitutions.contains(var->name)) {
-                number = let_substitutions.get(var->name);
+            if (let_substitutions.contains(var->symbol())) {
+                number = let_substitutions.get(var->symbol());
                 internal_assert(entries[number].expr.type() == e.type());
                 return entries[number].expr;
             }
@@ -159,6 +159,181 @@ const string globals =
     " b->stride[3] = stride3;\n"
     " return true;\n"
     "}\n";
+
+// Emitted ahead of any function that uses vector types. Vector types
+// become halide_vector<T, N>, which wraps a GCC/Clang vector extension
+// type where possible. Building the output with
+// -DHALIDE_C_VECTOR_EXTENSIONS=0 forces the portable fallback.
+const string vector_types =
+    "#ifndef HALIDE_C_VECTOR_EXTENSIONS\n"
+    "#if defined(__GNUC__) || defined(__clang__)\n"
+    "#define HALIDE_C_VECTOR_EXTENSIONS 1\n"
+    "#else\n"
+    "#define HALIDE_C_VECTOR_EXTENSIONS 0\n"
+    "#endif\n"
+    "#endif\n"
+    "#ifndef __has_builtin\n"
+    "#define __has_builtin(x) 0\n"
+    "#endif\n"
+    "#if defined(__GNUC__) && !defined(__clang__)\n"
+    "#pragma GCC diagnostic ignored \"-Wpsabi\"\n"
+    "#endif\n"
+    // The functions here may be emitted inside an extern "C" block.
+    "extern \"C++\" {\n"
+    "template<int bytes> struct halide_mask_element;\n"
+    "template<> struct halide_mask_element<1> {typedef int8_t type;};\n"
+    "template<> struct halide_mask_element<2> {typedef int16_t type;};\n"
+    "template<> struct halide_mask_element<4> {typedef int32_t type;};\n"
+    "template<> struct halide_mask_element<8> {typedef int64_t type;};\n"
+    "\n"
+    // Vectors of N lanes of type T. Comparisons return masks, which are
+    // vectors of signed integers of the same width as T with all bits set
+    // in the true lanes. Vector extensions only support power-of-two
+    // lane counts; other widths, and compilers without vector extensions,
+    // get a plain array operated on one lane at a time.
+    "template<typename T, int N, bool native = HALIDE_C_VECTOR_EXTENSIONS && ((N & (N - 1)) == 0)>\n"
+    "struct halide_vector;\n"
+    "\n"
+    "#define HALIDE_VECTOR_COMMON_MEMBERS \\\n"
+    "    typedef halide_vector<typename halide_mask_element<sizeof(T)>::type, N> mask; \\\n"
+    "    T operator[](int i) const {return v[i];} \\\n"
+    "    void set(int i, T x) {v[i] = x;} \\\n"
+    "    static halide_vector broadcast(T x) { \\\n"
+    "        halide_vector r; \\\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = x; \\\n"
+    "        return r; \\\n"
+    "    } \\\n"
+    "    static halide_vector ramp(T base, T stride) { \\\n"
+    "        halide_vector r; \\\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = (T)(base + (T)i * stride); \\\n"
+    "        return r; \\\n"
+    "    } \\\n"
+    "    static halide_vector load(const void *base, int32_t index) { \\\n"
+    "        halide_vector r; \\\n"
+    "        memcpy(&r.v, (const T *)base + index, sizeof(T) * N); \\\n"
+    "        return r; \\\n"
+    "    } \\\n"
+    "    template<typename I> \\\n"
+    "    static halide_vector gather(const void *base, const I &index) { \\\n"
+    "        halide_vector r; \\\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = ((const T *)base)[index[i]]; \\\n"
+    "        return r; \\\n"
+    "    } \\\n"
+    "    void store(void *base, int32_t index) const { \\\n"
+    "        memcpy((T *)base + index, &v, sizeof(T) * N); \\\n"
+    "    } \\\n"
+    "    template<typename I> \\\n"
+    "    void scatter(void *base, const I &index) const { \\\n"
+    "        for (int i = 0; i < N; i++) ((T *)base)[index[i]] = v[i]; \\\n"
+    "    } \\\n"
+    "    template<typename S, bool SV> \\\n"
+    "    static halide_vector convert(const halide_vector<S, N, SV> &src) { \\\n"
+    "        halide_vector r; \\\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = (T)src[i]; \\\n"
+    "        return r; \\\n"
+    "    }\n"
+    "\n"
+    "#define HALIDE_VECTOR_NATIVE_BINOP(op) \\\n"
+    "    friend halide_vector operator op(const halide_vector &a, const halide_vector &b) { \\\n"
+    "        halide_vector r; \\\n"
+    "        r.v = a.v op b.v; \\\n"
+    "        return r; \\\n"
+    "    }\n"
+    "#define HALIDE_VECTOR_NATIVE_CMP(op) \\\n"
+    "    friend mask operator op(const halide_vector &a, const halide_vector &b) { \\\n"
+    "        mask r; \\\n"
+    "        r.v = (typename mask::native_type)(a.v op b.v); \\\n"
+    "        return r; \\\n"
+    "    }\n"
+    "#define HALIDE_VECTOR_LOOP_BINOP(op) \\\n"
+    "    friend halide_vector operator op(const halide_vector &a, const halide_vector &b) { \\\n"
+    "        halide_vector r; \\\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = a.v[i] op b.v[i]; \\\n"
+    "        return r; \\\n"
+    "    }\n"
+    "#define HALIDE_VECTOR_LOOP_CMP(op) \\\n"
+    "    friend mask operator op(const halide_vector &a, const halide_vector &b) { \\\n"
+    "        mask r; \\\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = a.v[i] op b.v[i] ? -1 : 0; \\\n"
+    "        return r; \\\n"
+    "    }\n"
+    "#define HALIDE_VECTOR_OPERATORS(BINOP, CMP) \\\n"
+    "    BINOP(+) BINOP(-) BINOP(*) BINOP(/) BINOP(%) \\\n"
+    "    BINOP(&) BINOP(|) BINOP(^) BINOP(<<) BINOP(>>) \\\n"
+    "    CMP(==) CMP(!=) CMP(<) CMP(<=) CMP(>) CMP(>=)\n"
+    "\n"
+    "template<typename T, int N>\n"
+    "struct halide_vector<T, N, false> {\n"
+    "    T v[N];\n"
+    "    HALIDE_VECTOR_COMMON_MEMBERS\n"
+    "    HALIDE_VECTOR_OPERATORS(HALIDE_VECTOR_LOOP_BINOP, HALIDE_VECTOR_LOOP_CMP)\n"
+    "    friend halide_vector operator~(const halide_vector &a) {\n"
+    "        halide_vector r;\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = ~a.v[i];\n"
+    "        return r;\n"
+    "    }\n"
+    "    static halide_vector blend(const mask &m, const halide_vector &a, const halide_vector &b) {\n"
+    "        halide_vector r;\n"
+    "        for (int i = 0; i < N; i++) r.v[i] = m[i] ? a.v[i] : b.v[i];\n"
+    "        return r;\n"
+    "    }\n"
+    "};\n"
+    "\n"
+    "template<typename T, int N>\n"
+    "struct halide_vector<T, N, true> {\n"
+    "    typedef T native_type __attribute__((vector_size(N * sizeof(T))));\n"
+    "    native_type v;\n"
+    "    HALIDE_VECTOR_COMMON_MEMBERS\n"
+    "    HALIDE_VECTOR_OPERATORS(HALIDE_VECTOR_NATIVE_BINOP, HALIDE_VECTOR_NATIVE_CMP)\n"
+    "    friend halide_vector operator~(const halide_vector &a) {\n"
+    "        halide_vector r;\n"
+    "        r.v = ~a.v;\n"
+    "        return r;\n"
+    "    }\n"
+    "#if __has_builtin(__builtin_convertvector)\n"
+    "    template<typename S>\n"
+    "    static halide_vector convert(const halide_vector<S, N, true> &src) {\n"
+    "        halide_vector r;\n"
+    "        r.v = __builtin_convertvector(src.v, native_type);\n"
+    "        return r;\n"
+    "    }\n"
+    "#endif\n"
+    "    static halide_vector blend(const mask &m, const halide_vector &a, const halide_vector &b) {\n"
+    "        typedef typename mask::native_type M;\n"
+    "        halide_vector r;\n"
+    "        r.v = (native_type)((m.v & (M)a.v) | (~m.v & (M)b.v));\n"
+    "        return r;\n"
+    "    }\n"
+    "};\n"
+    "\n"
+    // Masks of different widths get combined by first converting the
+    // second one to the width of the first.
+    "#define HALIDE_MASK_MIXED_OP(op) \\\n"
+    "    template<typename A, typename B, int N, bool AV, bool BV> \\\n"
+    "    halide_vector<A, N, AV> operator op(const halide_vector<A, N, AV> &a, const halide_vector<B, N, BV> &b) { \\\n"
+    "        return a op halide_vector<A, N, AV>::convert(b); \\\n"
+    "    }\n"
+    "HALIDE_MASK_MIXED_OP(&)\n"
+    "HALIDE_MASK_MIXED_OP(|)\n"
+    "HALIDE_MASK_MIXED_OP(^)\n"
+    "\n"
+    "template<typename M, typename T, int N, bool V>\n"
+    "halide_vector<T, N, V> halide_select(const M &m, const halide_vector<T, N, V> &a, const halide_vector<T, N, V> &b) {\n"
+    "    typedef typename halide_vector<T, N, V>::mask mask;\n"
+    "    return halide_vector<T, N, V>::blend(mask::convert(m), a, b);\n"
+    "}\n"
+    "template<typename T, int N, bool V>\n"
+    "halide_vector<T, N, V> max(const halide_vector<T, N, V> &a, const halide_vector<T, N, V> &b) {\n"
+    "    return halide_vector<T, N, V>::blend(a > b, a, b);\n"
+    "}\n"
+    "template<typename T, int N, bool V>\n"
+    "halide_vector<T, N, V> min(const halide_vector<T, N, V> &a, const halide_vector<T, N, V> &b) {\n"
+    "    return halide_vector<T, N, V>::blend(a < b, a, b);\n"
+    "}\n"
+    "template<typename T> T halide_lane(T x, int) {return x;}\n"
+    "template<typename T, int N, bool V> T halide_lane(const halide_vector<T, N, V> &x, int i) {return x[i];}\n"
+    "}  // extern \"C++\"\n";
+
 }
 
 CodeGen_C::CodeGen_C(ostream &s, OutputKind output_kind, const std::string &guard) : IRPrinter(s), id("$$ BAD ID $$"), output_kind(output_kind) {
@@ -213,8 +388,17 @@ namespace {
 string type_to_c_type(Type type, bool include_space, bool c_plus_plus = true) {
     bool needs_space = true;
     ostringstream oss;
-    user_assert(type.lanes() == 1) << "Can't use vector types when compiling to C (yet)\n";
-    if (type.is_float()) {
+    if (type.is_vector()) {
+        user_assert(!type.is_handle()) << "Can't use vectors of handles when compiling to C\n";
+        if (type.is_bool()) {
+            // The lane width of a mask depends on the types that were
+            // compared to make it, so leave it to the C++ compiler.
+            oss << "auto";
+        } else {
+            oss << "halide_vector<" << type_to_c_type(type.element_of(), false, c_plus_plus)
+                << ", " << type.lanes() << ">";
+        }
+    } else if (type.is_float()) {
         if (type.bits() == 32) {
             oss << "float";
         } else if (type.bits() == 64) {
@@ -367,7 +551,7 @@ class ExternCallPrototypes : public IRGraphVisitor {
             }
 
             if (!emitted.count(name)) {
-                stream << type_to_c_type(op->type, true) << " " << name << "(";
+                stream << type_to_c_type(op->type.element_of(), true) << " " << name << "(";
                 if (function_takes_user_context(name)) {
                     stream << "void *";
                     if (op->args.size()) {
@@ -381,7 +565,7 @@ class ExternCallPrototypes : public IRGraphVisitor {
                     if (op->args[i].as<StringImm>()) {
                         stream << "const char *";
                     } else {
-                      stream << type_to_c_type(op->args[i].type(), true);
+                      stream << type_to_c_type(op->args[i].type().element_of(), true);
                     }
                 }
                 stream << ");";
@@ -424,7 +608,36 @@ public:
 };
 }
 
+namespace {
+// Check if any vector types are used, so we know whether to emit
+// the vector type definitions. Every vector starts life as a Ramp
+// or a Broadcast.
+class UsesVectors : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Ramp *op) {
+        result = true;
+    }
+
+    void visit(const Broadcast *op) {
+        result = true;
+    }
+
+public:
+    bool result = false;
+};
+}
+
 void CodeGen_C::compile(const Module &input) {
+    if (!is_header()) {
+        UsesVectors uses_vectors;
+        for (const auto &f : input.functions()) {
+            f.body.accept(&uses_vectors);
+        }
+        if (uses_vectors.result) {
+            stream << vector_types;
+        }
+    }
     for (const auto &b : input.buffers()) {
         compile(b);
     }
@@ -743,7 +956,19 @@ void CodeGen_C::visit(const Variable *op) {
 }
 
 void CodeGen_C::visit(const Cast *op) {
-    print_assignment(op->type, "(" + print_type(op->type) + ")(" + print_expr(op->value) + ")");
+    if (op->type.is_vector()) {
+        Type t = op->type;
+        if (op->value.type().is_bool()) {
+            // Masks have all bits set in the true lanes.
+            print_expr(select(op->value, make_one(t), make_zero(t)));
+        } else if (t.is_bool()) {
+            print_expr(op->value != make_zero(op->value.type()));
+        } else {
+            print_assignment(t, print_type(t) + "::convert(" + print_expr(op->value) + ")");
+        }
+    } else {
+        print_assignment(op->type, "(" + print_type(op->type) + ")(" + print_expr(op->value) + ")");
+    }
 }
 
 void CodeGen_C::visit_binop(Type t, Expr a, Expr b, const char * op) {
@@ -766,7 +991,9 @@ void CodeGen_C::visit(const Mul *op) {
 
 void CodeGen_C::visit(const Div *op) {
     int bits;
-    if (is_const_power_of_two_integer(op->b, &bits)) {
+    if (op->type.is_vector() && is_const_power_of_two_integer(op->b, &bits)) {
+        print_expr(Call::make(op->type, Call::shift_right, {op->a, make_const(op->type, bits)}, Call::PureIntrinsic));
+    } else if (is_const_power_of_two_integer(op->b, &bits)) {
         ostringstream oss;
         oss << print_expr(op->a) << " >> " << bits;
         print_assignment(op->type, oss.str());
@@ -779,7 +1006,9 @@ void CodeGen_C::visit(const Div *op) {
 
 void CodeGen_C::visit(const Mod *op) {
     int bits;
-    if (is_const_power_of_two_integer(op->b, &bits)) {
+    if (op->type.is_vector() && is_const_power_of_two_integer(op->b, &bits)) {
+        print_expr(Call::make(op->type, Call::bitwise_and, {op->a, make_const(op->type, (1 << bits) - 1)}, Call::PureIntrinsic));
+    } else if (is_const_power_of_two_integer(op->b, &bits)) {
         ostringstream oss;
         oss << print_expr(op->a) << " & " << ((1 << bits)-1);
         print_assignment(op->type, oss.str());
@@ -791,19 +1020,43 @@ void CodeGen_C::visit(const Mod *op) {
 }
 
 void CodeGen_C::visit(const Max *op) {
-    print_expr(Call::make(op->type, "max", {op->a, op->b}, Call::Extern));
+    if (op->type.is_vector()) {
+        // Don't scalarize these like other extern calls.
+        string a = print_expr(op->a);
+        string b = print_expr(op->b);
+        print_assignment(op->type, "max(" + a + ", " + b + ")");
+    } else {
+        print_expr(Call::make(op->type, "max", {op->a, op->b}, Call::Extern));
+    }
 }
 
 void CodeGen_C::visit(const Min *op) {
-    print_expr(Call::make(op->type, "min", {op->a, op->b}, Call::Extern));
+    if (op->type.is_vector()) {
+        string a = print_expr(op->a);
+        string b = print_expr(op->b);
+        print_assignment(op->type, "min(" + a + ", " + b + ")");
+    } else {
+        print_expr(Call::make(op->type, "min", {op->a, op->b}, Call::Extern));
+    }
 }
 
 void CodeGen_C::visit(const EQ *op) {
-    visit_binop(op->type, op->a, op->b, "==");
+    if (op->type.is_vector() && op->a.type().is_bool()) {
+        // The masks being compared may have different lane widths.
+        string a = print_expr(op->a);
+        string b = print_expr(op->b);
+        print_assignment(op->type, "~(" + a + " ^ " + b + ")");
+    } else {
+        visit_binop(op->type, op->a, op->b, "==");
+    }
 }
 
 void CodeGen_C::visit(const NE *op) {
-    visit_binop(op->type, op->a, op->b, "!=");
+    if (op->type.is_vector() && op->a.type().is_bool()) {
+        visit_binop(op->type, op->a, op->b, "^");
+    } else {
+        visit_binop(op->type, op->a, op->b, "!=");
+    }
 }
 
 void CodeGen_C::visit(const LT *op) {
@@ -823,15 +1076,35 @@ void CodeGen_C::visit(const GE *op) {
 }
 
 void CodeGen_C::visit(const Or *op) {
-    visit_binop(op->type, op->a, op->b, "||");
+    visit_binop(op->type, op->a, op->b, op->type.is_vector() ? "|" : "||");
 }
 
 void CodeGen_C::visit(const And *op) {
-    visit_binop(op->type, op->a, op->b, "&&");
+    visit_binop(op->type, op->a, op->b, op->type.is_vector() ? "&" : "&&");
 }
 
 void CodeGen_C::visit(const Not *op) {
-    print_assignment(op->type, "!(" + print_expr(op->a) + ")");
+    if (op->type.is_vector()) {
+        print_assignment(op->type, "~" + print_expr(op->a));
+    } else {
+        print_assignment(op->type, "!(" + print_expr(op->a) + ")");
+    }
+}
+
+void CodeGen_C::visit(const Ramp *op) {
+    string base = print_expr(op->base);
+    string stride = print_expr(op->stride);
+    print_assignment(op->type, print_type(op->type) + "::ramp(" + base + ", " + stride + ")");
+}
+
+void CodeGen_C::visit(const Broadcast *op) {
+    string value = print_expr(op->value);
+    if (op->type.is_bool()) {
+        Type mask = Int(8, op->lanes);
+        print_assignment(op->type, print_type(mask) + "::broadcast(" + value + " ? -1 : 0)");
+    } else {
+        print_assignment(op->type, print_type(op->type) + "::broadcast(" + value + ")");
+    }
 }
 
 void CodeGen_C::visit(const IntImm *op) {
@@ -901,7 +1174,13 @@ void CodeGen_C::visit(const Call *op) {
     ostringstream rhs;
 
     // Handle intrinsics first
-    if (op->is_intrinsic(Call::debug_to_file)) {
+    if (op->is_intrinsic(Call::shuffle_vector) ||
+        op->is_intrinsic(Call::slice_vector) ||
+        op->is_intrinsic(Call::interleave_vectors) ||
+        op->is_intrinsic(Call::concat_vectors)) {
+        print_shuffle(op);
+        return;
+    } else if (op->is_intrinsic(Call::debug_to_file)) {
         internal_assert(op->args.size() == 3);
         const StringImm *string_imm = op->args[0].as<StringImm>();
         internal_assert(string_imm);
@@ -1192,6 +1471,9 @@ void CodeGen_C::visit(const Call *op) {
         // TODO: other intrinsics
         internal_error << "Unhandled intrinsic in C backend: " << op->name << '\n';
 
+    } else if (op->type.is_vector()) {
+        print_scalarized_call(op);
+        return;
     } else {
         std::string name;
         if (op->call_type == Call::ExternCPlusPlus) {
@@ -1225,31 +1507,64 @@ void CodeGen_C::visit(const Call *op) {
 void CodeGen_C::visit(const Load *op) {
 
     Type t = op->type;
+
+    if (t.is_vector() && t.is_bool()) {
+        // Bools are stored as bytes. Load those and turn them into a mask.
+        Expr bytes = Load::make(UInt(8, t.lanes()), op->name, op->index, op->image, op->param);
+        print_expr(bytes != make_zero(bytes.type()));
+        return;
+    }
+
     bool type_cast_needed =
         !allocations.contains(op->name) ||
-        allocations.get(op->name).type != t;
+        allocations.get(op->name).type != t.element_of();
 
     ostringstream rhs;
     if (type_cast_needed) {
         rhs << "(("
-            << print_type(op->type)
+            << print_type(t.element_of())
             << " *)"
             << print_name(op->name)
             << ")";
     } else {
         rhs << print_name(op->name);
     }
-    rhs << "["
-        << print_expr(op->index)
-        << "]";
 
-    print_assignment(op->type, rhs.str());
+    if (t.is_scalar()) {
+        rhs << "["
+            << print_expr(op->index)
+            << "]";
+        print_assignment(t, rhs.str());
+        return;
+    }
+
+    const Ramp *ramp = op->index.as<Ramp>();
+    const Broadcast *broadcast = op->index.as<Broadcast>();
+    if (ramp && is_one(ramp->stride)) {
+        // A dense vector load.
+        string base = print_expr(ramp->base);
+        print_assignment(t, print_type(t) + "::load(" + rhs.str() + ", " + base + ")");
+    } else if (broadcast) {
+        // Load a single value and broadcast it.
+        string index = print_expr(broadcast->value);
+        string value = print_assignment(t.element_of(), rhs.str() + "[" + index + "]");
+        print_assignment(t, print_type(t) + "::broadcast(" + value + ")");
+    } else {
+        // Load one lane at a time.
+        string index = print_expr(op->index);
+        print_assignment(t, print_type(t) + "::gather(" + rhs.str() + ", " + index + ")");
+    }
 }
 
 void CodeGen_C::visit(const Store *op) {
 
     Type t = op->value.type();
 
+    if (t.is_vector()) {
+        print_vector_store(op);
+        return;
+    }
+
     bool type_cast_needed =
         t.is_handle() ||
         !allocations.contains(op->name) ||
@@ -1277,6 +1592,171 @@ void CodeGen_C::visit(const Store *op) {
     cache.clear();
 }
 
+void CodeGen_C::print_vector_store(const Store *op) {
+    Type t = op->value.type();
+
+    if (t.is_bool()) {
+        // Bools are stored as bytes.
+        Type bytes = UInt(8, t.lanes());
+        Expr value = select(op->value, make_one(bytes), make_zero(bytes));
+        print_stmt(Store::make(op->name, value, op->index, op->param));
+        return;
+    }
+
+    bool type_cast_needed =
+        !allocations.contains(op->name) ||
+        allocations.get(op->name).type != t.element_of();
+
+    string dest = print_name(op->name);
+    if (type_cast_needed) {
+        dest = "((" + print_type(t.element_of()) + " *)" + dest + ")";
+    }
+
+    string id_value = print_expr(op->value);
+    const Ramp *ramp = op->index.as<Ramp>();
+    if (ramp && is_one(ramp->stride)) {
+        // A dense vector store.
+        string base = print_expr(ramp->base);
+        do_indent();
+        stream << id_value << ".store(" << dest << ", " << base << ");\n";
+    } else {
+        // Store one lane at a time.
+        string index = print_expr(op->index);
+        do_indent();
+        stream << id_value << ".scatter(" << dest << ", " << index << ");\n";
+    }
+
+    cache.clear();
+}
+
+void CodeGen_C::print_shuffle(const Call *op) {
+    // Work out which lane of which argument each lane of the result
+    // comes from.
+    vector<Expr> vecs;
+    vector<std::pair<int, int>> lanes;
+    if (op->is_intrinsic(Call::shuffle_vector)) {
+        internal_assert((int)op->args.size() == 1 + op->type.lanes());
+        vecs.push_back(op->args[0]);
+        for (size_t i = 1; i < op->args.size(); i++) {
+            const int64_t *idx = as_const_int(op->args[i]);
+            internal_assert(idx);
+            lanes.push_back({0, (int)*idx});
+        }
+    } else if (op->is_intrinsic(Call::slice_vector)) {
+        internal_assert(op->args.size() == 4);
+        const int64_t *start = as_const_int(op->args[1]);
+        const int64_t *stride = as_const_int(op->args[2]);
+        internal_assert(start && stride) << "argument to slice_vector must be a constant.\n";
+        vecs.push_back(op->args[0]);
+        for (int i = 0; i < op->type.lanes(); i++) {
+            lanes.push_back({0, (int)(*start + *stride * i)});
+        }
+    } else if (op->is_intrinsic(Call::interleave_vectors)) {
+        vecs = op->args;
+        int n = (int)vecs.size();
+        for (int i = 0; i < op->type.lanes(); i++) {
+            lanes.push_back({i % n, i / n});
+        }
+    } else {
+        internal_assert(op->is_intrinsic(Call::concat_vectors));
+        vecs = op->args;
+        for (int i = 0; i < (int)vecs.size(); i++) {
+            for (int j = 0; j < vecs[i].type().lanes(); j++) {
+                lanes.push_back({i, j});
+            }
+        }
+    }
+    internal_assert((int)lanes.size() == op->type.lanes());
+
+    // Masks of any width get shuffled as bytes.
+    vector<string> ids;
+    for (Expr v : vecs) {
+        string v_id = print_expr(v);
+        if (op->type.is_bool()) {
+            if (v.type().is_vector()) {
+                v_id = print_assignment(v.type(), print_type(Int(8, v.type().lanes())) + "::convert(" + v_id + ")");
+            } else {
+                v_id = "(" + v_id + " ? -1 : 0)";
+            }
+        }
+        ids.push_back(v_id);
+    }
+
+    vector<string> lane_values;
+    for (const auto &l : lanes) {
+        if (vecs[l.first].type().is_vector()) {
+            lane_values.push_back(ids[l.first] + "[" + std::to_string(l.second) + "]");
+        } else {
+            lane_values.push_back(ids[l.first]);
+        }
+    }
+
+    if (op->type.is_scalar()) {
+        if (op->type.is_bool()) {
+            print_assignment(op->type, lane_values[0] + " != 0");
+        } else {
+            print_assignment(op->type, lane_values[0]);
+        }
+        return;
+    }
+
+    Type result_type = op->type.is_bool() ? Int(8, op->type.lanes()) : op->type;
+    string result_id = unique_name('_');
+    do_indent();
+    stream << print_type(result_type, AppendSpace) << result_id << ";\n";
+    for (size_t i = 0; i < lane_values.size(); i++) {
+        do_indent();
+        stream << result_id << ".set(" << i << ", " << lane_values[i] << ");\n";
+    }
+    id = result_id;
+}
+
+void CodeGen_C::print_scalarized_call(const Call *op) {
+    std::string name;
+    if (op->call_type == Call::ExternCPlusPlus) {
+        std::vector<std::string> namespaces;
+        name = extract_namespaces(op->name, namespaces);
+    } else {
+        name = op->name;
+    }
+
+    vector<string> args(op->args.size());
+    for (size_t i = 0; i < op->args.size(); i++) {
+        args[i] = print_expr(op->args[i]);
+    }
+
+    string lane = unique_name('i');
+    ostringstream call;
+    call << name << "(";
+    if (function_takes_user_context(op->name)) {
+        call << (have_user_context ? "__user_context_, " : "nullptr, ");
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        if (i > 0) call << ", ";
+        if (op->args[i].type().is_vector()) {
+            call << "halide_lane(" << args[i] << ", " << lane << ")";
+        } else {
+            call << args[i];
+        }
+    }
+    call << ")";
+
+    Type result_type = op->type;
+    string value = call.str();
+    if (op->type.is_bool()) {
+        result_type = Int(8, op->type.lanes());
+        value = "(" + value + " ? -1 : 0)";
+    }
+
+    string result_id = unique_name('_');
+    do_indent();
+    stream << print_type(result_type, AppendSpace) << result_id << ";\n";
+    do_indent();
+    stream << "for (int " << lane << " = 0; " << lane << " < " << op->type.lanes() << "; " << lane << "++) "
+           << result_id << ".set(" << lane << ", " << value << ");\n";
+    id = result_id;
+}
+
 void CodeGen_C::visit(const Let *op) {
     string id_value = print_expr(op->value);
     Expr new_var = Variable::make(op->value.type(), id_value);
@@ -1285,6 +1765,23 @@ void CodeGen_C::visit(const Let *op) {
 }
 
 void CodeGen_C::visit(const Select *op) {
+    if (op->type.is_vector()) {
+        Expr cond = op->condition;
+        if (cond.type().is_scalar()) {
+            cond = Broadcast::make(cond, op->type.lanes());
+        }
+        if (op->type.is_bool()) {
+            // A select between masks is some bitwise arithmetic.
+            print_expr((cond && op->true_value) || (!cond && op->false_value));
+        } else {
+            string true_val = print_expr(op->true_value);
+            string false_val = print_expr(op->false_value);
+            string c = print_expr(cond);
+            print_assignment(op->type, "halide_select(" + c + ", " + true_val + ", " + false_val + ")");
+        }
+        return;
+    }
+
     ostringstream rhs;
     string true_val = print_expr(op->true_value);
     string false_val = print_expr(op->false_value);
@@ -151,6 +151,8 @@ protected:
     void visit(const And *);
     void visit(const Or *);
     void visit(const Not *);
+    void visit(const Ramp *);
+    void visit(const Broadcast *);
     void visit(const Call *);
     void visit(const Select *);
     void visit(const Load *);
@@ -168,6 +170,18 @@ protected:
     void visit(const Evaluate *);
 
     void visit_binop(Type t, Expr a, Expr b, const char *op);
+
+    /** Emit a store of a vector value. Dense stores become a single
+     * memcpy, anything else is stored one lane at a time. */
+    void print_vector_store(const Store *op);
+
+    /** Emit one of the vector shuffling intrinsics as a lane-by-lane
+     * copy. */
+    void print_shuffle(const Call *op);
+
+    /** Emit a call to an extern function on vector arguments as a
+     * loop over the lanes. */
+    void print_scalarized_call(const Call *op);
 };
 
 }
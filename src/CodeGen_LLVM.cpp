@@ -982,11 +982,15 @@ void CodeGen_LLVM::optimize_module() {
     function_pass_manager.add(createTargetTransformInfoWrapperPass(TM ? TM->getTargetIRAnalysis() : TargetIRAnalysis()));
     #endif
 
+    // The first tier of a tiered JIT compile trades the speed of the
+    // generated code for compile time.
+    bool quick = target.has_feature(Target::JIT) && target.has_feature(Target::TieredJIT);
+
     PassManagerBuilder b;
-    b.OptLevel = 3;
+    b.OptLevel = quick ? 1 : 3;
     b.Inliner = createFunctionInliningPass(b.OptLevel, 0);
-    b.LoopVectorize = true;
-    b.SLPVectorize = true;
+    b.LoopVectorize = !quick;
+    b.SLPVectorize = !quick;
     b.populateFunctionPassManager(function_pass_manager);
     b.populateModulePassManager(module_pass_manager);
 
@@ -1847,6 +1851,35 @@ void CodeGen_LLVM::visit(const Load *op) {
             }
 
             value = shuffle_vectors(vec_a, vec_b, indices);
+        } else if (ramp && stride && (stride->value == 3 || stride->value == 4) &&
+                   ramp->lanes >= stride->value) {
+            // One channel of interleaved RGB or RGBA data. Rather
+            // than gathering, do one dense load per channel
+            // covering the span of the ramp, and then pick out every
+            // stride-th element with a shuffle. The last load is
+            // shifted back so that it ends at the last element
+            // needed, so we never read past the end of the buffer.
+            const int s = (int)stride->value;
+            const int lanes = ramp->lanes;
+            const int span = (lanes - 1) * s + 1;
+            vector<int> starts(s);
+            vector<Value *> vecs;
+            for (int k = 0; k < s; k++) {
+                starts[k] = (k == s - 1) ? span - lanes : k * lanes;
+                Expr base_k = simplify(ramp->base + starts[k]);
+                Expr ramp_k = Ramp::make(base_k, make_one(base_k.type()), lanes);
+                Expr load_k = Load::make(op->type, op->name, ramp_k, op->image, op->param);
+                vecs.push_back(codegen(load_k));
+            }
+
+            vector<int> indices(lanes);
+            for (int i = 0; i < lanes; i++) {
+                int offset = i * s;
+                int k = std::min(offset / lanes, s - 1);
+                indices[i] = k * lanes + offset - starts[k];
+            }
+
+            value = shuffle_vectors(concat_vectors(vecs), indices);
         } else if (ramp && stride && stride->value == -1) {
             // Load the vector and then flip it in-place
             Expr flipped_base = ramp->base - ramp->lanes + 1;
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cmath>
 
 #include "CodeGen_X86.h"
 #include "ConciseCasts.h"
@@ -64,6 +65,55 @@ bool should_use_pmaddwd(Expr a, Expr b, vector<Expr> &result) {
     return true;
 }
 
+// Convert half-precision floats to single precision with integer
+// operations, for targets without F16C. Shifting the exponent and
+// mantissa into place and multiplying by 2^112 rebiases the exponent,
+// and also handles denormals. Infinities and NaNs keep an all-ones
+// exponent. The result goes straight to codegen, without the
+// simplifier, so the constants must have the same number of lanes.
+Expr float16_to_float32(Expr e) {
+    Type u32_t = UInt(32, e.type().lanes());
+    Type f32_t = Float(32, e.type().lanes());
+    Expr bits = cast(u32_t, reinterpret(UInt(16, e.type().lanes()), e));
+    Expr sign = (bits & make_const(u32_t, 0x8000)) << 16;
+    Expr magnitude = (bits & make_const(u32_t, 0x7fff)) << 13;
+    Expr finite = reinterpret(f32_t, magnitude) * make_const(f32_t, std::ldexp(1.0, 112));
+    Expr non_finite = reinterpret(f32_t, magnitude | make_const(u32_t, 0x7f800000));
+    Expr result = select(magnitude >= make_const(u32_t, 0x7c00 << 13), non_finite, finite);
+    return reinterpret(f32_t, reinterpret(u32_t, result) | sign);
+}
+
+// Convert single-precision floats to half precision with integer
+// operations, rounding to nearest with ties to even, for targets
+// without F16C. Values too small to be normal half floats are
+// rounded by a float addition, which aligns the mantissa so that the
+// hardware does the rounding.
+Expr float32_to_float16(Expr e) {
+    Type u32_t = UInt(32, e.type().lanes());
+    Type f32_t = Float(32, e.type().lanes());
+    Expr bits = reinterpret(u32_t, e);
+    Expr sign = (bits & make_const(u32_t, 0x80000000u)) >> 16;
+    Expr magnitude = bits & make_const(u32_t, 0x7fffffff);
+
+    // Too large for a half float: infinity, or a quiet NaN.
+    Expr overflow = select(magnitude > make_const(u32_t, 0x7f800000),
+                           make_const(u32_t, 0x7e00), make_const(u32_t, 0x7c00));
+
+    // Denormal or zero. 0.5f has the exponent that puts the last bit
+    // of a half denormal in the last bit of the mantissa.
+    Expr denormal = reinterpret(u32_t, reinterpret(f32_t, magnitude) + make_const(f32_t, 0.5f));
+    denormal = denormal - make_const(u32_t, 0x3f000000);
+
+    // Normal. Rebias the exponent, and round the mantissa, with ties
+    // going to the even neighbour.
+    Expr odd = (magnitude >> 13) & make_const(u32_t, 1);
+    Expr normal = (magnitude + make_const(u32_t, 0xc8000fffu) + odd) >> 13;
+
+    Expr result = select(magnitude >= make_const(u32_t, 0x47800000), overflow,
+                         magnitude < make_const(u32_t, 0x38800000), denormal,
+                         normal);
+    return reinterpret(Float(16, e.type().lanes()), cast(UInt(16, e.type().lanes()), result | sign));
+}
 }
 
 
@@ -205,6 +255,47 @@ void CodeGen_X86::visit(const Select *op) {
 
 void CodeGen_X86::visit(const Cast *op) {
 
+    Type src = op->value.type();
+    if (src.is_float() && op->type.is_float() &&
+        (src.bits() == 16) != (op->type.bits() == 16)) {
+        // Conversions to and from half precision. LLVM scalarizes
+        // vector conversions, and without F16C it calls runtime
+        // functions that we don't provide, so we do them here. Double
+        // precision goes via single precision, which is exact when
+        // widening, and can round twice when narrowing.
+        const int lanes = op->type.lanes();
+        const bool f16c = target.has_feature(Target::F16C);
+        Expr e = op->value;
+        if (src.bits() == 64) {
+            e = cast(Float(32, lanes), e);
+        }
+        if (op->type.bits() == 16) {
+            if (f16c && op->type.is_vector()) {
+                // vcvtps2ph with rounding mode 0, which is to nearest
+                // with ties to even.
+                value = call_intrin(Int(16, lanes), 8, "llvm.x86.vcvtps2ph.256", {e, 0});
+                value = builder->CreateBitCast(value, llvm_type_of(op->type));
+            } else if (f16c) {
+                value = builder->CreateFPTrunc(codegen(e), llvm_type_of(op->type));
+            } else {
+                value = codegen(float32_to_float16(e));
+            }
+        } else {
+            if (f16c && op->type.is_vector()) {
+                value = builder->CreateBitCast(codegen(e), llvm_type_of(Int(16, lanes)));
+                value = call_intrin(llvm_type_of(Float(32, lanes)), 8, "llvm.x86.vcvtph2ps.256", {value});
+            } else if (f16c) {
+                value = builder->CreateFPExt(codegen(e), llvm_type_of(Float(32, lanes)));
+            } else {
+                value = codegen(float16_to_float32(e));
+            }
+            if (op->type.bits() == 64) {
+                value = builder->CreateFPExt(value, llvm_type_of(op->type));
+            }
+        }
+        return;
+    }
+
     if (!op->type.is_vector()) {
         // We only have peephole optimizations for vectors in here.
         CodeGen_Posix::visit(op);
@@ -0,0 +1,427 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "CostEstimate.h"
+#include "Bounds.h"
+#include "IRPrinter.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+void accumulate(Expr &total, Expr e) {
+    total = simplify(total.defined() ? total + e : e);
+}
+
+class EstimateCosts : public IRVisitor {
+public:
+    vector<StageCost> stages;
+
+    EstimateCosts() : trips(make_const(Int(64), 1)), in_parallel(false), in_index(false) {
+        current_stage = find_stage("(other)");
+    }
+
+private:
+    using IRVisitor::visit;
+
+    map<string, int> stage_index;
+    int current_stage;
+
+    // The bounds of the enclosing loop variables and lets, in terms
+    // of the free variables of the Stmt.
+    Scope<Interval> scope;
+
+    // The number of times the current node executes.
+    Expr trips;
+
+    bool in_parallel;
+
+    // Arithmetic in load and store indices is mostly folded into
+    // addressing modes or hoisted, so we don't count it.
+    bool in_index;
+
+    int find_stage(const string &name) {
+        auto it = stage_index.find(name);
+        if (it != stage_index.end()) {
+            return it->second;
+        }
+        StageCost s;
+        s.name = name;
+        stages.push_back(s);
+        stage_index[name] = (int)stages.size() - 1;
+        return (int)stages.size() - 1;
+    }
+
+    StageCost &stage() {
+        return stages[current_stage];
+    }
+
+    Expr upper_bound(Expr e) {
+        Interval i = bounds_of_expr_in_scope(e, scope);
+        return simplify(cast<int64_t>(i.has_upper_bound() ? i.max : e));
+    }
+
+    Expr bytes_of(Type t) {
+        return make_const(Int(64), t.bytes() * t.lanes());
+    }
+
+    void count_op(Type t) {
+        if (in_index) return;
+        std::ostringstream key;
+        key << t;
+        StageCost::OpCount &c = stage().ops[key.str()];
+        c.type = t;
+        accumulate(in_parallel ? c.parallel : c.serial, trips);
+    }
+
+    template<typename T>
+    void visit_op(const T *op) {
+        count_op(op->type);
+        IRVisitor::visit(op);
+    }
+
+    template<typename T>
+    void visit_cmp(const T *op) {
+        count_op(op->a.type());
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Add *op) {visit_op(op);}
+    void visit(const Sub *op) {visit_op(op);}
+    void visit(const Mul *op) {visit_op(op);}
+    void visit(const Div *op) {visit_op(op);}
+    void visit(const Mod *op) {visit_op(op);}
+    void visit(const Min *op) {visit_op(op);}
+    void visit(const Max *op) {visit_op(op);}
+    void visit(const And *op) {visit_op(op);}
+    void visit(const Or *op) {visit_op(op);}
+    void visit(const Not *op) {visit_op(op);}
+    void visit(const Cast *op) {visit_op(op);}
+    void visit(const Select *op) {visit_op(op);}
+    void visit(const EQ *op) {visit_cmp(op);}
+    void visit(const NE *op) {visit_cmp(op);}
+    void visit(const LT *op) {visit_cmp(op);}
+    void visit(const LE *op) {visit_cmp(op);}
+    void visit(const GT *op) {visit_cmp(op);}
+    void visit(const GE *op) {visit_cmp(op);}
+
+    void visit(const Call *op) {
+        if ((op->call_type == Call::PureExtern ||
+             op->call_type == Call::PureIntrinsic) &&
+            !op->is_intrinsic(Call::likely) &&
+            !op->is_intrinsic(Call::likely_if_innermost) &&
+            !op->is_intrinsic(Call::reinterpret)) {
+            count_op(op->type);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Load *op) {
+        accumulate(stage().bytes_loaded[op->name], trips * bytes_of(op->type));
+        bool old_in_index = in_index;
+        in_index = true;
+        op->index.accept(this);
+        in_index = old_in_index;
+    }
+
+    void visit(const Store *op) {
+        accumulate(stage().bytes_stored[op->name], trips * bytes_of(op->value.type()));
+        op->value.accept(this);
+        bool old_in_index = in_index;
+        in_index = true;
+        op->index.accept(this);
+        in_index = old_in_index;
+    }
+
+    void visit(const Let *op) {
+        op->value.accept(this);
+        scope.push(op->name, bounds_of_expr_in_scope(op->value, scope));
+        op->body.accept(this);
+        scope.pop(op->name);
+    }
+
+    void visit(const LetStmt *op) {
+        op->value.accept(this);
+        scope.push(op->name, bounds_of_expr_in_scope(op->value, scope));
+        op->body.accept(this);
+        scope.pop(op->name);
+    }
+
+    void visit(const For *op) {
+        op->min.accept(this);
+        op->extent.accept(this);
+
+        Expr extent = upper_bound(op->extent);
+        Interval min_bounds = bounds_of_expr_in_scope(op->min, scope);
+        Interval max_bounds = bounds_of_expr_in_scope(op->min + op->extent - 1, scope);
+
+        Expr old_trips = trips;
+        bool old_in_parallel = in_parallel;
+        if (op->for_type == ForType::Parallel ||
+            (op->device_api != DeviceAPI::None &&
+             op->device_api != DeviceAPI::Host)) {
+            if (!in_parallel) {
+                accumulate(stage().parallel_tasks, trips * extent);
+            }
+            in_parallel = true;
+        }
+        trips = simplify(trips * extent);
+
+        scope.push(op->name, Interval(min_bounds.min, max_bounds.max));
+        op->body.accept(this);
+        scope.pop(op->name);
+
+        trips = old_trips;
+        in_parallel = old_in_parallel;
+    }
+
+    void visit(const Allocate *op) {
+        Expr bytes = bytes_of(op->type);
+        for (Expr e : op->extents) {
+            e.accept(this);
+            bytes *= upper_bound(e);
+        }
+        bytes = simplify(bytes);
+
+        StageCost::Allocation &a = stage().allocations[op->name];
+        a.bytes = a.bytes.defined() ? simplify(max(a.bytes, bytes)) : bytes;
+        accumulate(a.count, trips);
+
+        if (op->condition.defined()) {
+            op->condition.accept(this);
+        }
+        op->body.accept(this);
+    }
+
+    void visit(const ProducerConsumer *op) {
+        int old_stage = current_stage;
+        current_stage = find_stage(op->name);
+        op->produce.accept(this);
+        if (op->update.defined()) {
+            current_stage = find_stage(op->name + ".update");
+            op->update.accept(this);
+        }
+        current_stage = old_stage;
+        op->consume.accept(this);
+    }
+};
+
+// Evaluate a count, or return false if it isn't a constant.
+bool constant_count(Expr e, const map<string, Expr> &values, double *result) {
+    if (!e.defined()) {
+        *result = 0;
+        return true;
+    }
+    e = simplify(substitute(values, e));
+    if (const int64_t *i = as_const_int(e)) {
+        *result = (double)(*i);
+        return true;
+    }
+    return false;
+}
+
+}
+
+std::vector<StageCost> estimate_costs(Stmt s) {
+    EstimateCosts e;
+    s.accept(&e);
+    return e.stages;
+}
+
+MachineParams MachineParams::for_target(const Target &t) {
+    MachineParams m;
+    m.cores = 8;
+    if (t.os == Target::OSUnknown || t.arch == Target::ArchUnknown || t.bits == 0) {
+        m.vector_bytes = 16;
+    } else {
+        m.vector_bytes = t.natural_vector_size(UInt(8));
+    }
+    m.ops_per_second = 6e9;
+    m.bytes_per_second = 20e9;
+
+    size_t defined = 0;
+    string env = get_env_variable("HL_MACHINE_PARAMS", defined);
+    if (defined) {
+        vector<string> fields = split_string(env, ",");
+        user_assert(fields.size() == 4)
+            << "HL_MACHINE_PARAMS should be four comma separated values: "
+            << "cores,vector_bytes,ops_per_second,bytes_per_second. It was: " << env << "\n";
+        m.cores = std::atoi(fields[0].c_str());
+        m.vector_bytes = std::atoi(fields[1].c_str());
+        m.ops_per_second = std::atof(fields[2].c_str());
+        m.bytes_per_second = std::atof(fields[3].c_str());
+        user_assert(m.cores > 0 && m.vector_bytes > 0 &&
+                    m.ops_per_second > 0 && m.bytes_per_second > 0)
+            << "Invalid HL_MACHINE_PARAMS: " << env << "\n";
+    }
+    return m;
+}
+
+void print_cost_report(std::ostream &stream, Stmt s, const MachineParams &machine,
+                       const map<string, Expr> &values) {
+    vector<StageCost> stages = estimate_costs(s);
+
+    double total_compute = 0, total_memory = 0;
+    bool all_constant = true;
+
+    for (const StageCost &stage : stages) {
+        if (stage.ops.empty() && stage.bytes_loaded.empty() &&
+            stage.bytes_stored.empty() && stage.allocations.empty()) {
+            continue;
+        }
+
+        stream << "Stage " << stage.name << ":\n";
+
+        // Instructions executed serially and in parallel, counting
+        // vectors wider than the machine's as several instructions.
+        double serial = 0, parallel = 0, bytes = 0;
+        bool constant = true;
+
+        if (!stage.ops.empty()) {
+            stream << "  ops (serial, parallel):\n";
+        }
+        for (const auto &p : stage.ops) {
+            const StageCost::OpCount &c = p.second;
+            stream << "    " << p.first << ": "
+                   << (c.serial.defined() ? c.serial : make_zero(Int(64))) << ", "
+                   << (c.parallel.defined() ? c.parallel : make_zero(Int(64))) << "\n";
+            int bits = c.type.bits() * c.type.lanes();
+            double width = std::max(1.0, std::ceil(bits / (8.0 * machine.vector_bytes)));
+            double s_count, p_count;
+            if (constant_count(c.serial, values, &s_count) &&
+                constant_count(c.parallel, values, &p_count)) {
+                serial += s_count * width;
+                parallel += p_count * width;
+            } else {
+                constant = false;
+            }
+        }
+        for (int i = 0; i < 2; i++) {
+            const map<string, Expr> &m = i == 0 ? stage.bytes_loaded : stage.bytes_stored;
+            if (!m.empty()) {
+                stream << (i == 0 ? "  bytes loaded:\n" : "  bytes stored:\n");
+            }
+            for (const auto &p : m) {
+                stream << "    " << p.first << ": " << p.second << "\n";
+                double b;
+                if (constant_count(p.second, values, &b)) {
+                    bytes += b;
+                } else {
+                    constant = false;
+                }
+            }
+        }
+        if (!stage.allocations.empty()) {
+            stream << "  allocations (bytes, count):\n";
+        }
+        for (const auto &p : stage.allocations) {
+            stream << "    " << p.first << ": " << p.second.bytes << ", " << p.second.count << "\n";
+        }
+        if (stage.parallel_tasks.defined()) {
+            stream << "  parallel tasks: " << stage.parallel_tasks << "\n";
+        }
+
+        if (constant) {
+            double compute = serial / machine.ops_per_second +
+                parallel / (machine.ops_per_second * machine.cores);
+            double memory = bytes / machine.bytes_per_second;
+            total_compute += compute;
+            total_memory += memory;
+            stream << "  roofline: " << (serial + parallel) << " instructions, "
+                   << bytes << " bytes, "
+                   << (compute >= memory ? "compute" : "memory") << " bound, "
+                   << std::max(compute, memory) * 1e3 << " ms\n";
+        } else {
+            all_constant = false;
+        }
+    }
+
+    if (all_constant) {
+        stream << "Total: " << std::max(total_compute, total_memory) * 1e3 << " ms ("
+               << total_compute * 1e3 << " ms compute, "
+               << total_memory * 1e3 << " ms memory)\n";
+    } else {
+        stream << "Some counts depend on the sizes of the inputs and outputs, "
+               << "so no roofline estimate was made for those stages\n";
+    }
+}
+
+void print_cost_report(std::ostream &stream, const Module &m, const MachineParams &machine) {
+    stream << "Machine: " << machine.cores << " cores, "
+           << machine.vector_bytes << " byte vectors, "
+           << machine.ops_per_second << " instructions/s per core, "
+           << machine.bytes_per_second << " bytes/s\n\n";
+    for (const LoweredFunc &f : m.functions()) {
+        stream << "Function " << f.name << ":\n";
+        print_cost_report(stream, f.body, machine);
+        stream << "\n";
+    }
+}
+
+void cost_estimate_test() {
+    Expr n = Variable::make(Int(32), "n");
+    Expr x = Variable::make(Int(32), "x");
+    Expr y = Variable::make(Int(32), "y");
+
+    // f(x, y) = g(x, y) * 2.0f + 1.0f over an n x 16 region, parallel
+    // over y, with a scratch allocation per row.
+    Expr g = Load::make(Float(32), "g", x + y * n, Buffer(), Parameter());
+    Stmt store = Store::make("f", g * 2.0f + 1.0f, x + y * n, Parameter());
+    Stmt scratch = Store::make("tmp", cast<uint8_t>(x), x, Parameter());
+    Stmt inner = For::make("x", 0, n, ForType::Serial, DeviceAPI::None,
+                           Block::make(scratch, store));
+    Stmt row = Allocate::make("tmp", UInt(8), {n}, const_true(), inner);
+    Stmt outer = For::make("y", 0, 16, ForType::Parallel, DeviceAPI::None, row);
+    Stmt s = ProducerConsumer::make("f", outer, Stmt(), Evaluate::make(0));
+
+    vector<StageCost> stages = estimate_costs(s);
+    const StageCost *f = nullptr;
+    for (const StageCost &stage : stages) {
+        if (stage.name == "f") f = &stage;
+    }
+    internal_assert(f) << "No cost estimate for stage f\n";
+
+    auto check = [&](Expr e, Expr correct) {
+        internal_assert(e.defined() && is_zero(simplify(e - correct)))
+            << "Cost estimate: " << e << " instead of " << correct << "\n";
+    };
+
+    Expr elements = cast<int64_t>(n) * 16;
+    internal_assert(f->ops.count("float32") && f->ops.count("uint8"));
+    check(f->ops.at("float32").parallel, elements * 2);
+    check(f->ops.at("uint8").parallel, elements);
+    internal_assert(!f->ops.at("float32").serial.defined());
+    // The index arithmetic isn't counted.
+    internal_assert(!f->ops.count("int32"));
+    check(f->bytes_loaded.at("g"), elements * 4);
+    check(f->bytes_stored.at("f"), elements * 4);
+    check(f->allocations.at("tmp").bytes, cast<int64_t>(n));
+    check(f->allocations.at("tmp").count, make_const(Int(64), 16));
+    check(f->parallel_tasks, make_const(Int(64), 16));
+
+    // With 1M elements, two float ops and a cast per 9 bytes
+    // moved is memory bound on any plausible machine.
+    MachineParams machine = {4, 16, 1e9, 1e9};
+    std::ostringstream report;
+    print_cost_report(report, s, machine, {{"n", 65536}});
+    internal_assert(report.str().find("memory bound") != string::npos)
+        << "Unexpected cost report:\n" << report.str();
+
+    std::cout << "cost_estimate test passed\n";
+}
+
+}
+}
@@ -0,0 +1,95 @@
+#ifndef HALIDE_COST_ESTIMATE_H
+#define HALIDE_COST_ESTIMATE_H
+
+/** \file
+ * Defines a static estimate of the work done by lowered code, and a
+ * roofline-style report based on it.
+ */
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "IR.h"
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** The estimated work done by one stage of a pipeline (everything
+ * within the produce and update nodes for a Func, other than nested
+ * stages). All counts are symbolic Int(64) expressions, usually in
+ * terms of the sizes of the inputs and outputs. */
+struct StageCost {
+    std::string name;
+
+    /** The number of times arithmetic ops of a type are executed
+     * outside of parallel loops and within them. Address arithmetic
+     * in load and store indices is not counted. */
+    struct OpCount {
+        Type type;
+        Expr serial, parallel;
+    };
+    std::map<std::string, OpCount> ops;
+
+    /** The bytes loaded from and stored to each buffer. */
+    std::map<std::string, Expr> bytes_loaded, bytes_stored;
+
+    /** The size of each allocation made, and how many times it is
+     * made. */
+    struct Allocation {
+        Expr bytes, count;
+    };
+    std::map<std::string, Allocation> allocations;
+
+    /** The number of iterations of parallel loops, if any. */
+    Expr parallel_tasks;
+};
+
+/** Estimate the work done by each stage of some lowered code. Loop
+ * trip counts are the upper bounds computed by the bounds inference
+ * machinery, and both sides of if statements are counted, so these
+ * are upper bounds too. */
+std::vector<StageCost> estimate_costs(Stmt s);
+
+/** A simple description of a machine, used to turn the counts from
+ * estimate_costs into a roofline estimate. */
+struct MachineParams {
+    /** The number of cores that parallel loops are spread over. */
+    int cores;
+
+    /** The size of a vector register. Wider vector ops count as
+     * several instructions. */
+    int vector_bytes;
+
+    /** The number of arithmetic instructions one core retires per
+     * second. */
+    double ops_per_second;
+
+    /** The memory bandwidth shared by all cores. */
+    double bytes_per_second;
+
+    /** Rough defaults for a desktop class machine with the vector
+     * width of the given target. These can be overridden with the
+     * environment variable HL_MACHINE_PARAMS, set to a comma
+     * separated list of the four values above. */
+    static MachineParams for_target(const Target &t);
+};
+
+/** Print the estimated work done by each stage of some lowered code,
+ * and, where the counts are constants (or become constants after
+ * substituting the given values for variables), whether the stage is
+ * likely to be limited by compute or memory bandwidth on the given
+ * machine. */
+void print_cost_report(std::ostream &stream, Stmt s, const MachineParams &machine,
+                       const std::map<std::string, Expr> &values = std::map<std::string, Expr>());
+
+/** Print a cost report for each function in a module. */
+void print_cost_report(std::ostream &stream, const Module &m, const MachineParams &machine);
+
+EXPORT void cost_estimate_test();
+
+}
+}
+
+#endif
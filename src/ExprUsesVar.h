@@ -20,10 +20,10 @@ class ExprUsesVars : public IRGraphVisitor {
     Scope<Expr> scope;
 
     void visit(const Variable *v) {
-        if (vars.contains(v->name)) {
+        if (vars.contains(v->symbol())) {
             result = true;
-        } else if (scope.contains(v->name)) {
-            include(scope.get(v->name));
+        } else if (scope.contains(v->symbol())) {
+            include(scope.get(v->symbol()));
         }
     }
 public:
@@ -2410,6 +2410,12 @@ void Func::compile_to_lowered_stmt(const string &filename,
     pipeline().compile_to_lowered_stmt(filename, args, fmt, target);
 }
 
+void Func::compile_to_cost_report(const string &filename,
+                                  const vector<Argument> &args,
+                                  const Target &target) {
+    pipeline().compile_to_cost_report(filename, args, target);
+}
+
 void Func::print_loop_nest() {
     pipeline().print_loop_nest();
 }
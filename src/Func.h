@@ -592,6 +592,15 @@ public:
                                         StmtOutputFormat fmt = Text,
                                         const Target &target = get_target_from_environment());
 
+    /** Write out a static estimate of the work done by each stage of
+     * the lowered code: arithmetic ops by type, bytes loaded and
+     * stored, allocations and parallel tasks, along with a
+     * roofline-style estimate of whether each stage is limited by
+     * compute or memory bandwidth. See CostEstimate.h. */
+    EXPORT void compile_to_cost_report(const std::string &filename,
+                                       const std::vector<Argument> &args,
+                                       const Target &target = get_target_from_environment());
+
     /** Write out the loop nests specified by the schedule for this
      * Function. Helpful for understanding what a schedule is
      * doing. */
@@ -1,4 +1,5 @@
 #include "Generator.h"
+#include "Autotune.h"
 #include "Outputs.h"
 
 namespace Halide {
@@ -85,6 +86,9 @@ Outputs compute_outputs(const Target &target,
     if (options.emit_stmt_html) {
         output_files.stmt_html_name = base_path + get_extension(".html", options);
     }
+    if (options.emit_cost_report) {
+        output_files.cost_report_name = base_path + get_extension(".cost", options);
+    }
     if (options.emit_static_library) {
         if (is_windows_coff) {
             output_files.static_library_name = base_path + get_extension(".lib", options);
@@ -121,11 +125,13 @@ const std::map<std::string, Halide::Type> &get_halide_type_enum_map() {
 
 int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] "
-                          "target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
+                          "[-p TUNED_PARAMS_FILE] target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of files to emit. Accepted values are "
-                          "[assembly, bitcode, cpp, h, html, o, static_library, stmt]. If omitted, default value is [static_library, h].\n"
+                          "[assembly, bitcode, cost, cpp, h, html, o, static_library, stmt]. If omitted, default value is [static_library, h].\n"
                           "  -x  A comma separated list of file extension pairs to substitute during file naming, "
-                          "in the form [.old=.new[,.old2=.new2]]\n";
+                          "in the form [.old=.new[,.old2=.new2]]\n"
+                          "  -p  A file of generator_arg values written by the autotuner. The values recorded for the "
+                          "generator and each target are used unless given explicitly.\n";
 
     std::map<std::string, std::string> flags_info = { { "-f", "" },
                                                       { "-g", "" },
@@ -133,7 +139,8 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                                                       { "-e", "" },
                                                       { "-n", "" },
                                                       { "-x", "" },
-                                                      { "-r", "" }};
+                                                      { "-r", "" },
+                                                      { "-p", "" }};
     std::map<std::string, std::string> generator_args;
 
     for (int i = 1; i < argc; ++i) {
@@ -221,6 +228,8 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 emit_options.emit_stmt = true;
             } else if (opt == "html") {
                 emit_options.emit_stmt_html = true;
+            } else if (opt == "cost") {
+                emit_options.emit_cost_report = true;
             } else if (opt == "cpp") {
                 emit_options.emit_cpp = true;
             } else if (opt == "o") {
@@ -231,7 +240,7 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 emit_options.emit_static_library = true;
             } else if (!opt.empty()) {
                 cerr << "Unrecognized emit option: " << opt
-                     << " not one of [assembly, bitcode, cpp, h, html, o, static_library, stmt], ignoring.\n";
+                     << " not one of [assembly, bitcode, cost, cpp, h, html, o, static_library, stmt], ignoring.\n";
             }
         }
     }
@@ -270,10 +279,18 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     if (!generator_name.empty()) {
         std::string base_path = compute_base_path(output_dir, function_name, file_base_name);
         Outputs output_files = compute_outputs(targets[0], base_path, emit_options);
-        auto module_producer = [&generator_name, &generator_args, &cerr]
+        const std::string tuned_params_file = flags_info["-p"];
+        auto module_producer = [&generator_name, &generator_args, &tuned_params_file, &cerr]
             (const std::string &name, const Target &target) -> Module {
                 auto sub_generator_args = generator_args;
                 sub_generator_args["target"] = target.to_string();
+                if (!tuned_params_file.empty()) {
+                    GeneratorParamValues tuned;
+                    if (load_tuned_params(tuned_params_file, generator_name, target, tuned)) {
+                        // Values given on the command line take precedence.
+                        sub_generator_args.insert(tuned.begin(), tuned.end());
+                    }
+                }
                 // Must re-create each time since each instance will have a different Target
                 auto gen = GeneratorRegistry::create(generator_name, sub_generator_args);
                 if (gen == nullptr) {
@@ -283,7 +300,9 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 return gen->build_module(name);
             };
         if (targets.size() > 1) {
-            compile_multitarget(function_name, output_files, targets, module_producer);
+            // Each target gets a Generator of its own, so they can be
+            // built and lowered concurrently.
+            compile_multitarget(function_name, output_files, targets, module_producer, true);
         } else {
             // compile_multitarget() will fail if we request anything but library and/or header,
             // so defer directly to Module::compile if there is a single target.
@@ -0,0 +1,385 @@
+#include "HoistLoopInvariants.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IREquality.h"
+#include "Substitute.h"
+#include "Scope.h"
+
+#include <map>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Find all the names defined anywhere within a loop body. Anything
+// that refers to one of these can't be moved out of the loop.
+class FindBoundNames : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Let *op) {
+        names.push(op->name, 0);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const LetStmt *op) {
+        names.push(op->name, 0);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const For *op) {
+        names.push(op->name, 0);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Allocate *op) {
+        names.push(op->name, 0);
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    Scope<int> names;
+};
+
+// Check if an expression can safely be evaluated once before a loop
+// instead of on every iteration. It must not depend on anything that
+// varies within the loop, and it must not be able to fault, because
+// the loop may run zero times.
+class CanLift : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    const Scope<int> &varying;
+
+    void visit(const Variable *op) {
+        if (varying.contains(op->name)) {
+            result = false;
+        }
+    }
+
+    void visit(const Load *op) {
+        result = false;
+    }
+
+    void visit(const Let *op) {
+        result = false;
+    }
+
+    void visit(const Call *op) {
+        if (op->call_type != Call::PureExtern) {
+            result = false;
+        } else {
+            IRGraphVisitor::visit(op);
+        }
+    }
+
+    void visit(const Div *op) {
+        if (!op->type.is_float() && !(is_const(op->b) && !is_zero(op->b))) {
+            result = false;
+        } else {
+            IRGraphVisitor::visit(op);
+        }
+    }
+
+    void visit(const Mod *op) {
+        if (!op->type.is_float() && !(is_const(op->b) && !is_zero(op->b))) {
+            result = false;
+        } else {
+            IRGraphVisitor::visit(op);
+        }
+    }
+
+public:
+    CanLift(const Scope<int> &v) : varying(v), result(true) {}
+    bool result;
+};
+
+bool can_lift(Expr e, const Scope<int> &varying) {
+    CanLift c(varying);
+    e.accept(&c);
+    return c.result;
+}
+
+bool is_leaf(Expr e) {
+    return is_const(e) || e.as<Variable>() || e.as<StringImm>();
+}
+
+// Lifting a leaf (or a cast of one) out of a loop saves nothing.
+bool worth_lifting(Expr e) {
+    if (const Cast *cast = e.as<Cast>()) {
+        e = cast->value;
+    }
+    return !is_leaf(e);
+}
+
+// Break a sum into its terms. The bool is true for terms that are
+// subtracted.
+void flatten_sum(Expr e, bool negate, vector<pair<Expr, bool>> &terms) {
+    if (const Add *add = e.as<Add>()) {
+        flatten_sum(add->a, negate, terms);
+        flatten_sum(add->b, negate, terms);
+    } else if (const Sub *sub = e.as<Sub>()) {
+        flatten_sum(sub->a, negate, terms);
+        flatten_sum(sub->b, !negate, terms);
+    } else {
+        terms.push_back({e, negate});
+    }
+}
+
+// Replace the invariant parts of the expressions within a single
+// loop body with variables, and remember what they were.
+class LiftInvariants : public IRMutator {
+    const Scope<int> &varying;
+    map<Expr, string, IRDeepCompare> lifted_names;
+
+    Expr lift(Expr e) {
+        auto iter = lifted_names.find(e);
+        if (iter != lifted_names.end()) {
+            return Variable::make(e.type(), iter->second);
+        }
+        string name = unique_name('h');
+        lifted_names[e] = name;
+        lifted.push_back({name, e});
+        return Variable::make(e.type(), name);
+    }
+
+    // Rewrite an index as (invariant terms) + (varying terms) and
+    // lift the invariant part.
+    Expr reassociate_index(Expr index) {
+        if (const Ramp *ramp = index.as<Ramp>()) {
+            Expr base = reassociate_index(ramp->base);
+            Expr stride = mutate(ramp->stride);
+            if (base.same_as(ramp->base) && stride.same_as(ramp->stride)) {
+                return index;
+            }
+            return Ramp::make(base, stride, ramp->lanes);
+        }
+
+        if (index.type() != Int(32)) {
+            return mutate(index);
+        }
+
+        vector<pair<Expr, bool>> terms;
+        flatten_sum(index, false, terms);
+
+        // Keep the added terms ahead of the subtracted ones, so the
+        // lifted sum doesn't start with a negation.
+        vector<pair<Expr, bool>> invariant, subtracted, variant;
+        for (const auto &t : terms) {
+            if (!can_lift(t.first, varying)) {
+                variant.push_back(t);
+            } else if (t.second) {
+                subtracted.push_back(t);
+            } else {
+                invariant.push_back(t);
+            }
+        }
+        invariant.insert(invariant.end(), subtracted.begin(), subtracted.end());
+
+        // With a single invariant term there's nothing to reassociate,
+        // but the term itself may still get lifted.
+        if (variant.empty() || invariant.size() < 2) {
+            return mutate(index);
+        }
+
+        Expr base;
+        for (const auto &t : invariant) {
+            if (!base.defined()) {
+                base = t.second ? Sub::make(make_zero(t.first.type()), t.first) : t.first;
+            } else if (t.second) {
+                base = Sub::make(base, t.first);
+            } else {
+                base = Add::make(base, t.first);
+            }
+        }
+
+        Expr result = lift(base);
+        for (const auto &t : variant) {
+            Expr term = mutate(t.first);
+            if (t.second) {
+                result = Sub::make(result, term);
+            } else {
+                result = Add::make(result, term);
+            }
+        }
+        return result;
+    }
+
+    using IRMutator::visit;
+
+    void visit(const Load *op) {
+        Expr index = reassociate_index(op->index);
+        if (index.same_as(op->index)) {
+            expr = op;
+        } else {
+            expr = Load::make(op->type, op->name, index, op->image, op->param);
+        }
+    }
+
+    void visit(const Store *op) {
+        Expr value = mutate(op->value);
+        Expr index = reassociate_index(op->index);
+        if (value.same_as(op->value) && index.same_as(op->index)) {
+            stmt = op;
+        } else {
+            stmt = Store::make(op->name, value, index, op->param);
+        }
+    }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+public:
+    LiftInvariants(const Scope<int> &v) : varying(v) {}
+
+    vector<pair<string, Expr>> lifted;
+
+    using IRMutator::mutate;
+
+    Expr mutate(Expr e) {
+        if (e.defined() &&
+            e.type().is_scalar() &&
+            worth_lifting(e) &&
+            can_lift(e, varying)) {
+            return lift(e);
+        } else {
+            return IRMutator::mutate(e);
+        }
+    }
+};
+
+class HoistLoopInvariants : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Leave device code to the device's own compiler. Moving
+            // things out of these loops would move them to the host.
+            stmt = op;
+            return;
+        }
+
+        // Do the inner loops first, so that things that are
+        // invariant in several loops get lifted all the way out.
+        Stmt body = mutate(op->body);
+
+        FindBoundNames bound;
+        body.accept(&bound);
+        bound.names.push(op->name, 0);
+
+        LiftInvariants lifter(bound.names);
+        body = lifter.mutate(body);
+
+        if (body.same_as(op->body)) {
+            stmt = op;
+            return;
+        }
+
+        stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        for (size_t i = lifter.lifted.size(); i > 0; i--) {
+            const auto &l = lifter.lifted[i-1];
+            debug(4) << "Lifting " << l.first << " = " << l.second << " out of loop over " << op->name << "\n";
+            stmt = LetStmt::make(l.first, l.second, stmt);
+        }
+    }
+};
+
+} // namespace
+
+Stmt hoist_loop_invariants(Stmt s) {
+    return HoistLoopInvariants().mutate(s);
+}
+
+namespace {
+
+void check(Stmt s, const vector<Expr> &lifted, Expr index, Expr value) {
+    Stmt result = hoist_loop_invariants(s);
+    Stmt orig = result;
+
+    map<string, Expr> names;
+    size_t i = 0;
+    while (const LetStmt *let = result.as<LetStmt>()) {
+        internal_assert(i < lifted.size() && equal(let->value, lifted[i]))
+            << "Unexpected lifted value " << let->value << " in:\n" << orig;
+        names[let->name] = Variable::make(let->value.type(), "h" + std::to_string(i));
+        result = let->body;
+        i++;
+    }
+    internal_assert(i == lifted.size())
+        << "Expected " << lifted.size() << " lifted values in:\n" << orig;
+
+    const For *loop = result.as<For>();
+    internal_assert(loop) << "Expected a for loop in:\n" << orig;
+    const Store *store = loop->body.as<Store>();
+    internal_assert(store) << "Expected a store in:\n" << orig;
+
+    // Give the lifted variables predictable names before comparing.
+    Expr result_index = store->index, result_value = store->value;
+    for (const auto &n : names) {
+        result_index = substitute(n.first, n.second, result_index);
+        result_value = substitute(n.first, n.second, result_value);
+    }
+    internal_assert(equal(result_index, index) && equal(result_value, value))
+        << "Incorrect loop invariant hoisting:\n" << s
+        << "\nbecame:\n" << orig
+        << "\ninstead of storing " << value << " at " << index << "\n";
+}
+
+} // namespace
+
+void hoist_loop_invariants_test() {
+    Expr x = Variable::make(Int(32), "x");
+    Expr y = Variable::make(Int(32), "y");
+    Expr s = Variable::make(Int(32), "s");
+    Expr m = Variable::make(Int(32), "m");
+    Expr a = Variable::make(Float(32), "a");
+    Expr h0 = Variable::make(Int(32), "h0");
+    Expr hf0 = Variable::make(Float(32), "h0");
+
+    auto loop = [&](Expr value, Expr index) {
+        return For::make("x", 0, 100, ForType::Serial, DeviceAPI::None,
+                         Store::make("f", value, index, Parameter()));
+    };
+
+    // An index with a runtime stride gets split into a lifted base
+    // plus the loop variable.
+    check(loop(cast<float>(x), y * s + x - m),
+          {Sub::make(y * s, m)}, h0 + x, cast<float>(x));
+
+    // A call to a pure function of invariants is lifted, and only
+    // computed once even when used twice.
+    Expr sq = Call::make(Float(32), "sqrt_f32", {a + 1.0f}, Call::PureExtern);
+    check(loop(sq * cast<float>(x) + sq, x),
+          {sq}, x, hf0 * cast<float>(x) + hf0);
+
+    // A single invariant term is lifted by itself. Leaves and
+    // anything involving the loop variable stay put.
+    check(loop(a * cast<float>(x), y * s + x), {y * s}, h0 + x, a * cast<float>(x));
+
+    // Loads and divisions by a non-constant might fault if the loop
+    // runs zero times, so they stay inside.
+    Expr ld = Load::make(Float(32), "g", y, Buffer(), Parameter());
+    Expr q = cast<float>((y * s) / m);
+    check(loop(ld * cast<float>(x), x), {}, x, ld * cast<float>(x));
+    check(loop(q * cast<float>(x), x), {y * s}, x, cast<float>(h0 / m) * cast<float>(x));
+
+    // Divisions by a non-zero constant are fine.
+    Expr q2 = cast<float>((y * s) / 3) + a * a;
+    check(loop(q2 * cast<float>(x), x), {q2}, x, hf0 * cast<float>(x));
+
+    std::cout << "hoist_loop_invariants test passed\n";
+}
+
+}
+}
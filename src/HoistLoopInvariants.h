@@ -0,0 +1,31 @@
+#ifndef HALIDE_HOIST_LOOP_INVARIANTS_H
+#define HALIDE_HOIST_LOOP_INVARIANTS_H
+
+/** \file
+ * Defines the lowering pass that moves loop-invariant computation out
+ * of for loops.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Move pure scalar expressions that don't depend on a for loop's
+ * variable (or on anything defined inside the loop) into lets just
+ * outside the loop. Load and store indices are first reassociated
+ * into a loop-invariant part plus a varying part, so that an index
+ * like y*stride + x - (min_y*stride + min_x) inside a loop over x
+ * becomes a lifted base plus x, which LLVM's strength reduction
+ * turns into an incremented pointer. Expressions that could fault
+ * (loads, integer division by a non-constant) are never moved, as the
+ * loop may run zero times. Loops that run on a device are left
+ * alone. */
+Stmt hoist_loop_invariants(Stmt s);
+
+EXPORT void hoist_loop_invariants_test();
+
+}
+}
+
+#endif
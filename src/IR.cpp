@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
 #include "IR.h"
 #include "IRPrinter.h"
 #include "IRVisitor.h"
@@ -5,14 +9,296 @@
 namespace Halide {
 namespace Internal {
 
+namespace {
+
+// The most common constants are shared between all the IR that uses
+// them, instead of being allocated and freed again by every mutator
+// pass that rebuilds an expression containing them. This also makes
+// equality checks on them a pointer comparison. The cache holds a
+// reference to each node, and is never freed. Other nodes are only
+// shared while a ScopedHashConsing is active (see below).
+const int small_int_min = -8, small_int_max = 8;
+
+IntImm *new_int_imm(Type t, int64_t value) {
+    IntImm *node = new IntImm;
+    node->type = t;
+    node->value = value;
+    return node;
+}
+
+UIntImm *new_uint_imm(Type t, uint64_t value) {
+    UIntImm *node = new UIntImm;
+    node->type = t;
+    node->value = value;
+    return node;
+}
+
+struct ConstantCache {
+    Expr small_ints[small_int_max - small_int_min + 1];
+    Expr bools[2];
+
+    ConstantCache() {
+        for (int i = small_int_min; i <= small_int_max; i++) {
+            small_ints[i - small_int_min] = new_int_imm(Int(32), i);
+        }
+        bools[0] = new_uint_imm(UInt(1), 0);
+        bools[1] = new_uint_imm(UInt(1), 1);
+    }
+};
+
+const ConstantCache &constant_cache() {
+    static ConstantCache *cache = new ConstantCache;
+    return *cache;
+}
+
+}
+
+// The key of a hash-consed node: its node type, its type, its
+// children, and a payload holding the value of a constant or the
+// lanes of a Ramp or Broadcast. The children are compared by address,
+// which is enough because they are hash-consed themselves. The node
+// the key maps to holds a reference to each child, so the addresses
+// stay valid for as long as the entry does.
+struct HashConsKey {
+    IRNodeType node_type;
+    Type type;
+    const IRNode *ops[3];
+    uint64_t payload;
+
+    HashConsKey(IRNodeType node_type, Type type,
+                const IRNode *a = nullptr, const IRNode *b = nullptr, const IRNode *c = nullptr,
+                uint64_t payload = 0) :
+        node_type(node_type), type(type), ops{a, b, c}, payload(payload) {}
+
+    bool operator==(const HashConsKey &other) const {
+        return (node_type == other.node_type &&
+                type == other.type &&
+                ops[0] == other.ops[0] &&
+                ops[1] == other.ops[1] &&
+                ops[2] == other.ops[2] &&
+                payload == other.payload);
+    }
+
+    struct Hash {
+        size_t operator()(const HashConsKey &k) const {
+            size_t h = (size_t)k.node_type;
+            h = h * 31 + (size_t)k.type.code();
+            h = h * 31 + (size_t)k.type.bits();
+            h = h * 31 + (size_t)k.type.lanes();
+            for (const IRNode *op : k.ops) {
+                h = h * 31 + std::hash<const IRNode *>()(op);
+            }
+            return h * 31 + std::hash<uint64_t>()(k.payload);
+        }
+    };
+};
+
+struct HashConsTable {
+    std::unordered_map<HashConsKey, Expr, HashConsKey::Hash> nodes;
+
+    // Variables are looked up by name, without copying the name. Only
+    // those with no Buffer, Parameter or reduction domain are
+    // hash-consed, so the name and type identify them.
+    std::unordered_map<std::string, std::vector<Expr>> variables;
+
+    size_t entries = 0, hits = 0, misses = 0, bytes_saved = 0;
+
+    // The table holds a reference to every node in it, so nodes that
+    // are no longer used anywhere else are only freed when it is
+    // swept. It is swept whenever it has doubled in size since the
+    // last sweep, which keeps it within twice the size of the live
+    // IR, at an amortized constant cost per node made.
+    static const size_t min_capacity = 4096;
+    size_t capacity = min_capacity;
+
+    void added() {
+        misses++;
+        if (++entries > capacity) {
+            sweep();
+            capacity = std::max(min_capacity, entries * 2);
+        }
+    }
+
+    // Drop the nodes that only the table refers to. Constants are
+    // kept, as IntImm::make, UIntImm::make and FloatImm::make hand out
+    // a raw pointer that the caller may hold across another make.
+    void sweep() {
+        for (auto iter = nodes.begin(); iter != nodes.end(); ) {
+            IRNodeType t = iter->first.node_type;
+            bool constant = (t == IRNodeType::IntImm || t == IRNodeType::UIntImm || t == IRNodeType::FloatImm);
+            if (!constant && iter->second.get()->ref_count.is_one()) {
+                iter = nodes.erase(iter);
+                entries--;
+            } else {
+                ++iter;
+            }
+        }
+        for (auto iter = variables.begin(); iter != variables.end(); ) {
+            std::vector<Expr> &vars = iter->second;
+            size_t before = vars.size();
+            vars.erase(std::remove_if(vars.begin(), vars.end(),
+                                      [](const Expr &v) { return v.get()->ref_count.is_one(); }),
+                       vars.end());
+            entries -= before - vars.size();
+            if (vars.empty()) {
+                iter = variables.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+};
+
+const size_t HashConsTable::min_capacity;
+
+namespace {
+
+// The hash-consing table of the lowering running on this thread, if
+// any. Each lowering has its own table, so no locking is needed.
+thread_local HashConsTable *current_hash_cons_table = nullptr;
+
+// Return the node with the given key from the table of this thread,
+// or make one, filling in its fields with fill, and add it.
+template<typename NodeType, typename Fill>
+Expr hash_consed(const HashConsKey &key, Fill fill) {
+    HashConsTable *table = current_hash_cons_table;
+    if (table) {
+        auto iter = table->nodes.find(key);
+        if (iter != table->nodes.end()) {
+            table->hits++;
+            table->bytes_saved += sizeof(NodeType);
+            return iter->second;
+        }
+    }
+    NodeType *node = new NodeType;
+    fill(node);
+    Expr result = node;
+    if (table) {
+        table->nodes.emplace(key, result);
+        table->added();
+    }
+    return result;
+}
+
+template<typename NodeType>
+Expr make_binary(Type t, Expr a, Expr b) {
+    return hash_consed<NodeType>(HashConsKey(NodeType::_type_info, t, a.get(), b.get()),
+                                 [&](NodeType *node) {
+                                     node->type = t;
+                                     node->a = a;
+                                     node->b = b;
+                                 });
+}
+
+}
+
+ScopedHashConsing::ScopedHashConsing(bool enabled) :
+    table(enabled ? new HashConsTable : nullptr), previous(current_hash_cons_table) {
+    current_hash_cons_table = table.get();
+}
+
+ScopedHashConsing::~ScopedHashConsing() {
+    if (table) {
+        debug(1) << "Hash-consing: " << table->hits << " nodes shared, "
+                 << table->misses << " nodes made, "
+                 << table->bytes_saved << " bytes of allocations avoided\n";
+    }
+    current_hash_cons_table = previous;
+}
+
+const IntImm *IntImm::make(Type t, int64_t value) {
+    internal_assert(t.is_int() && t.is_scalar())
+        << "IntImm must be a scalar Int\n";
+    internal_assert(t.bits() == 8 || t.bits() == 16 || t.bits() == 32 || t.bits() == 64)
+        << "IntImm must be 8, 16, 32, or 64-bit\n";
+
+    // Normalize the value by dropping the high bits
+    value <<= (64 - t.bits());
+    // Then sign-extending to get them back
+    value >>= (64 - t.bits());
+
+    if (t.bits() == 32 && value >= small_int_min && value <= small_int_max) {
+        return constant_cache().small_ints[value - small_int_min].as<IntImm>();
+    }
+
+    if (!current_hash_cons_table) {
+        return new_int_imm(t, value);
+    }
+    // The table keeps the node alive once the Expr returned here is
+    // gone.
+    return hash_consed<IntImm>(HashConsKey(IRNodeType::IntImm, t, nullptr, nullptr, nullptr, (uint64_t)value),
+                               [&](IntImm *node) {
+                                   node->type = t;
+                                   node->value = value;
+                               }).as<IntImm>();
+}
+
+const UIntImm *UIntImm::make(Type t, uint64_t value) {
+    internal_assert(t.is_uint() && t.is_scalar())
+        << "UIntImm must be a scalar UInt\n";
+    internal_assert(t.bits() == 1 || t.bits() == 8 || t.bits() == 16 || t.bits() == 32 || t.bits() == 64)
+        << "UIntImm must be 1, 8, 16, 32, or 64-bit\n";
+
+    // Normalize the value by dropping the high bits
+    value <<= (64 - t.bits());
+    value >>= (64 - t.bits());
+
+    if (t.bits() == 1) {
+        return constant_cache().bools[value].as<UIntImm>();
+    }
+
+    if (!current_hash_cons_table) {
+        return new_uint_imm(t, value);
+    }
+    return hash_consed<UIntImm>(HashConsKey(IRNodeType::UIntImm, t, nullptr, nullptr, nullptr, value),
+                                [&](UIntImm *node) {
+                                    node->type = t;
+                                    node->value = value;
+                                }).as<UIntImm>();
+}
+
+const FloatImm *FloatImm::make(Type t, double value) {
+    internal_assert(t.is_float() && t.is_scalar())
+        << "FloatImm must be a scalar Float\n";
+    switch (t.bits()) {
+    case 16:
+        value = (double)((float16_t)value);
+        break;
+    case 32:
+        value = (float)value;
+        break;
+    case 64:
+        break;
+    default:
+        internal_error << "FloatImm must be 16, 32, or 64-bit\n";
+    }
+
+    if (!current_hash_cons_table) {
+        FloatImm *node = new FloatImm;
+        node->type = t;
+        node->value = value;
+        return node;
+    }
+
+    // Key on the bits of the value, so that 0 and -0 are kept apart.
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return hash_consed<FloatImm>(HashConsKey(IRNodeType::FloatImm, t, nullptr, nullptr, nullptr, bits),
+                                 [&](FloatImm *node) {
+                                     node->type = t;
+                                     node->value = value;
+                                 }).as<FloatImm>();
+}
+
 Expr Cast::make(Type t, Expr v) {
     internal_assert(v.defined()) << "Cast of undefined\n";
     internal_assert(t.lanes() == v.type().lanes()) << "Cast may not change vector widths\n";
 
-    Cast *node = new Cast;
-    node->type = t;
-    node->value = v;
-    return node;
+    return hash_consed<Cast>(HashConsKey(IRNodeType::Cast, t, v.get()),
+                             [&](Cast *node) {
+                                 node->type = t;
+                                 node->value = v;
+                             });
 }
 
 Expr Add::make(Expr a, Expr b) {
@@ -20,11 +306,7 @@ Expr Add::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Add of undefined\n";
     internal_assert(a.type() == b.type()) << "Add of mismatched types\n";
 
-    Add *node = new Add;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Add>(a.type(), a, b);
 }
 
 Expr Sub::make(Expr a, Expr b) {
@@ -32,11 +314,7 @@ Expr Sub::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Sub of undefined\n";
     internal_assert(a.type() == b.type()) << "Sub of mismatched types\n";
 
-    Sub *node = new Sub;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Sub>(a.type(), a, b);
 }
 
 Expr Mul::make(Expr a, Expr b) {
@@ -44,11 +322,7 @@ Expr Mul::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Mul of undefined\n";
     internal_assert(a.type() == b.type()) << "Mul of mismatched types\n";
 
-    Mul *node = new Mul;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Mul>(a.type(), a, b);
 }
 
 Expr Div::make(Expr a, Expr b) {
@@ -56,11 +330,7 @@ Expr Div::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Div of undefined\n";
     internal_assert(a.type() == b.type()) << "Div of mismatched types\n";
 
-    Div *node = new Div;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Div>(a.type(), a, b);
 }
 
 Expr Mod::make(Expr a, Expr b) {
@@ -68,11 +338,7 @@ Expr Mod::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Mod of undefined\n";
     internal_assert(a.type() == b.type()) << "Mod of mismatched types\n";
 
-    Mod *node = new Mod;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Mod>(a.type(), a, b);
 }
 
 Expr Min::make(Expr a, Expr b) {
@@ -80,11 +346,7 @@ Expr Min::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Min of undefined\n";
     internal_assert(a.type() == b.type()) << "Min of mismatched types\n";
 
-    Min *node = new Min;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Min>(a.type(), a, b);
 }
 
 Expr Max::make(Expr a, Expr b) {
@@ -92,11 +354,7 @@ Expr Max::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "Max of undefined\n";
     internal_assert(a.type() == b.type()) << "Max of mismatched types\n";
 
-    Max *node = new Max;
-    node->type = a.type();
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Max>(a.type(), a, b);
 }
 
 Expr EQ::make(Expr a, Expr b) {
@@ -104,11 +362,7 @@ Expr EQ::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "EQ of undefined\n";
     internal_assert(a.type() == b.type()) << "EQ of mismatched types\n";
 
-    EQ *node = new EQ;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<EQ>(Bool(a.type().lanes()), a, b);
 }
 
 Expr NE::make(Expr a, Expr b) {
@@ -116,11 +370,7 @@ Expr NE::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "NE of undefined\n";
     internal_assert(a.type() == b.type()) << "NE of mismatched types\n";
 
-    NE *node = new NE;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<NE>(Bool(a.type().lanes()), a, b);
 }
 
 Expr LT::make(Expr a, Expr b) {
@@ -128,11 +378,7 @@ Expr LT::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "LT of undefined\n";
     internal_assert(a.type() == b.type()) << "LT of mismatched types\n";
 
-    LT *node = new LT;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<LT>(Bool(a.type().lanes()), a, b);
 }
 
 
@@ -141,11 +387,7 @@ Expr LE::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "LE of undefined\n";
     internal_assert(a.type() == b.type()) << "LE of mismatched types\n";
 
-    LE *node = new LE;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<LE>(Bool(a.type().lanes()), a, b);
 }
 
 Expr GT::make(Expr a, Expr b) {
@@ -153,11 +395,7 @@ Expr GT::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "GT of undefined\n";
     internal_assert(a.type() == b.type()) << "GT of mismatched types\n";
 
-    GT *node = new GT;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<GT>(Bool(a.type().lanes()), a, b);
 }
 
 
@@ -166,11 +404,7 @@ Expr GE::make(Expr a, Expr b) {
     internal_assert(b.defined()) << "GE of undefined\n";
     internal_assert(a.type() == b.type()) << "GE of mismatched types\n";
 
-    GE *node = new GE;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<GE>(Bool(a.type().lanes()), a, b);
 }
 
 Expr And::make(Expr a, Expr b) {
@@ -180,11 +414,7 @@ Expr And::make(Expr a, Expr b) {
     internal_assert(b.type().is_bool()) << "rhs of And is not a bool\n";
     internal_assert(a.type() == b.type()) << "And of mismatched types\n";
 
-    And *node = new And;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<And>(Bool(a.type().lanes()), a, b);
 }
 
 Expr Or::make(Expr a, Expr b) {
@@ -194,21 +424,19 @@ Expr Or::make(Expr a, Expr b) {
     internal_assert(b.type().is_bool()) << "rhs of Or is not a bool\n";
     internal_assert(a.type() == b.type()) << "Or of mismatched types\n";
 
-    Or *node = new Or;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    node->b = b;
-    return node;
+    return make_binary<Or>(Bool(a.type().lanes()), a, b);
 }
 
 Expr Not::make(Expr a) {
     internal_assert(a.defined()) << "Not of undefined\n";
     internal_assert(a.type().is_bool()) << "argument of Not is not a bool\n";
 
-    Not *node = new Not;
-    node->type = Bool(a.type().lanes());
-    node->a = a;
-    return node;
+    Type t = Bool(a.type().lanes());
+    return hash_consed<Not>(HashConsKey(IRNodeType::Not, t, a.get()),
+                            [&](Not *node) {
+                                node->type = t;
+                                node->a = a;
+                            });
 }
 
 Expr Select::make(Expr condition, Expr true_value, Expr false_value) {
@@ -221,12 +449,14 @@ Expr Select::make(Expr condition, Expr true_value, Expr false_value) {
                     condition.type().lanes() == true_value.type().lanes())
         << "In Select, vector lanes of condition must either be 1, or equal to vector lanes of arguments\n";
 
-    Select *node = new Select;
-    node->type = true_value.type();
-    node->condition = condition;
-    node->true_value = true_value;
-    node->false_value = false_value;
-    return node;
+    Type t = true_value.type();
+    return hash_consed<Select>(HashConsKey(IRNodeType::Select, t, condition.get(), true_value.get(), false_value.get()),
+                               [&](Select *node) {
+                                   node->type = t;
+                                   node->condition = condition;
+                                   node->true_value = true_value;
+                                   node->false_value = false_value;
+                               });
 }
 
 Expr Load::make(Type type, std::string name, Expr index, Buffer image, Parameter param) {
@@ -250,12 +480,14 @@ Expr Ramp::make(Expr base, Expr stride, int lanes) {
     internal_assert(lanes > 1) << "Ramp of lanes <= 1\n";
     internal_assert(stride.type() == base.type()) << "Ramp of mismatched types\n";
 
-    Ramp *node = new Ramp;
-    node->type = base.type().with_lanes(lanes);
-    node->base = base;
-    node->stride = stride;
-    node->lanes = lanes;
-    return node;
+    Type t = base.type().with_lanes(lanes);
+    return hash_consed<Ramp>(HashConsKey(IRNodeType::Ramp, t, base.get(), stride.get(), nullptr, lanes),
+                             [&](Ramp *node) {
+                                 node->type = t;
+                                 node->base = base;
+                                 node->stride = stride;
+                                 node->lanes = lanes;
+                             });
 }
 
 Expr Broadcast::make(Expr value, int lanes) {
@@ -263,11 +495,13 @@ Expr Broadcast::make(Expr value, int lanes) {
     internal_assert(value.type().is_scalar()) << "Broadcast of vector\n";
     internal_assert(lanes != 1) << "Broadcast of lanes 1\n";
 
-    Broadcast *node = new Broadcast;
-    node->type = value.type().with_lanes(lanes);
-    node->value = value;
-    node->lanes = lanes;
-    return node;
+    Type t = value.type().with_lanes(lanes);
+    return hash_consed<Broadcast>(HashConsKey(IRNodeType::Broadcast, t, value.get(), nullptr, nullptr, lanes),
+                                  [&](Broadcast *node) {
+                                      node->type = t;
+                                      node->value = value;
+                                      node->lanes = lanes;
+                                  });
 }
 
 Expr Let::make(std::string name, Expr value, Expr body) {
@@ -527,13 +761,35 @@ Expr Call::make(Type type, std::string name, const std::vector<Expr> &args, Call
 
 Expr Variable::make(Type type, std::string name, Buffer image, Parameter param, ReductionDomain reduction_domain) {
     internal_assert(!name.empty());
+
+    HashConsTable *table = current_hash_cons_table;
+    bool pure = !image.defined() && !param.defined() && !reduction_domain.defined();
+    if (table && pure) {
+        auto iter = table->variables.find(name);
+        if (iter != table->variables.end()) {
+            for (const Expr &v : iter->second) {
+                if (v.type() == type) {
+                    table->hits++;
+                    table->bytes_saved += sizeof(Variable);
+                    return v;
+                }
+            }
+        }
+    }
+
     Variable *node = new Variable;
     node->type = type;
     node->name = name;
     node->image = image;
     node->param = param;
     node->reduction_domain = reduction_domain;
-    return node;
+
+    Expr result = node;
+    if (table && pure) {
+        table->variables[name].push_back(result);
+        table->added();
+    }
+    return result;
 }
 
 template<> void ExprNode<IntImm>::accept(IRVisitor *v) const { v->visit((const IntImm *)this); }
@@ -627,6 +883,7 @@ Call::ConstString Call::mod_round_to_zero = "mod_round_to_zero";
 Call::ConstString Call::slice_vector = "slice_vector";
 Call::ConstString Call::call_cached_indirect_function = "call_cached_indirect_function";
 Call::ConstString Call::signed_integer_overflow = "signed_integer_overflow";
+Call::ConstString Call::lazy_specialization = "lazy_specialization";
 
 }
 }
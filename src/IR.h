@@ -5,6 +5,7 @@
  * Subtypes for Halide expressions (\ref Halide::Expr) and statements (\ref Halide::Internal::Stmt)
  */
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,7 @@
 #include "Function.h"
 #include "IntrusivePtr.h"
 #include "Parameter.h"
+#include "Symbol.h"
 #include "Type.h"
 #include "Util.h"
 
@@ -243,6 +245,12 @@ struct Let : public ExprNode<Let> {
     std::string name;
     Expr value, body;
 
+    /** The interned name, for fast lookups in a Scope. */
+    Symbol symbol() const {
+        return name_symbol.get(name);
+    }
+    CachedSymbol name_symbol;
+
     EXPORT static Expr make(std::string name, Expr value, Expr body);
 
     static const IRNodeType _type_info = IRNodeType::Let;
@@ -255,6 +263,12 @@ struct LetStmt : public StmtNode<LetStmt> {
     Expr value;
     Stmt body;
 
+    /** The interned name, for fast lookups in a Scope. */
+    Symbol symbol() const {
+        return name_symbol.get(name);
+    }
+    CachedSymbol name_symbol;
+
     EXPORT static Stmt make(std::string name, Expr value, Stmt body);
 
     static const IRNodeType _type_info = IRNodeType::LetStmt;
@@ -498,7 +512,8 @@ struct Call : public ExprNode<Call> {
         mod_round_to_zero,
         slice_vector,
         call_cached_indirect_function,
-        signed_integer_overflow;
+        signed_integer_overflow,
+        lazy_specialization;
 
     // If it's a call to another halide function, this call node holds
     // onto a pointer to that function for the purposes of reference
@@ -580,6 +595,12 @@ struct Variable : public ExprNode<Variable> {
     /** Reduction variables hang onto their domains */
     ReductionDomain reduction_domain;
 
+    /** The interned name, for fast lookups in a Scope. */
+    Symbol symbol() const {
+        return name_symbol.get(name);
+    }
+    CachedSymbol name_symbol;
+
     static Expr make(Type type, std::string name) {
         return make(type, name, Buffer(), Parameter(), ReductionDomain());
     }
@@ -620,11 +641,41 @@ struct For : public StmtNode<For> {
     DeviceAPI device_api;
     Stmt body;
 
+    /** The interned name, for fast lookups in a Scope. */
+    Symbol symbol() const {
+        return name_symbol.get(name);
+    }
+    CachedSymbol name_symbol;
+
     EXPORT static Stmt make(std::string name, Expr min, Expr extent, ForType for_type, DeviceAPI device_api, Stmt body);
 
     static const IRNodeType _type_info = IRNodeType::For;
 };
 
+struct HashConsTable;
+
+/** While one of these exists, the Exprs for constants, casts,
+ * arithmetic, comparisons, selects, ramps, broadcasts and plain
+ * Variables made on the same thread are hash-consed: making a node
+ * equal to one that is still alive returns the existing node instead
+ * of allocating another. Equal subexpressions built by different
+ * passes then share their storage, and are the same_as each
+ * other. Calls, Loads and Lets are always made afresh. lower() holds
+ * one for the duration of lowering unless the target has the
+ * no_hash_consing feature. A disabled one turns off the hash-consing
+ * of any enclosing one. */
+struct ScopedHashConsing {
+    EXPORT ScopedHashConsing(bool enabled = true);
+    EXPORT ~ScopedHashConsing();
+
+private:
+    std::unique_ptr<HashConsTable> table;
+    HashConsTable *previous;
+
+    ScopedHashConsing(const ScopedHashConsing &);
+    ScopedHashConsing &operator=(const ScopedHashConsing &);
+};
+
 }
 }
 
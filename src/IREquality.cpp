@@ -534,6 +534,37 @@ void ir_equality_test() {
     e2 = e2*e2 + e2;
     check_not_equal(e1, e2);
 
+    // Common constants are shared, so comparing them doesn't need to
+    // look inside the nodes.
+    internal_assert(make_const(Int(32), 3).same_as(make_const(Int(32), 3)) &&
+                    const_true().same_as(const_true()))
+        << "Small constants should be shared\n";
+    check_equal(make_const(Int(32), 100), make_const(Int(32), 100));
+    check_not_equal(make_const(Int(32), 3), make_const(Int(16), 3));
+
+    // While hash-consing, equal expressions are the same node, even
+    // after the table has been swept many times.
+    {
+        ScopedHashConsing hash_consing;
+        Expr x = Variable::make(Int(32), "x");
+        Expr a = Select::make(x < 7, Ramp::make(x * 3, 2, 4), Broadcast::make(x, 4));
+        for (int i = 0; i < 100000; i++) {
+            Expr unused = x + i;
+        }
+        Expr b = Select::make(Variable::make(Int(32), "x") < 7,
+                              Ramp::make(Variable::make(Int(32), "x") * 3, 2, 4),
+                              Broadcast::make(Variable::make(Int(32), "x"), 4));
+        internal_assert(a.same_as(b)) << "Equal expressions should be shared\n";
+        internal_assert(!make_const(Float(32), 0.0f).same_as(make_const(Float(32), -0.0f)))
+            << "0 and -0 should not be shared\n";
+        internal_assert(!Variable::make(Int(32), "x").same_as(Variable::make(Int(16), "x")))
+            << "Variables of different types should not be shared\n";
+
+        ScopedHashConsing disabled(false);
+        internal_assert(!(x + 1).same_as(x + 1))
+            << "Expressions should not be shared with hash-consing disabled\n";
+    }
+
     debug(0) << "ir_equality_test passed\n";
 }
 
@@ -600,46 +600,73 @@ void split_into_ands(Expr cond, std::vector<Expr> &result) {
 
 }
 
-Expr fast_log(Expr x) {
+Expr fast_log(Expr x, ApproximationPrecision precision) {
     user_assert(x.type() == Float(32)) << "fast_log only works for Float(32)";
 
+    if (precision == ApproximationPrecision::High) {
+        return Internal::halide_log(x);
+    }
+
     Expr reduced, exponent;
     range_reduce_log(x, &reduced, &exponent);
 
     Expr x1 = reduced - 1.0f;
 
-    float coeff[] = {
-        0.07640318789187280912f,
-        -0.16252961013874300811f,
-        0.20625219040645212387f,
-        -0.25110261010892864775f,
-        0.33320464908377461777f,
-        -0.49997513376789826101f,
-        1.0f,
-        0.0f};
-
-    Expr result = evaluate_polynomial(x1, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    Expr result;
+    if (precision == ApproximationPrecision::Low) {
+        float coeff[] = {
+            0.25920272323450321839f,
+            -0.51369922444803028938f,
+            1.00402065340945112482f,
+            0.0f};
+        result = evaluate_polynomial(x1, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else {
+        float coeff[] = {
+            0.07640318789187280912f,
+            -0.16252961013874300811f,
+            0.20625219040645212387f,
+            -0.25110261010892864775f,
+            0.33320464908377461777f,
+            -0.49997513376789826101f,
+            1.0f,
+            0.0f};
+        result = evaluate_polynomial(x1, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    }
     result = result + cast<float>(exponent) * logf(2);
     result = common_subexpression_elimination(result);
     return result;
 }
 
-Expr fast_exp(Expr x_full) {
+Expr fast_exp(Expr x_full, ApproximationPrecision precision) {
     user_assert(x_full.type() == Float(32)) << "fast_exp only works for Float(32)";
 
+    if (precision == ApproximationPrecision::High) {
+        return Internal::halide_exp(x_full);
+    }
+
     Expr scaled = x_full / logf(2.0);
     Expr k_real = floor(scaled);
     Expr k = cast<int>(k_real);
     Expr x = x_full - k_real * logf(2.0);
 
-    float coeff[] = {
-        0.01314350012789660196f,
-        0.03668965196652099192f,
-        0.16873890085469545053f,
-        0.49970514590562437052f,
-        1.0f,
-        1.0f};
-    Expr result = evaluate_polynomial(x, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    Expr result;
+    if (precision == ApproximationPrecision::Low) {
+        float coeff[] = {
+            0.23428953974544142191f,
+            0.47052927556492241123f,
+            1.00387589084311423804f,
+            0.99992517232130928573f};
+        result = evaluate_polynomial(x, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else {
+        float coeff[] = {
+            0.01314350012789660196f,
+            0.03668965196652099192f,
+            0.16873890085469545053f,
+            0.49970514590562437052f,
+            1.0f,
+            1.0f};
+        result = evaluate_polynomial(x, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    }
 
     // Compute 2^k.
     int fpbias = 127;
@@ -653,6 +680,190 @@ Expr fast_exp(Expr x_full) {
     return result;
 }
 
+// The polynomials for the trigonometric and hyperbolic functions below
+// are near-minimax fits of the absolute error, with the lowest degree
+// that meets the bound of each precision, including the rounding
+// error of evaluating them in single precision.
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+// sin(x)/x and cos(x) as polynomials in x^2, for x in [-pi/4, pi/4].
+Expr sin_over_x_reduced(Expr x2, ApproximationPrecision precision) {
+    if (precision == ApproximationPrecision::Low) {
+        float coeff[] = {
+            -0.16034471537171401945f,
+            0.99903163838047692735f};
+        return evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else if (precision == ApproximationPrecision::Medium) {
+        float coeff[] = {
+            0.00812156763342550617f,
+            -0.16660162586357113446f,
+            0.99999499824450932550f};
+        return evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else {
+        float coeff[] = {
+            -0.00019462124488877901f,
+            0.00833158467556351784f,
+            -0.16666636756054167834f,
+            0.99999998618038632436f};
+        return evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    }
+}
+
+Expr cos_reduced(Expr x2, ApproximationPrecision precision) {
+    if (precision == ApproximationPrecision::Low) {
+        float coeff[] = {
+            0.04039853598203873436f,
+            -0.49970811313623342276f,
+            0.99999002657131774718f};
+        return evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else {
+        float coeff[] = {
+            -0.00135859085127176793f,
+            0.04165502660328724432f,
+            -0.49999856678517395903f,
+            0.99999997240350768646f};
+        return evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    }
+}
+
+// atan(x) for x in [0, 1].
+Expr atan_reduced(Expr x, ApproximationPrecision precision) {
+    Expr x2 = x * x;
+    if (precision == ApproximationPrecision::Low) {
+        float coeff[] = {
+            0.07934214448965386246f,
+            -0.28869321748404119798f,
+            0.99535846911713887764f};
+        return x * evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else if (precision == ApproximationPrecision::Medium) {
+        float coeff[] = {
+            -0.01171915899963930745f,
+            0.05264740257094283754f,
+            -0.11642651907934938038f,
+            0.19354038553982136350f,
+            -0.33262282819042188198f,
+            0.99997721901011193957f};
+        return x * evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else {
+        float coeff[] = {
+            -0.00405452507548277868f,
+            0.02186280945081288396f,
+            -0.05591211811606007498f,
+            0.09642182418948892775f,
+            -0.13908623851512844083f,
+            0.19946564532642366285f,
+            -0.33329860687044121637f,
+            0.99999933555342335190f};
+        return x * evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    }
+}
+
+// tanh(x) for x in [-0.625, 0.625].
+Expr tanh_reduced(Expr x, ApproximationPrecision precision) {
+    Expr x2 = x * x;
+    if (precision == ApproximationPrecision::Low) {
+        float coeff[] = {
+            -0.27793118726564286503f,
+            0.99494373180328110617f};
+        return x * evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else if (precision == ApproximationPrecision::Medium) {
+        float coeff[] = {
+            -0.03864466446443375058f,
+            0.12920470799737671097f,
+            -0.33290584290458230532f,
+            0.99998790582579888397f};
+        return x * evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    } else {
+        float coeff[] = {
+            0.01453011158274704166f,
+            -0.05136290158502655051f,
+            0.13291032434999791589f,
+            -0.33330482820715456871f,
+            0.99999945877350671086f};
+        return x * evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0]));
+    }
+}
+
+Expr fast_sin_cos(Expr x_full, bool is_cos, ApproximationPrecision precision) {
+    // Reduce the argument to [-pi/4, pi/4] by subtracting a multiple
+    // k of pi/2, which is split into three parts so that the
+    // products with k are exact for |k| < 2^13.
+    Expr k_real = floor(x_full * (float)(2 / pi) + 0.5f);
+    Expr x = x_full - k_real * 1.5703125f;
+    x -= k_real * 4.837512969970703125e-4f;
+    x -= k_real * 7.54978995489188216e-8f;
+
+    // The quadrant selects between sin and cos of the reduced
+    // argument and their negations. cos(x) is sin(x + pi/2).
+    Expr quadrant = cast<int>(k_real);
+    if (is_cos) {
+        quadrant += 1;
+    }
+    Expr x2 = x * x;
+    Expr result = select((quadrant & 1) == 0,
+                         x * sin_over_x_reduced(x2, precision),
+                         cos_reduced(x2, precision));
+    result = select((quadrant & 2) == 0, result, -result);
+    return common_subexpression_elimination(result);
+}
+
+}
+
+Expr fast_sin(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_sin only works for Float(32)";
+    return fast_sin_cos(x, false, precision);
+}
+
+Expr fast_cos(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_cos only works for Float(32)";
+    return fast_sin_cos(x, true, precision);
+}
+
+Expr fast_atan(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_atan only works for Float(32)";
+
+    // Use atan(x) = pi/2 - atan(1/x) to reduce the argument to [0, 1].
+    Expr a = abs(x);
+    Expr result = atan_reduced(min(a, 1.0f) / max(a, 1.0f), precision);
+    result = select(a > 1.0f, (float)(pi / 2) - result, result);
+    result = select(x < 0.0f, -result, result);
+    return common_subexpression_elimination(result);
+}
+
+Expr fast_atan2(Expr y, Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32) && y.type() == Float(32))
+        << "fast_atan2 only works for Float(32)";
+
+    // Find the angle in the first octant, and then reflect it into
+    // the right octant.
+    Expr ax = abs(x), ay = abs(y);
+    Expr lo = min(ax, ay), hi = max(ax, ay);
+    Expr result = atan_reduced(lo / select(hi == 0.0f, 1.0f, hi), precision);
+    result = select(ay > ax, (float)(pi / 2) - result, result);
+
+    // Use the sign bits, so that signed zeros behave as they do for
+    // atan2.
+    Type int_type = Int(32, x.type().lanes());
+    result = select(reinterpret(int_type, x) < 0, (float)pi - result, result);
+    result = select(reinterpret(int_type, y) < 0, -result, result);
+    return common_subexpression_elimination(result);
+}
+
+Expr fast_tanh(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_tanh only works for Float(32)";
+
+    // For larger |x|, use tanh(x) = 1 - 2/(e^2x + 1). tanh(10) is
+    // one in single precision, so clamping to 10 avoids overflow.
+    Expr a = abs(x);
+    Expr e = fast_exp(2.0f * min(a, 10.0f), precision);
+    Expr large = 1.0f - 2.0f / (e + 1.0f);
+    large = select(x < 0.0f, -large, large);
+    Expr result = select(a < 0.625f, tanh_reduced(x, precision), large);
+    return common_subexpression_elimination(result);
+}
+
 Expr print(const std::vector<Expr> &args) {
     // Insert spaces between each expr.
     std::vector<Expr> print_args(args.size()*2);
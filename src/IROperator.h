@@ -1250,31 +1250,79 @@ inline Expr erf(Expr x) {
     return Internal::halide_erf(x);
 }
 
+/** The accuracy tiers of the fast approximate transcendentals
+ * below. Each tier is a bound on the maximum error over the
+ * documented input range. The bound is on the relative error for
+ * fast_exp, and on the error divided by max(1, |result|) for the
+ * others, which is the absolute error for the functions with bounded
+ * results. The lower tiers use lower degree polynomials, which are
+ * cheaper. */
+enum class ApproximationPrecision {
+    /** Maximum error of 1e-3, which is enough for 8-bit images. */
+    Low,
+    /** Maximum error of 1e-5. */
+    Medium,
+    /** Maximum error of 5e-7, which is a few ULP for results of
+     * magnitude near one. */
+    High
+};
+
 /** Fast approximate cleanly vectorizable log for Float(32). Returns
- * nonsense for x <= 0.0f. Accurate up to the last 5 bits of the
- * mantissa. Vectorizes cleanly. */
-EXPORT Expr fast_log(Expr x);
+ * nonsense for x <= 0.0f, except with ApproximationPrecision::High,
+ * which is the same as log. The default precision is accurate up to
+ * the last 5 bits of the mantissa. Vectorizes cleanly. */
+EXPORT Expr fast_log(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
 
 /** Fast approximate cleanly vectorizable exp for Float(32). Returns
- * nonsense for inputs that would overflow or underflow. Typically
- * accurate up to the last 5 bits of the mantissa. Gets worse when
- * approaching overflow. Vectorizes cleanly. */
-EXPORT Expr fast_exp(Expr x);
+ * nonsense for inputs that would overflow or underflow, except with
+ * ApproximationPrecision::High, which is the same as exp. The default
+ * precision is typically accurate up to the last 5 bits of the
+ * mantissa. Gets worse when approaching overflow. Vectorizes
+ * cleanly. */
+EXPORT Expr fast_exp(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
 
 /** Fast approximate cleanly vectorizable pow for Float(32). Returns
  * nonsense for x < 0.0f. Accurate up to the last 5 bits of the
- * mantissa for typical exponents. Gets worse when approaching
- * overflow. Vectorizes cleanly. */
-inline Expr fast_pow(Expr x, Expr y) {
+ * mantissa for typical exponents at the default precision. The error
+ * of the other tiers is that of fast_log, scaled by y, and then that
+ * of fast_exp. Gets worse when approaching overflow. Vectorizes
+ * cleanly. */
+inline Expr fast_pow(Expr x, Expr y, ApproximationPrecision precision = ApproximationPrecision::Medium) {
     if (const int64_t *i = as_const_int(y)) {
         return raise_to_integer_power(x, *i);
     }
 
     x = cast<float>(x);
     y = cast<float>(y);
-    return select(x == 0.0f, 0.0f, fast_exp(fast_log(x) * y));
+    return select(x == 0.0f, 0.0f, fast_exp(fast_log(x, precision) * y, precision));
 }
 
+/** Fast approximate cleanly vectorizable sine and cosine for
+ * Float(32). The argument is reduced to [-pi/4, pi/4] and then
+ * approximated by a polynomial, so unlike sin and cos these don't
+ * call the math library. The error bound of the precision holds for
+ * |x| < 10^4, and grows with |x| beyond that. Vectorizes cleanly. */
+// @{
+EXPORT Expr fast_sin(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+EXPORT Expr fast_cos(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+// @}
+
+/** Fast approximate cleanly vectorizable arctangent for
+ * Float(32). fast_atan2 returns the angle of the point (x, y) in
+ * [-pi, pi], with the same signs as atan2 for signed zeros. The
+ * error bound of the precision holds for all finite inputs.
+ * Vectorizes cleanly. */
+// @{
+EXPORT Expr fast_atan(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+EXPORT Expr fast_atan2(Expr y, Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+// @}
+
+/** Fast approximate cleanly vectorizable hyperbolic tangent for
+ * Float(32), made from a polynomial for small |x| and from fast_exp
+ * of the same precision otherwise. The error bound of the precision
+ * holds for all finite inputs. Vectorizes cleanly. */
+EXPORT Expr fast_tanh(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
 /** Fast approximate inverse for Float(32). Corresponds to the rcpps
  * instruction on x86, and the vrecpe instruction on ARM. Vectorizes
  * cleanly. */
@@ -1715,7 +1763,11 @@ inline Expr mod_round_to_zero(Expr x, Expr y) {
  * deterministically on the pure variables of the function they belong
  * to, the identity of the function itself, and which definition of
  * the function it is used in. They are, however, shared across tuple
- * elements.
+ * elements. The values don't depend on the schedule.
+ *
+ * The values come from a Philox-2x32-10 counter-based generator, in
+ * which the seed and the identity of the random variable select an
+ * independent stream, and the pure variables index into it.
  *
  * This function vectorizes cleanly.
  */
@@ -1765,6 +1817,28 @@ inline Expr random_int(Expr seed = Expr()) {
     return cast<int32_t>(random_uint(seed));
 }
 
+/** Return a random variable representing a normally distributed
+ * float with mean zero and variance one, made from two independent
+ * uniform random variables with the Box-Muller transform. The log and
+ * cosine are computed with fast_log and fast_cos, which are accurate
+ * to about 1e-5, rather than with the math library. See \ref
+ * random_float. Vectorizes cleanly. */
+inline Expr random_normal(Expr seed = Expr()) {
+    // 1 - u is in (0, 1], so the log is finite. The approximate log of
+    // numbers near one may have the wrong sign, so clamp it.
+    Expr u1 = 1.0f - random_float(seed);
+    Expr u2 = random_float(seed);
+    return sqrt(max(-2.0f * fast_log(u1), 0.0f)) * fast_cos(2.0f * 3.14159265f * u2);
+}
+
+/** Return a random variable representing an exponentially
+ * distributed float with rate one (and so mean one). The log is
+ * computed with fast_log. See \ref random_float. Vectorizes
+ * cleanly. */
+inline Expr random_exponential(Expr seed = Expr()) {
+    return max(-fast_log(1.0f - random_float(seed)), 0.0f);
+}
+
 // Secondary args to print can be Exprs or const char *
 namespace Internal {
 inline NO_INLINE void collect_print_args(std::vector<Expr> &args) {
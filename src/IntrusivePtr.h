@@ -23,6 +23,7 @@ public:
     int increment() {return ++count;} // Increment and return new value
     int decrement() {return --count;} // Decrement and return new value
     bool is_zero() const {return count == 0;}
+    bool is_one() const {return count == 1;} // True if there's a single reference
 };
 
 /**
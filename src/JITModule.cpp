@@ -1,7 +1,12 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <string>
 #include <stdint.h>
 #include <mutex>
 #include <set>
+#include <thread>
 
 #include "CodeGen_Internal.h"
 #include "JITModule.h"
@@ -112,12 +117,87 @@ void load_metal() {
 
 using namespace llvm;
 
+namespace {
+
+// The background recompiles of tiered modules run one at a time, in
+// the order they were asked for, on a single worker thread. The
+// worker is started by the first tiered compile, so it's destroyed
+// at exit before LLVM's static objects are. Its destructor lets the
+// recompile in progress finish, drops the queued ones, and joins the
+// worker.
+class TieredCompiler {
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::function<void()>> jobs;
+    bool stopping;
+    std::thread worker;
+
+    void run() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    TieredCompiler() : stopping(false), worker([this]() { run(); }) {}
+
+public:
+    ~TieredCompiler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        worker.join();
+    }
+
+    void enqueue(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wakeup.notify_one();
+    }
+
+    static TieredCompiler &get() {
+        static TieredCompiler compiler;
+        return compiler;
+    }
+};
+
+}
+
+// A function that gets compiled the first time it's called. See
+// JITModule::add_lazy_function.
+struct LazyFunction {
+    LoweredFunc fn;
+    Target target;
+    std::vector<JITModule> dependencies;
+
+    std::mutex mutex;
+    JITModule compiled;
+    std::atomic<bool> ready;
+
+    LazyFunction(const LoweredFunc &fn, const Target &target, const std::vector<JITModule> &dependencies) :
+        fn(fn), target(target), dependencies(dependencies), ready(false) {}
+};
+
 class JITModuleContents {
 public:
     mutable RefCount ref_count;
 
     // Just construct a module with symbols to import into other modules.
-    JITModuleContents() : execution_engine(nullptr) {
+    JITModuleContents() : execution_engine(nullptr),
+                          current_entrypoint(nullptr), current_argv_entrypoint(nullptr) {
     }
 
     ~JITModuleContents() {
@@ -135,6 +215,18 @@ public:
     JITModule::Symbol argv_entrypoint;
 
     std::string name;
+
+    // The addresses of the entrypoints to use. For a tiered compile
+    // these are replaced with those of the optimized module once it's
+    // ready.
+    std::atomic<void *> current_entrypoint, current_argv_entrypoint;
+
+    // For a tiered compile, the optimized version, once it's ready.
+    JITModule optimized;
+
+    // Functions registered with add_lazy_function, which generated
+    // code refers to directly.
+    std::vector<std::unique_ptr<LazyFunction>> lazy_functions;
 };
 
 template <>
@@ -214,6 +306,50 @@ JITModule::JITModule(const Module &m, const LoweredFunc &fn,
     std::vector<JITModule> shared_runtime = JITSharedRuntime::get(llvm_module.get(), m.target());
     deps_with_runtime.insert(deps_with_runtime.end(), shared_runtime.begin(), shared_runtime.end());
     compile_module(std::move(llvm_module), fn.name, m.target(), deps_with_runtime);
+
+    if (m.target().has_feature(Target::JIT) &&
+        m.target().has_feature(Target::TieredJIT)) {
+        // What we just compiled was the quick first tier. Compile it
+        // again with full optimization in the background, and switch
+        // over to that when it's done.
+        Module full(m.name(), m.target().without_feature(Target::TieredJIT));
+        for (const Buffer &buf : m.buffers()) {
+            full.append(buf);
+        }
+        for (const LoweredFunc &f : m.functions()) {
+            full.append(f);
+        }
+        // The recompile holds a reference to the contents. If it ends
+        // up holding the last one, nobody can call the result, so it's
+        // dropped.
+        IntrusivePtr<JITModuleContents> contents = jit_module;
+        TieredCompiler::get().enqueue([contents, full, fn, dependencies]() {
+            if (ref_count(contents.get()).is_one()) {
+                return;
+            }
+            debug(1) << "Recompiling " << fn.name << " with full optimization\n";
+            JITModule optimized;
+            #ifdef WITH_EXCEPTIONS
+            // If this fails we just keep using the first tier.
+            try {
+            #endif
+                optimized = JITModule(full, fn, dependencies);
+            #ifdef WITH_EXCEPTIONS
+            } catch (const Halide::Error &e) {
+                debug(1) << "Optimized recompile of " << fn.name << " failed: " << e.what() << "\n";
+                return;
+            }
+            #endif
+            if (ref_count(contents.get()).is_one()) {
+                debug(1) << "Dropping the optimized version of " << fn.name << ", which is no longer used\n";
+                return;
+            }
+            contents->optimized = optimized;
+            contents->current_entrypoint.store(optimized.main_function(), std::memory_order_release);
+            contents->current_argv_entrypoint.store((void *)optimized.argv_function(), std::memory_order_release);
+            debug(1) << "Switched " << fn.name << " to the optimized version\n";
+        });
+    }
 }
 
 void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &function_name, const Target &target,
@@ -254,7 +390,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     engine_builder.setMCJITMemoryManager(std::unique_ptr<RTDyldMemoryManager>(new HalideJITMemoryManager(dependencies)));
     #endif
 
-    engine_builder.setOptLevel(CodeGenOpt::Aggressive);
+    engine_builder.setOptLevel(target.has_feature(Target::TieredJIT) ? CodeGenOpt::Less : CodeGenOpt::Aggressive);
     engine_builder.setMCPU(mcpu);
     std::vector<string> mattrs_array = {mattrs};
     engine_builder.setMAttrs(mattrs_array);
@@ -350,6 +486,8 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     jit_module->dependencies = dependencies;
     jit_module->entrypoint = entrypoint;
     jit_module->argv_entrypoint = argv_entrypoint;
+    jit_module->current_entrypoint = entrypoint.address;
+    jit_module->current_argv_entrypoint = argv_entrypoint.address;
     jit_module->name = function_name;
 }
 
@@ -370,19 +508,19 @@ JITModule::Symbol JITModule::find_symbol_by_name(const std::string &name) const
 }
 
 void *JITModule::main_function() const {
-    return jit_module->entrypoint.address;
+    return jit_module->current_entrypoint.load(std::memory_order_acquire);
 }
 
 JITModule::Symbol JITModule::entrypoint_symbol() const {
-    return jit_module->entrypoint;
+    return Symbol(main_function(), jit_module->entrypoint.llvm_type);
 }
 
 int (*JITModule::argv_function() const)(const void **) {
-    return (int (*)(const void **))jit_module->argv_entrypoint.address;
+    return (int (*)(const void **))jit_module->current_argv_entrypoint.load(std::memory_order_acquire);
 }
 
 JITModule::Symbol JITModule::argv_entrypoint_symbol() const {
-    return jit_module->argv_entrypoint;
+    return Symbol((void *)argv_function(), jit_module->argv_entrypoint.llvm_type);
 }
 
 static bool module_already_in_graph(const JITModuleContents *start, const JITModuleContents *target, std::set <const JITModuleContents *> &already_seen) {
@@ -445,6 +583,64 @@ void JITModule::add_extern_for_export(const std::string &name, const ExternSigna
     jit_module->exports[name] = symbol;
 }
 
+namespace {
+
+// Called by generated code to run a function registered with
+// add_lazy_function. The first call compiles it; later calls just
+// load the cached entry point.
+int lazy_call(void *user_context, void *handle, const void *args) {
+    LazyFunction *f = (LazyFunction *)handle;
+    if (!f->ready.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(f->mutex);
+        if (!f->ready.load(std::memory_order_relaxed)) {
+            debug(1) << "Compiling " << f->fn.name << " on first use\n";
+            #ifdef WITH_EXCEPTIONS
+            // Errors must not unwind through the generated code that
+            // called us, so report them with a return value instead.
+            try {
+            #endif
+                Module m(f->fn.name, f->target);
+                m.append(f->fn);
+                f->compiled = JITModule(m, f->fn, f->dependencies);
+            #ifdef WITH_EXCEPTIONS
+            } catch (const Halide::Error &e) {
+                debug(0) << "Failed to compile " << f->fn.name << ": " << e.what() << "\n";
+                return halide_error_code_generic_error;
+            }
+            #endif
+            f->ready.store(true, std::memory_order_release);
+        }
+    }
+    // Look up the entry point every time, as a tiered compile may
+    // have replaced it.
+    auto entrypoint = reinterpret_bits<int (*)(void *, const void *)>(f->compiled.main_function());
+    return entrypoint(user_context, args);
+}
+
+}
+
+void *JITModule::add_lazy_function(const LoweredFunc &fn, const Target &target,
+                                   const std::vector<JITModule> &dependencies) {
+    ExternSignature signature;
+    signature.ret_type = Int(32);
+    ScalarOrBufferT handle_arg;
+    handle_arg.scalar_type = Handle();
+    signature.arg_types = {handle_arg, handle_arg, handle_arg};
+    void *address = reinterpret_bits<void *>(&lazy_call);
+
+    // The function may contain lazy calls of its own. It gets
+    // halide_jit_lazy_call from a separate module, rather than
+    // depending on this one, which owns it.
+    JITModule lazy_call_module;
+    lazy_call_module.add_extern_for_export("halide_jit_lazy_call", signature, address);
+    std::vector<JITModule> deps = dependencies;
+    deps.push_back(lazy_call_module);
+
+    add_extern_for_export("halide_jit_lazy_call", signature, address);
+    jit_module->lazy_functions.emplace_back(new LazyFunction(fn, target, deps));
+    return jit_module->lazy_functions.back().get();
+}
+
 void JITModule::memoization_cache_set_size(int64_t size) const {
     std::map<std::string, Symbol>::const_iterator f =
         exports().find("halide_memoization_cache_set_size");
@@ -617,6 +813,8 @@ JITModule &make_module(llvm::Module *for_module, Target target,
         // Ensure that JIT feature is set on target as it must be in
         // order for the right runtime components to be added.
         target.set_feature(Target::JIT);
+        // The runtime is shared by everything, so always optimize it fully.
+        target.set_feature(Target::TieredJIT, false);
 
         Target one_gpu(target);
         one_gpu.set_feature(Target::OpenCL, false);
@@ -118,6 +118,16 @@ struct JITModule {
     EXPORT void add_extern_for_export(const std::string &name,
                                       const ExternSignature &signature, void *address);
 
+    /** Registers a function to be compiled the first time it is
+     * called, and exports halide_jit_lazy_call, which calls such
+     * functions, to modules which depend on this one. The function
+     * must take a user context and a pointer to its arguments, as
+     * built by outline_lazy_specializations. Returns the handle to
+     * pass to halide_jit_lazy_call. The compiled code is released
+     * along with this module. */
+    EXPORT void *add_lazy_function(const LoweredFunc &fn, const Target &target,
+                                   const std::vector<JITModule> &dependencies);
+
     /** Look up a symbol by name in this module or its dependencies. */
     EXPORT Symbol find_symbol_by_name(const std::string &) const;
 
@@ -0,0 +1,178 @@
+#include "LazySpecializations.h"
+#include "Closure.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+bool is_lazy_marker(Stmt s) {
+    const Evaluate *e = s.as<Evaluate>();
+    const Call *c = e ? e->value.as<Call>() : nullptr;
+    return c && c->is_intrinsic(Call::lazy_specialization);
+}
+
+// Device code must be compiled along with the host code that
+// launches it, so branches that contain any stay where they are.
+class UsesDevice : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool result = false;
+};
+
+// Convert a scalar to 64 bits, preserving its bit pattern, and back.
+Expr pack(Expr e) {
+    Type t = e.type();
+    if (t.is_handle()) {
+        return reinterpret(UInt(64), e);
+    }
+    if (t.is_float()) {
+        e = reinterpret(UInt(t.bits()), e);
+    }
+    return cast(UInt(64), e);
+}
+
+Expr unpack(Type t, Expr e) {
+    if (t.is_handle()) {
+        return reinterpret(t, e);
+    }
+    if (t.is_float()) {
+        return reinterpret(t, cast(UInt(t.bits()), e));
+    }
+    return cast(t, e);
+}
+
+class OutlineLazySpecializations : public IRMutator {
+    vector<LoweredFunc> &outlined;
+
+    using IRMutator::visit;
+
+    // Replace a (mutated) branch with a call to a new function that
+    // computes it, if possible.
+    Stmt outline(Stmt body) {
+        UsesDevice device;
+        body.accept(&device);
+        if (device.result) {
+            return body;
+        }
+
+        string name = unique_name("lazy_specialization");
+        string args_name = name + ".args";
+
+        Closure closure(body);
+        vector<Expr> packed;
+        vector<std::pair<string, Expr>> unpacked;
+        auto add_arg = [&](const string &n, Type t) {
+            Expr field = Load::make(UInt(64), args_name, (int)packed.size(), Buffer(), Parameter());
+            packed.push_back(pack(Variable::make(t, n)));
+            unpacked.push_back({n, unpack(t, field)});
+        };
+        for (const auto &v : closure.vars) {
+            if (v.second.is_vector()) {
+                return body;
+            }
+            if (v.first != "__user_context") {
+                add_arg(v.first, v.second);
+            }
+        }
+        for (const auto &b : closure.buffers) {
+            string host = b.first + ".host";
+            if (!closure.vars.count(host)) {
+                add_arg(host, Handle());
+            }
+        }
+        if (packed.empty()) {
+            // make_struct needs at least one field.
+            packed.push_back(make_zero(UInt(64)));
+        }
+
+        Stmt fn_body = body;
+        for (size_t i = unpacked.size(); i > 0; i--) {
+            fn_body = LetStmt::make(unpacked[i-1].first, unpacked[i-1].second, fn_body);
+        }
+        vector<LoweredArgument> args = {
+            LoweredArgument("__user_context", Argument::InputScalar, Handle(), 0),
+            LoweredArgument(args_name + ".host", Argument::InputScalar, Handle(), 0)
+        };
+        outlined.push_back(LoweredFunc(name, args, fn_body, LoweredFunc::External));
+        debug(3) << "Outlined lazy specialization " << name << ":\n" << fn_body << "\n";
+
+        vector<Expr> call_args = {
+            Variable::make(Handle(), "__user_context"),
+            Variable::make(Handle(), name),
+            Call::make(Handle(), Call::make_struct, packed, Call::Intrinsic)
+        };
+        Expr call = Call::make(Int(32), "halide_jit_lazy_call", call_args, Call::Extern);
+        string result_name = unique_name('t');
+        Expr result = Variable::make(Int(32), result_name);
+        return LetStmt::make(result_name, call, AssertStmt::make(result == 0, result));
+    }
+
+    Stmt mutate_branch(Stmt s) {
+        const Block *b = s.as<Block>();
+        if (b && is_lazy_marker(b->first)) {
+            // Do the nested specializations first, so that they end
+            // up in functions of their own.
+            return outline(mutate(b->rest));
+        }
+        return mutate(s);
+    }
+
+    void visit(const IfThenElse *op) {
+        Expr condition = mutate(op->condition);
+        Stmt then_case = mutate_branch(op->then_case);
+        Stmt else_case = op->else_case.defined() ? mutate_branch(op->else_case) : op->else_case;
+        if (condition.same_as(op->condition) &&
+            then_case.same_as(op->then_case) &&
+            else_case.same_as(op->else_case)) {
+            stmt = op;
+        } else {
+            stmt = IfThenElse::make(condition, then_case, else_case);
+        }
+    }
+
+    void visit(const Block *op) {
+        // A marker that isn't at the start of a branch (e.g. because
+        // the if was simplified away) is dropped.
+        if (is_lazy_marker(op->first)) {
+            stmt = mutate(op->rest);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Evaluate *op) {
+        if (is_lazy_marker(op)) {
+            stmt = Evaluate::make(0);
+        } else {
+            stmt = op;
+        }
+    }
+
+public:
+    OutlineLazySpecializations(vector<LoweredFunc> &o) : outlined(o) {}
+};
+
+}
+
+Stmt outline_lazy_specializations(Stmt s, vector<LoweredFunc> &outlined) {
+    return OutlineLazySpecializations(outlined).mutate(s);
+}
+
+}
+}
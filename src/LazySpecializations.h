@@ -0,0 +1,32 @@
+#ifndef HALIDE_LAZY_SPECIALIZATIONS_H
+#define HALIDE_LAZY_SPECIALIZATIONS_H
+
+/** \file
+ * Defines the pass that moves specialized code paths into their own
+ * functions, so that the JIT can defer compiling them until they are
+ * first used.
+ */
+
+#include "IR.h"
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Replace each branch of an if statement that begins with a
+ * lazy_specialization marker (see build_provide_loop_nest) with a
+ * call to halide_jit_lazy_call, and append a function that computes
+ * the branch to outlined. The call passes the user context, a handle
+ * to the outlined function held in a variable with the same name as
+ * the function, and a pointer to an array of 64-bit values containing
+ * every scalar and buffer host pointer the branch uses. Binding the
+ * handles is left to the caller. The outlined functions take the user
+ * context and the argument array, and return zero on success. Branches
+ * that contain device loops or use vector values are left in place,
+ * and all remaining markers are removed. */
+Stmt outline_lazy_specializations(Stmt s, std::vector<LoweredFunc> &outlined);
+
+}
+}
+
+#endif
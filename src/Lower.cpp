@@ -20,6 +20,7 @@
 #include "Function.h"
 #include "FuseGPUThreadLoops.h"
 #include "HexagonOffload.h"
+#include "HoistLoopInvariants.h"
 #include "InjectHostDevBufferCopies.h"
 #include "InjectImageIntrinsics.h"
 #include "InjectOpenGLIntrinsics.h"
@@ -29,6 +30,7 @@
 #include "IRPrinter.h"
 #include "LoopCarry.h"
 #include "Memoization.h"
+#include "MemoryPlanning.h"
 #include "PartitionLoops.h"
 #include "Profiling.h"
 #include "Qualify.h"
@@ -65,6 +67,16 @@ using std::map;
 
 Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &t, const vector<IRMutator *> &custom_passes) {
 
+    // Many passes simplify the same expressions (bounds, strides,
+    // loop extents) over and over. Remember the results until we're
+    // done.
+    ScopedSimplifyCache simplify_cache;
+
+    // Those expressions are also rebuilt by every pass that rewrites
+    // them. Share the equal nodes instead of allocating each one
+    // again.
+    ScopedHashConsing hash_consing(!t.has_feature(Target::NoHashConsing));
+
     // Compute an environment
     map<string, Function> env;
     for (Function f : outputs) {
@@ -81,6 +93,11 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
     // Compute a realization order
     vector<string> order = realization_order(outputs, env);
 
+    if (t.has_feature(Target::SpecializeStrides)) {
+        debug(1) << "Adding stride specializations...\n";
+        add_stride_specializations(outputs, env);
+    }
+
     // Try to simplify the RHS/LHS of a function definition by propagating its
     // specializations' conditions
     simplify_specializations(env);
@@ -246,6 +263,12 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
         debug(2) << "Lowering after injecting profiling:\n" << s << '\n';
     }
 
+    // After profiling, so that the profiler still accounts for the
+    // memory of each buffer moved into a slab under its own name.
+    debug(1) << "Planning memory...\n";
+    s = plan_memory(s, t);
+    debug(2) << "Lowering after memory planning:\n" << s << "\n\n";
+
     debug(1) << "Simplifying...\n";
     s = common_subexpression_elimination(s);
 
@@ -264,6 +287,14 @@ Stmt lower(vector<Function> outputs, const string &pipeline_name, const Target &
     s = simplify(s);
     debug(1) << "Lowering after final simplification:\n" << s << "\n\n";
 
+    // This goes after the last simplification, which would otherwise
+    // push the cheaper lifted expressions back into the loops.
+    if (!t.has_feature(Target::NoHoistLoopInvariants)) {
+        debug(1) << "Hoisting loop invariants...\n";
+        s = hoist_loop_invariants(s);
+        debug(2) << "Lowering after hoisting loop invariants:\n" << s << "\n\n";
+    }
+
     debug(1) << "Splitting off Hexagon offload...\n";
     s = inject_hexagon_rpc(s, t);
     debug(2) << "Lowering after splitting off Hexagon offload:\n" << s << '\n';
@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "MemoryPlanning.h"
+#include "Bounds.h"
+#include "CodeGen_Internal.h"
+#include "Debug.h"
+#include "ExprUsesVar.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Simplify.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Offsets into a slab are multiples of this many bytes, so every
+// buffer in it is as aligned as one from halide_malloc.
+const int slab_alignment = 64;
+
+// Buffers that could be larger than this are left out of slabs. One
+// call to halide_malloc is cheap next to filling them, and a slab
+// reserves the most space each buffer in it could need.
+const int64_t max_planned_bytes = 16 * 1024 * 1024;
+
+bool is_device_loop(const For *op) {
+    return (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host);
+}
+
+// Find the buffers that are referred to other than by loads and
+// stores on the host, e.g. by name.buffer or name.host when they're
+// passed to an extern stage or copied to a device. These can't be
+// moved into a slab.
+class FindOtherUses : public IRVisitor {
+public:
+    set<string> buffers;
+
+private:
+    using IRVisitor::visit;
+
+    bool in_device_loop = false;
+
+    void visit(const Variable *op) {
+        if (ends_with(op->name, ".buffer")) {
+            buffers.insert(op->name.substr(0, op->name.size() - 7));
+        } else if (ends_with(op->name, ".host")) {
+            buffers.insert(op->name.substr(0, op->name.size() - 5));
+        }
+    }
+
+    void visit(const Call *op) {
+        if (op->call_type == Call::Halide || op->call_type == Call::Image) {
+            buffers.insert(op->name);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Load *op) {
+        if (in_device_loop) {
+            buffers.insert(op->name);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) {
+        if (in_device_loop) {
+            buffers.insert(op->name);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) {
+        bool old_in_device_loop = in_device_loop;
+        in_device_loop = in_device_loop || is_device_loop(op);
+        IRVisitor::visit(op);
+        in_device_loop = old_in_device_loop;
+    }
+};
+
+// Can an Expr be moved to the top of a loop level? It must not
+// depend on the contents of memory or have side-effects.
+class IsHoistable : public IRVisitor {
+public:
+    bool result = true;
+
+private:
+    using IRVisitor::visit;
+
+    void visit(const Load *op) {
+        result = false;
+    }
+
+    void visit(const Call *op) {
+        if (!op->is_pure()) {
+            result = false;
+        }
+        IRVisitor::visit(op);
+    }
+};
+
+bool is_hoistable(Expr e) {
+    IsHoistable h;
+    e.accept(&h);
+    return h.result;
+}
+
+// Put every variable an Expr refers to in a scope with unknown
+// bounds, so that the bounds of the Expr only depend on constants.
+class UnknownVariables : public IRGraphVisitor {
+public:
+    Scope<Interval> scope;
+
+private:
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) {
+        if (!scope.contains(op->name)) {
+            scope.push(op->name, Interval::everything());
+        }
+    }
+};
+
+// A heap allocation at the current loop level that could be moved
+// into a slab, the most bytes it could take up there, and the interval
+// over which it is live, in terms of the order in which Allocate and
+// Free nodes at this level occur.
+struct PlannedAllocation {
+    string name;
+    Type type;
+    int64_t bytes;
+    int start, end;
+};
+
+// Find the heap allocations at one loop level. We don't look inside
+// for loops or the branches of if statements, which are separate
+// levels.
+class FindAllocations : public IRVisitor {
+public:
+    vector<PlannedAllocation> allocations;
+
+    FindAllocations(const set<string> &other_uses) : other_uses(other_uses) {}
+
+private:
+    using IRVisitor::visit;
+
+    const set<string> &other_uses;
+    map<string, int> index;
+    int position = 0;
+
+    // The enclosing lets at this level, which the sizes of
+    // allocations may refer to.
+    vector<pair<string, Expr>> lets;
+
+    // Rewrite an Expr so that it only refers to variables defined
+    // outside this level, by wrapping it in any enclosing lets it
+    // uses. Returns an undefined Expr if that's not possible.
+    Expr hoist(Expr e) {
+        for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+            if (expr_uses_var(e, it->first)) {
+                if (!is_hoistable(it->second)) {
+                    return Expr();
+                }
+                e = Let::make(it->first, it->second, e);
+            }
+        }
+        return simplify(e);
+    }
+
+    bool is_candidate(const Allocate *op) {
+        if (op->extents.empty() ||
+            op->new_expr.defined() ||
+            !op->free_function.empty() ||
+            !is_one(op->condition) ||
+            other_uses.count(op->name) ||
+            index.count(op->name)) {
+            return false;
+        }
+        // Allocations that will go on the stack are already reused
+        // by the code generator.
+        int32_t constant_size = op->constant_allocation_size();
+        if (constant_size > 0 && can_allocation_fit_on_stack(constant_size * op->type.bytes())) {
+            return false;
+        }
+        for (Expr e : op->extents) {
+            if (!is_hoistable(e)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void visit(const LetStmt *op) {
+        lets.push_back({op->name, op->value});
+        op->body.accept(this);
+        lets.pop_back();
+    }
+
+    // The most bytes an allocation could take up in a slab, or zero if
+    // that isn't bounded by a constant, or is too large to be worth
+    // planning. Each extent is bounded separately, as the bounds of a
+    // product of extents that aren't known to be positive are lost.
+    int64_t max_bytes(const Allocate *op) {
+        int64_t elements = 1;
+        for (Expr e : op->extents) {
+            e = hoist(e);
+            if (!e.defined()) {
+                return 0;
+            }
+            UnknownVariables vars;
+            e.accept(&vars);
+            Interval bounds = bounds_of_expr_in_scope(e, vars.scope);
+            if (!bounds.has_upper_bound()) {
+                return 0;
+            }
+            const int64_t *max_extent = as_const_int(simplify(bounds.max));
+            if (!max_extent) {
+                return 0;
+            }
+            elements *= std::max(*max_extent, (int64_t)0);
+            if (elements * op->type.bytes() > max_planned_bytes) {
+                return 0;
+            }
+        }
+        // Leave room for one extra element, which the code generator
+        // pads heap allocations with, and round up to the alignment
+        // of the slab.
+        int64_t bytes = (elements + 1) * op->type.bytes();
+        return (bytes + slab_alignment - 1) / slab_alignment * slab_alignment;
+    }
+
+    void visit(const Allocate *op) {
+        int64_t bytes = is_candidate(op) ? max_bytes(op) : 0;
+
+        if (bytes > 0) {
+            PlannedAllocation alloc;
+            alloc.name = op->name;
+            alloc.type = op->type;
+            alloc.bytes = bytes;
+            alloc.start = position++;
+            alloc.end = -1;
+            index[op->name] = (int)allocations.size();
+            allocations.push_back(alloc);
+        }
+
+        op->body.accept(this);
+
+        if (bytes > 0) {
+            PlannedAllocation &alloc = allocations[index[op->name]];
+            if (alloc.end < 0) {
+                alloc.end = position++;
+            }
+        }
+    }
+
+    void visit(const Free *op) {
+        auto it = index.find(op->name);
+        if (it != index.end() && allocations[it->second].end < 0) {
+            allocations[it->second].end = position++;
+        }
+    }
+
+    void visit(const For *op) {}
+    void visit(const IfThenElse *op) {}
+
+    // There are no allocations inside Exprs.
+    void visit(const Store *op) {}
+    void visit(const Evaluate *op) {}
+    void visit(const AssertStmt *op) {}
+};
+
+// Remove the planned allocations and their frees, and redirect loads
+// and stores to them into the slab.
+class RedirectToSlab : public IRMutator {
+public:
+    RedirectToSlab(const string &slab, const map<string, Expr> &offsets) :
+        slab(slab), offsets(offsets) {}
+
+private:
+    using IRMutator::visit;
+
+    const string &slab;
+    const map<string, Expr> &offsets;
+
+    Expr offset_index(Expr index, const string &name) {
+        Expr offset = offsets.find(name)->second;
+        if (index.type().is_vector()) {
+            offset = Broadcast::make(offset, index.type().lanes());
+        }
+        return index + offset;
+    }
+
+    void visit(const Allocate *op) {
+        if (offsets.count(op->name)) {
+            stmt = mutate(op->body);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Free *op) {
+        if (offsets.count(op->name)) {
+            stmt = Evaluate::make(0);
+        } else {
+            stmt = op;
+        }
+    }
+
+    void visit(const Load *op) {
+        if (offsets.count(op->name)) {
+            Expr index = offset_index(mutate(op->index), op->name);
+            expr = Load::make(op->type, slab, index, op->image, op->param);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Store *op) {
+        if (offsets.count(op->name)) {
+            Expr value = mutate(op->value);
+            Expr index = offset_index(mutate(op->index), op->name);
+            stmt = Store::make(slab, value, index, op->param);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+class PlanMemory : public IRMutator {
+public:
+    PlanMemory(const Target &t) : target(t) {}
+
+    Stmt plan_level(Stmt s) {
+        FindOtherUses other_uses;
+        s.accept(&other_uses);
+
+        FindAllocations finder(other_uses.buffers);
+        s.accept(&finder);
+        const vector<PlannedAllocation> &allocations = finder.allocations;
+
+        if (allocations.size() < 2) {
+            return s;
+        }
+
+        // Assign allocations to slots in the slab, in the order in
+        // which they're allocated. An allocation can reuse a slot if
+        // everything in it has been freed. The slab must not be
+        // larger than a single buffer may be, so allocations that
+        // would make it so are left as they are.
+        const int64_t max_slab_bytes = std::min(target.maximum_buffer_size(), (int64_t)0x7fffffff);
+        struct Slot {
+            int64_t bytes;
+            int end;
+        };
+        vector<Slot> slots;
+        map<string, int> slot_of;
+        int64_t total_bytes = 0;
+        for (const PlannedAllocation &alloc : allocations) {
+            int slot = -1;
+            for (size_t j = 0; j < slots.size(); j++) {
+                if (slots[j].end < alloc.start) {
+                    slot = (int)j;
+                    break;
+                }
+            }
+            int64_t growth = slot < 0 ? alloc.bytes : std::max(alloc.bytes - slots[slot].bytes, (int64_t)0);
+            if (total_bytes + growth > max_slab_bytes) {
+                continue;
+            }
+            total_bytes += growth;
+            if (slot < 0) {
+                slot = (int)slots.size();
+                slots.push_back({alloc.bytes, alloc.end});
+            } else {
+                slots[slot].bytes = std::max(slots[slot].bytes, alloc.bytes);
+                slots[slot].end = alloc.end;
+            }
+            slot_of[alloc.name] = slot;
+        }
+
+        if (slot_of.size() < 2) {
+            return s;
+        }
+
+        string slab = unique_name("memory_plan.slab");
+        debug(2) << "Packing " << slot_of.size() << " allocations into "
+                 << slots.size() << " slots of " << slab << ", "
+                 << total_bytes << " bytes in total\n";
+
+        vector<int64_t> slot_offset(slots.size(), 0);
+        for (size_t j = 1; j < slots.size(); j++) {
+            slot_offset[j] = slot_offset[j - 1] + slots[j - 1].bytes;
+        }
+
+        // Slot offsets are constant multiples of the slab alignment,
+        // so they can be expressed in elements of any type, and the
+        // alignment of loads and stores in the slab is as easy to
+        // prove as it was in the separate allocations.
+        map<string, Expr> offsets;
+        for (const PlannedAllocation &alloc : allocations) {
+            auto it = slot_of.find(alloc.name);
+            if (it != slot_of.end()) {
+                offsets[alloc.name] = make_const(Int(32), slot_offset[it->second] / alloc.type.bytes());
+            }
+        }
+
+        s = RedirectToSlab(slab, offsets).mutate(s);
+        s = Block::make(s, Free::make(slab));
+        s = Allocate::make(slab, UInt(8), {make_const(Int(32), total_bytes)}, const_true(), s);
+        return s;
+    }
+
+private:
+    using IRMutator::visit;
+
+    const Target &target;
+
+    void visit(const For *op) {
+        if (is_device_loop(op)) {
+            // Allocations in device code are handled by the device
+            // backends.
+            stmt = op;
+            return;
+        }
+        Stmt body = plan_level(mutate(op->body));
+        if (body.same_as(op->body)) {
+            stmt = op;
+        } else {
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        }
+    }
+
+    void visit(const IfThenElse *op) {
+        // Each branch might not run, so gets its own slab. In
+        // particular the whole pipeline is inside the branch that runs
+        // when the buffers passed in are valid.
+        Stmt then_case = plan_level(mutate(op->then_case));
+        Stmt else_case = op->else_case;
+        if (else_case.defined()) {
+            else_case = plan_level(mutate(else_case));
+        }
+        if (then_case.same_as(op->then_case) && else_case.same_as(op->else_case)) {
+            stmt = op;
+        } else {
+            stmt = IfThenElse::make(op->condition, then_case, else_case);
+        }
+    }
+};
+
+}
+
+Stmt plan_memory(Stmt s, const Target &t) {
+    PlanMemory planner(t);
+    return planner.plan_level(planner.mutate(s));
+}
+
+}
+}
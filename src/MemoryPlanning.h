@@ -0,0 +1,37 @@
+#ifndef HALIDE_MEMORY_PLANNING_H
+#define HALIDE_MEMORY_PLANNING_H
+
+/** \file
+ * Defines the lowering pass that packs heap allocations with
+ * non-overlapping lifetimes into shared slabs.
+ */
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find the heap allocations made at each loop level (i.e. not
+ * separated by a For loop or the branch of an if statement), work out
+ * which of them are live at the same time using the Free nodes
+ * injected by inject_early_frees, and replace them with a single
+ * allocation per level, in which allocations whose lifetimes don't
+ * overlap share space. Loads and stores are redirected into the slab
+ * at constant offsets, which are multiples of 64 bytes. Only
+ * allocations whose size has a constant upper bound of at most 16MB
+ * are moved into a slab, and each takes up that much space in it:
+ * typically buffers allocated inside loops, and the compute_root
+ * intermediates of pipelines with bounded outputs. A slab is never
+ * larger than a single buffer may be on the target. Must be called
+ * after inject_early_frees, and after inject_profiling, so that the
+ * profiler still sees each buffer under its own name. Allocations
+ * that are conditional, custom, or referred to other than by loads
+ * and stores (e.g. passed to an extern stage or a device) are left
+ * alone. */
+Stmt plan_memory(Stmt s, const Target &t);
+
+}
+}
+
+#endif
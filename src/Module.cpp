@@ -1,10 +1,17 @@
 #include "Module.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <thread>
 
 #include "CodeGen_C.h"
 #include "CodeGen_Internal.h"
+#include "CostEstimate.h"
 #include "Debug.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
@@ -46,9 +53,55 @@ Outputs add_suffixes(const Outputs &in, const std::string &suffix) {
     if (!in.c_source_name.empty()) out.c_source_name = add_suffix(in.c_source_name, suffix);
     if (!in.stmt_name.empty()) out.stmt_name = add_suffix(in.stmt_name, suffix);
     if (!in.stmt_html_name.empty()) out.stmt_html_name = add_suffix(in.stmt_html_name, suffix);
+    if (!in.cost_report_name.empty()) out.cost_report_name = add_suffix(in.cost_report_name, suffix);
     return out;
 }
 
+// Run f(0) ... f(n-1) on a small pool of threads. When errors are
+// exceptions, they are rethrown on the calling thread once everything
+// has finished, the lowest-numbered first, so failures are reported
+// the same way no matter how the work was scheduled.
+void parallel_for_each(size_t n, std::function<void(size_t)> f) {
+    size_t num_threads = std::min<size_t>(n, std::max(1u, std::thread::hardware_concurrency()));
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(n);
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++) {
+            #ifdef WITH_EXCEPTIONS
+            try {
+                f(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            #else
+            f(i);
+            #endif
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (const auto &e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
 }  // namespace
 
 struct ModuleContents {
@@ -212,6 +265,11 @@ void Module::compile(const Outputs &output_files) const {
         debug(1) << "Module.compile(): stmt_html_name " << output_files.stmt_html_name << "\n";
         Internal::print_to_html(output_files.stmt_html_name, *this);
     }
+    if (!output_files.cost_report_name.empty()) {
+        debug(1) << "Module.compile(): cost_report_name " << output_files.cost_report_name << "\n";
+        std::ofstream file(output_files.cost_report_name);
+        Internal::print_cost_report(file, *this, Internal::MachineParams::for_target(target()));
+    }
 }
 
 Outputs compile_standalone_runtime(const Outputs &output_files, Target t) {
@@ -230,7 +288,8 @@ void compile_standalone_runtime(const std::string &object_filename, Target t) {
 void compile_multitarget(const std::string &fn_name, 
                          const Outputs &output_files,
                          const std::vector<Target> &targets, 
-                         ModuleProducer module_producer) {
+                         ModuleProducer module_producer,
+                         bool concurrent_producer) {
     user_assert(!fn_name.empty()) << "Function name must be specified.\n";
     user_assert(!targets.empty()) << "Must specify at least one target.\n";
 
@@ -259,9 +318,19 @@ void compile_multitarget(const std::string &fn_name,
     }
 
     std::vector<std::unique_ptr<TemporaryFile>> all_temp_object_files;
+    // The work to do for each target, and for the runtime. Lowering
+    // and compiling each target is independent, and the jobs run
+    // concurrently. If the module producer can't be called from
+    // several threads at once, the modules are produced here one at a
+    // time, and only the compilation is left to the jobs.
+    std::vector<std::function<void()>> jobs;
     std::vector<Expr> wrapper_args;
     std::vector<LoweredArgument> base_target_args;
-    for (const Target &target : targets) {
+    // Each job that calls the module producer makes its names in its
+    // own scope, so they don't depend on how the jobs interleave.
+    const int first_name_scope = UniqueNameScope::reserve_ids((int)targets.size());
+    for (size_t t = 0; t < targets.size(); t++) {
+        const Target &target = targets[t];
         // arch-bits-os must be identical across all targets.
         if (target.os != base_target.os ||
             target.arch != base_target.arch ||
@@ -288,14 +357,32 @@ void compile_multitarget(const std::string &fn_name,
         auto suffix = "_" + replace_all(target.to_string(), "-", "_");
         std::string sub_fn_name = fn_name + suffix;
 
-        // We always produce the runtime separately, so add NoRuntime explicitly.
-        Module module = module_producer(sub_fn_name, target.with_feature(Target::NoRuntime));
         Outputs sub_out = add_suffixes(output_files, suffix);
         if (sub_out.object_name.empty()) {
             all_temp_object_files.emplace_back(make_temp_object_file(output_files.static_library_name, suffix, target));
             sub_out.object_name = all_temp_object_files.back()->pathname();
         }
-        module.compile(sub_out);
+
+        // We always produce the runtime separately, so add NoRuntime explicitly.
+        const Target sub_target = target.with_feature(Target::NoRuntime);
+        const bool is_base = (t + 1 == targets.size());
+        if (concurrent_producer) {
+            const int name_scope = first_name_scope + (int)t;
+            jobs.push_back([=, &module_producer, &base_target_args]() {
+                UniqueNameScope names(name_scope);
+                Module module = module_producer(sub_fn_name, sub_target);
+                if (is_base) {
+                    base_target_args = module.functions().back().args;
+                }
+                module.compile(sub_out);
+            });
+        } else {
+            Module module = module_producer(sub_fn_name, sub_target);
+            if (is_base) {
+                base_target_args = module.functions().back().args;
+            }
+            jobs.push_back([=]() { module.compile(sub_out); });
+        }
 
         static_assert(sizeof(uint64_t)*8 >= Target::FeatureEnd, "Features will not fit in uint64_t");
         uint64_t feature_bits = 0;
@@ -309,7 +396,6 @@ void compile_multitarget(const std::string &fn_name,
 
         if (target == base_target) {
             can_use = IntImm::make(Int(32), 1);
-            base_target_args = module.functions().back().args;
         }
 
         wrapper_args.push_back(can_use != 0);
@@ -321,9 +407,26 @@ void compile_multitarget(const std::string &fn_name,
     if (!base_target.has_feature(Target::NoRuntime)) {
         const Target runtime_target = base_target.without_feature(Target::NoRuntime);
         all_temp_object_files.emplace_back(make_temp_object_file(output_files.static_library_name, "_runtime", runtime_target));
-        compile_standalone_runtime(Outputs().object(all_temp_object_files.back()->pathname()), runtime_target);
+        std::string runtime_object = all_temp_object_files.back()->pathname();
+        jobs.push_back([=]() {
+            compile_standalone_runtime(Outputs().object(runtime_object), runtime_target);
+        });
     }
 
+    // Each job writes its own files, and the library below is
+    // assembled in target order, so the output doesn't depend on the
+    // order in which the jobs finish.
+    auto start = std::chrono::high_resolution_clock::now();
+    parallel_for_each(jobs.size(), [&](size_t i) {
+        jobs[i]();
+    });
+    auto end = std::chrono::high_resolution_clock::now();
+    debug(1) << "compile_multitarget: " << (concurrent_producer ? "lowered and compiled " : "compiled ")
+             << targets.size() << " targets in "
+             << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+
+    // The wrapper needs the arguments of the base target's module, so
+    // it comes last.
     Expr indirect_result = Call::make(Int(32), Call::call_cached_indirect_function, wrapper_args, Call::Intrinsic);
     std::string private_result_name = unique_name(fn_name + "_result");
     Expr private_result_var = Variable::make(Int(32), private_result_name);
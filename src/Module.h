@@ -116,10 +116,20 @@ EXPORT Outputs compile_standalone_runtime(const Outputs &output_files, Target t)
 
 typedef std::function<Module(const std::string &, const Target &)> ModuleProducer;
 
+/** Compile a static library with a variant of a pipeline for each of
+ * several targets, and a wrapper that picks the first that the host
+ * supports at runtime. The modules for the targets are compiled
+ * concurrently. If concurrent_producer is true, module_producer is
+ * also called for several targets at once, on different threads, so
+ * lowering runs concurrently too; each call makes its names in its
+ * own UniqueNameScope, so the library doesn't depend on how the
+ * threads interleave. Otherwise it's called for one target at a time
+ * on the calling thread. */
 EXPORT void compile_multitarget(const std::string &fn_name, 
                                 const Outputs &output_files,
                                 const std::vector<Target> &targets, 
-                                ModuleProducer module_producer);
+                                ModuleProducer module_producer,
+                                bool concurrent_producer = false);
 
 }
 
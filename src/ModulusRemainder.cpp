@@ -163,8 +163,8 @@ void ComputeModulusRemainder::visit(const Cast *) {
 }
 
 void ComputeModulusRemainder::visit(const Variable *op) {
-    if (scope.contains(op->name)) {
-        ModulusRemainder mod_rem = scope.get(op->name);
+    if (scope.contains(op->symbol())) {
+        ModulusRemainder mod_rem = scope.get(op->symbol());
         modulus = mod_rem.modulus;
         remainder = mod_rem.remainder;
     } else {
@@ -378,11 +378,11 @@ void ComputeModulusRemainder::visit(const Let *op) {
 
     if (value_interesting) {
         ModulusRemainder val = analyze(op->value);
-        scope.push(op->name, val);
+        scope.push(op->symbol(), val);
     }
     ModulusRemainder val = analyze(op->body);
     if (value_interesting) {
-        scope.pop(op->name);
+        scope.pop(op->symbol());
     }
     modulus = val.modulus;
     remainder = val.remainder;
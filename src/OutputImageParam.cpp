@@ -64,6 +64,18 @@ OutputImageParam &OutputImageParam::set_bounds(int dim, Expr min, Expr extent) {
     return set_min(dim, min).set_extent(dim, extent);
 }
 
+OutputImageParam &OutputImageParam::set_interleaved(int channels, int channel_dim) {
+    user_assert(channel_dim > 0 && channel_dim < dimensions())
+        << "Can't make dimension " << channel_dim << " of " << name()
+        << " the interleaved channel dimension, because it has "
+        << dimensions() << " dimensions\n";
+    user_assert(channels > 0)
+        << "Interleaved image " << name() << " must have a positive number of channels\n";
+    return set_stride(0, channels)
+        .set_stride(channel_dim, 1)
+        .set_bounds(channel_dim, 0, channels);
+}
+
 int OutputImageParam::dimensions() const {
     return param.dimensions();
 }
@@ -98,6 +98,25 @@ public:
     /** Set the min and extent in one call. */
     EXPORT OutputImageParam &set_bounds(int dim, Expr min, Expr extent);
 
+    /** Declare that this image stores its channels interleaved
+     * ("chunky"), e.g. RGBRGBRGB..., with the given number of
+     * channels in dimension channel_dim. This is equivalent to:
+     \code
+     im.set_stride(0, channels)
+       .set_stride(channel_dim, 1)
+       .set_bounds(channel_dim, 0, channels);
+     \endcode
+     * With the layout known at compile time, a schedule that unrolls
+     * the channel dimension innermost and vectorizes across x, e.g.:
+     \code
+     f.reorder(c, x, y).bound(c, 0, 3).unroll(c).vectorize(x, 16);
+     \endcode
+     * loads each channel of an interleaved input with dense vector
+     * loads and shuffles, and writes all channels of an interleaved
+     * output with a single interleaving vector store, instead of
+     * using gathers and scatters. */
+    EXPORT OutputImageParam &set_interleaved(int channels, int channel_dim = 2);
+
     /** Get the dimensionality of this image parameter */
     EXPORT int dimensions() const;
 
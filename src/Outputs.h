@@ -46,6 +46,10 @@ struct Outputs {
      * output is desired. */
     std::string stmt_html_name;
 
+    /** The name of the emitted cost report (see CostEstimate.h). Empty
+     * if no cost report is desired. */
+    std::string cost_report_name;
+
     /** The name of the emitted static library file. Empty if no static library
      * output is desired. */
     std::string static_library_name;
@@ -114,6 +118,14 @@ struct Outputs {
         return updated;
     }
 
+    /** Make a new Outputs struct that emits everything this one does
+     * and also a cost report with the given name. */
+    Outputs cost_report(const std::string &cost_report_name) {
+        Outputs updated = *this;
+        updated.cost_report_name = cost_report_name;
+        return updated;
+    }
+
     /** Make a new Outputs struct that emits everything this one does
      * and also a static library file with the given name. */
     Outputs static_library(const std::string &static_library_name) {
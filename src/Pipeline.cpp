@@ -1,9 +1,11 @@
 #include <algorithm>
+#include <mutex>
 
 #include "Pipeline.h"
 #include "Argument.h"
 #include "Func.h"
 #include "IRVisitor.h"
+#include "LazySpecializations.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
 #include "Lower.h"
@@ -40,6 +42,35 @@ Outputs static_library_outputs(const string &filename_prefix, const Target &targ
     return outputs;
 }
 
+// Move the specialized code paths of a module built by
+// compile_to_module into functions that are only compiled when first
+// run. The module that owns them is added to the dependencies.
+Module make_specializations_lazy(const Module &module, vector<JITModule> &dependencies) {
+    internal_assert(module.functions().size() == 2);
+    LoweredFunc private_fn = module.functions().front();
+    vector<LoweredFunc> lazy_fns;
+    private_fn.body = outline_lazy_specializations(private_fn.body, lazy_fns);
+    if (lazy_fns.empty()) {
+        return module;
+    }
+
+    JITModule lazy_module;
+    for (const LoweredFunc &f : lazy_fns) {
+        void *handle = lazy_module.add_lazy_function(f, module.target(), dependencies);
+        Expr value = reinterpret(Handle(), make_const(UInt(64), (uint64_t)(uintptr_t)handle));
+        private_fn.body = LetStmt::make(f.name, value, private_fn.body);
+    }
+    dependencies.push_back(lazy_module);
+
+    Module result(module.name(), module.target());
+    for (const Buffer &buf : module.buffers()) {
+        result.append(buf);
+    }
+    result.append(private_fn);
+    result.append(module.functions().back());
+    return result;
+}
+
 }  // namespace
 
 /** An inferred argument. Inferred args are either Params,
@@ -66,8 +97,11 @@ struct InferredArgument {
 struct PipelineContents {
     mutable RefCount ref_count;
 
-    // Cached lowered stmt
+    // Cached lowered stmt. compile_multitarget may compile a
+    // pipeline for several targets at once, so it's guarded by
+    // module_lock in compile_to_module.
     Module module;
+    std::mutex module_lock;
 
     // Cached jit-compiled code
     JITModule jit_module;
@@ -251,6 +285,13 @@ void Pipeline::compile_to_lowered_stmt(const string &filename,
     m.compile(outputs);
 }
 
+void Pipeline::compile_to_cost_report(const string &filename,
+                                      const vector<Argument> &args,
+                                      const Target &target) {
+    Module m = compile_to_module(args, "", target);
+    m.compile(Outputs().cost_report(output_name(filename, m, ".cost")));
+}
+
 void Pipeline::compile_to_static_library(const string &filename_prefix,
                                          const vector<Argument> &args,
                                          const Target &target) {
@@ -266,7 +307,10 @@ void Pipeline::compile_to_multitarget_static_library(const std::string &filename
         return compile_to_module(args, name, target);
     };
     Outputs outputs = static_library_outputs(filename_prefix, targets.back());
-    compile_multitarget(generate_function_name(), outputs, targets, module_producer);
+    // Custom lowering passes are shared by every lowering, and may not
+    // be safe to run on several threads at once.
+    bool concurrent = contents->custom_lowering_passes.empty();
+    compile_multitarget(generate_function_name(), outputs, targets, module_producer, concurrent);
 }
 
 void Pipeline::compile_to_file(const string &filename_prefix,
@@ -554,7 +598,11 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
 
     Stmt private_body;
 
-    const Module &old_module = contents->module;
+    Module old_module("", Target());
+    {
+        std::lock_guard<std::mutex> lock(contents->module_lock);
+        old_module = contents->module;
+    }
     if (!old_module.functions().empty() &&
         old_module.target() == target) {
         internal_assert(old_module.functions().size() == 2);
@@ -615,7 +663,10 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
 
     module.append(LoweredFunc(new_fn_name, public_args, public_body, linkage_type));
 
-    contents->module = module;
+    {
+        std::lock_guard<std::mutex> lock(contents->module_lock);
+        contents->module = module;
+    }
 
     return module;
 }
@@ -671,9 +722,14 @@ void *Pipeline::compile_jit(const Target &target_arg) {
     infer_arguments(module.functions().back().body);
 
     std::map<std::string, JITExtern> lowered_externs = contents->jit_externs;
+    vector<JITModule> dependencies = make_externs_jit_module(target_arg, lowered_externs);
+
+    if (target.has_feature(Target::LazySpecializations)) {
+        module = make_specializations_lazy(module, dependencies);
+    }
+
     // Compile to jit module
-    JITModule jit_module(module, module.functions().back(),
-                         make_externs_jit_module(target_arg, lowered_externs));
+    JITModule jit_module(module, module.functions().back(), dependencies);
 
     // Dump bitcode to a file if the environment variable
     // HL_GENBITCODE is non-zero.
@@ -1041,12 +1097,8 @@ Pipeline::make_externs_jit_module(const Target &target,
     return result;
 }
 
-void Pipeline::realize(Realization dst, const Target &t) {
+Target Pipeline::resolve_jit_target(const Target &t) const {
     Target target = t;
-    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
-
-    debug(2) << "Realizing Pipeline for " << target.to_string() << "\n";
-
     // If target is unspecified...
     if (target.os == Target::OSUnknown) {
         // If we've already jit-compiled for a specific target, use that.
@@ -1057,6 +1109,15 @@ void Pipeline::realize(Realization dst, const Target &t) {
             target = get_jit_target_from_environment();
         }
     }
+    return target;
+}
+
+void Pipeline::realize(Realization dst, const Target &t) {
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+
+    debug(2) << "Realizing Pipeline for " << t.to_string() << "\n";
+
+    Target target = resolve_jit_target(t);
 
     vector<const void *> args = prepare_jit_call_arguments(dst, target);
 
@@ -1154,10 +1215,44 @@ void Pipeline::realize(Realization dst, const Target &t) {
     jit_context.finalize(exit_status);
 }
 
-void Pipeline::infer_input_bounds(Realization dst) {
+namespace {
 
-    Target target = get_jit_target_from_environment();
+// Allocate a Buffer matching the mins, extents, and strides of a
+// buffer_t returned by a bounds query.
+Buffer allocate_queried_buffer(Type t, const buffer_t &buf) {
+    // Figure out how much memory to allocate for this buffer
+    size_t min_idx = 0, max_idx = 0;
+    for (int d = 0; d < 4; d++) {
+        if (buf.stride[d] > 0) {
+            min_idx += buf.min[d] * buf.stride[d];
+            max_idx += (buf.min[d] + buf.extent[d] - 1) * buf.stride[d];
+        } else {
+            max_idx += buf.min[d] * buf.stride[d];
+            min_idx += (buf.min[d] + buf.extent[d] - 1) * buf.stride[d];
+        }
+    }
+    size_t total_size = (max_idx - min_idx);
+    while (total_size & 0x1f) total_size++;
+
+    // Allocate enough memory with the right dimensionality.
+    Buffer buffer(t, total_size,
+                  buf.extent[1] > 0 ? 1 : 0,
+                  buf.extent[2] > 0 ? 1 : 0,
+                  buf.extent[3] > 0 ? 1 : 0);
+
+    // Rewrite the buffer fields to match the ones returned
+    for (int d = 0; d < 4; d++) {
+        buffer.raw_buffer()->min[d] = buf.min[d];
+        buffer.raw_buffer()->stride[d] = buf.stride[d];
+        buffer.raw_buffer()->extent[d] = buf.extent[d];
+    }
+    return buffer;
+}
+
+}  // namespace
 
+vector<size_t> Pipeline::query_input_bounds(Realization dst, const Target &target,
+                                            vector<buffer_t> &regions) {
     vector<const void *> args = prepare_jit_call_arguments(dst, target);
 
     struct TrackedBuffer {
@@ -1180,7 +1275,7 @@ void Pipeline::infer_input_bounds(Realization dst) {
     // No need to query if all the inputs are bound already.
     if (query_indices.empty()) {
         debug(1) << "All inputs are bound. No need for bounds inference\n";
-        return;
+        return query_indices;
     }
 
     JITFuncCallContext jit_context(jit_handlers(), contents->user_context_arg.param);
@@ -1219,11 +1314,25 @@ void Pipeline::infer_input_bounds(Realization dst) {
 
     debug(1) << "Bounds inference converged after " << iter << " iterations\n";
 
+    regions.resize(args.size());
+    for (size_t i : query_indices) {
+        regions[i] = tracked_buffers[i].query;
+    }
+    return query_indices;
+}
+
+void Pipeline::infer_input_bounds(Realization dst) {
+
+    Target target = get_jit_target_from_environment();
+
+    vector<buffer_t> regions;
+    vector<size_t> query_indices = query_input_bounds(dst, target, regions);
+
     // Now allocate the resulting buffers
     for (size_t i : query_indices) {
         InferredArgument ia = contents->inferred_args[i];
         internal_assert(!ia.param.get_buffer().defined());
-        buffer_t buf = tracked_buffers[i].query;
+        const buffer_t &buf = regions[i];
 
         Internal::debug(1) << "Inferred bounds for " << ia.param.name() << ": ("
                            << buf.min[0] << ","
@@ -1235,33 +1344,89 @@ void Pipeline::infer_input_bounds(Realization dst) {
                            << buf.min[2] + buf.extent[2] << ","
                            << buf.min[3] + buf.extent[3] << ")\n";
 
-        // Figure out how much memory to allocate for this buffer
-        size_t min_idx = 0, max_idx = 0;
-        for (int d = 0; d < 4; d++) {
-            if (buf.stride[d] > 0) {
-                min_idx += buf.min[d] * buf.stride[d];
-                max_idx += (buf.min[d] + buf.extent[d] - 1) * buf.stride[d];
-            } else {
-                max_idx += buf.min[d] * buf.stride[d];
-                min_idx += (buf.min[d] + buf.extent[d] - 1) * buf.stride[d];
+        ia.param.set_buffer(allocate_queried_buffer(ia.param.type(), buf));
+    }
+}
+
+void Pipeline::realize_in_tiles(const vector<int32_t> &sizes,
+                                const vector<int32_t> &tile_sizes,
+                                TileInputFetcher fetch_input,
+                                TileOutputSink consume_output,
+                                const Target &t) {
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+    user_assert(sizes.size() == tile_sizes.size())
+        << "realize_in_tiles was given " << sizes.size()
+        << " output sizes but " << tile_sizes.size() << " tile sizes\n";
+    user_assert(sizes.size() <= 4)
+        << "realize_in_tiles only supports outputs with up to four dimensions\n";
+    for (size_t d = 0; d < sizes.size(); d++) {
+        user_assert(tile_sizes[d] > 0)
+            << "Tile size in dimension " << d << " must be positive\n";
+    }
+
+    Target target = resolve_jit_target(t);
+
+    // Walk the tiles in row-major order, with the innermost
+    // dimension varying fastest.
+    const int dims = (int)sizes.size();
+    vector<int32_t> tile_min(dims, 0);
+    bool done = false;
+    for (int d = 0; d < dims; d++) {
+        done = done || sizes[d] <= 0;
+    }
+    while (!done) {
+        vector<int32_t> tile_extent(dims);
+        for (int d = 0; d < dims; d++) {
+            tile_extent[d] = std::min(tile_sizes[d], sizes[d] - tile_min[d]);
+        }
+
+        vector<Buffer> bufs;
+        for (Function f : contents->outputs) {
+            for (Type type : f.output_types()) {
+                Buffer b(type, tile_extent);
+                for (int d = 0; d < dims; d++) {
+                    b.raw_buffer()->min[d] = tile_min[d];
+                }
+                bufs.push_back(b);
             }
         }
-        size_t total_size = (max_idx - min_idx);
-        while (total_size & 0x1f) total_size++;
-
-        // Allocate enough memory with the right dimensionality.
-        Buffer buffer(ia.param.type(), total_size,
-                      buf.extent[1] > 0 ? 1 : 0,
-                      buf.extent[2] > 0 ? 1 : 0,
-                      buf.extent[3] > 0 ? 1 : 0);
-
-        // Rewrite the buffer fields to match the ones returned
-        for (int d = 0; d < 4; d++) {
-            buffer.raw_buffer()->min[d] = buf.min[d];
-            buffer.raw_buffer()->stride[d] = buf.stride[d];
-            buffer.raw_buffer()->extent[d] = buf.extent[d];
+        Realization tile(bufs);
+
+        debug(2) << "Realizing tile at ("
+                 << (dims > 0 ? tile_min[0] : 0) << ", "
+                 << (dims > 1 ? tile_min[1] : 0) << ", ...)\n";
+
+        // Ask for exactly the input regions this tile needs, and have
+        // the caller fill them in.
+        vector<buffer_t> regions;
+        vector<size_t> query_indices = query_input_bounds(tile, target, regions);
+        for (size_t i : query_indices) {
+            Parameter param = contents->inferred_args[i].param;
+            Buffer input = allocate_queried_buffer(param.type(), regions[i]);
+            fetch_input(param.name(), input);
+            param.set_buffer(input);
+        }
+
+        realize(tile, target);
+
+        // Release the inputs before handing the tile over, so that
+        // the next tile's inputs don't coexist with this tile's.
+        for (size_t i : query_indices) {
+            contents->inferred_args[i].param.set_buffer(Buffer());
+        }
+
+        consume_output(tile);
+
+        // Advance to the next tile.
+        done = true;
+        for (int d = 0; d < dims; d++) {
+            tile_min[d] += tile_sizes[d];
+            if (tile_min[d] < sizes[d]) {
+                done = false;
+                break;
+            }
+            tile_min[d] = 0;
         }
-        ia.param.set_buffer(buffer);
     }
 }
 
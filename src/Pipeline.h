@@ -7,6 +7,7 @@
  * pipeline.
  */
 
+#include <functional>
 #include <vector>
 
 #include "Buffer.h"
@@ -53,6 +54,19 @@ struct CustomLoweringPass {
 
 struct JITExtern;
 
+/** A callback used by Pipeline::realize_in_tiles to fill in the
+ * region of an input required for one output tile. The first
+ * argument is the name of the ImageParam, and the second is a
+ * freshly-allocated Buffer whose mins and extents describe the region
+ * required. The callback should fill in the Buffer's host memory. */
+typedef std::function<void(const std::string &, Buffer)> TileInputFetcher;
+
+/** A callback used by Pipeline::realize_in_tiles to consume one
+ * finished output tile. The Buffers in the Realization have their
+ * mins set to the position of the tile within the full output. They
+ * are only valid for the duration of the call. */
+typedef std::function<void(Realization)> TileOutputSink;
+
 /** A class representing a Halide pipeline. Constructed from the Func
  * or Funcs that it outputs. */
 class Pipeline {
@@ -155,6 +169,15 @@ public:
                                         StmtOutputFormat fmt = Text,
                                         const Target &target = get_target_from_environment());
 
+    /** Write out a static estimate of the work done by each stage of
+     * the lowered code: arithmetic ops by type, bytes loaded and
+     * stored, allocations and parallel tasks, along with a
+     * roofline-style estimate of whether each stage is limited by
+     * compute or memory bandwidth. See CostEstimate.h. */
+    EXPORT void compile_to_cost_report(const std::string &filename,
+                                       const std::vector<Argument> &args,
+                                       const Target &target = get_target_from_environment());
+
     /** Write out the loop nests specified by the schedule for this
      * Pipeline's Funcs. Helpful for understanding what a schedule is
      * doing. */
@@ -371,6 +394,28 @@ public:
     }
     // @}
 
+    /** Evaluate this pipeline over an output of the given size
+     * without ever holding the whole input or output in memory. The
+     * output is walked in tiles of size tile_sizes (the last tile
+     * in each dimension may be smaller). For each tile, the region
+     * of every unbound ImageParam required to compute it is
+     * determined via bounds inference, allocated, and passed to
+     * fetch_input to be filled. The tile is then realized and
+     * handed to consume_output. ImageParams that were already bound
+     * to a Buffer are used as-is, and ImageParams fetched this way
+     * are left unbound afterwards.
+     *
+     * Because each tile is a separate realization, compute_root
+     * intermediates are only as large as a tile requires, so peak
+     * memory is bounded by the working set of a single tile rather
+     * than by the size of the output. Intermediates that overlap
+     * between tiles are recomputed. */
+    EXPORT void realize_in_tiles(const std::vector<int32_t> &sizes,
+                                 const std::vector<int32_t> &tile_sizes,
+                                 TileInputFetcher fetch_input,
+                                 TileOutputSink consume_output,
+                                 const Target &target = Target());
+
     /** For a given size of output, or a given set of output buffers,
      * determine the bounds required of all unbound ImageParams
      * referenced. Communicates the result by allocating new buffers
@@ -402,6 +447,14 @@ public:
 
 private:
     std::string generate_function_name() const;
+    Target resolve_jit_target(const Target &target) const;
+
+    /** Run the bounds query for the given outputs. Returns the
+     * indices of the unbound ImageParams in the inferred arguments,
+     * and writes the region required of each of them into the
+     * corresponding entry of regions. */
+    std::vector<size_t> query_input_bounds(Realization dst, const Target &target,
+                                           std::vector<buffer_t> &regions);
     std::vector<Argument> build_public_args(const std::vector<Argument> &args, const Target &target) const;
 
 };
@@ -1,6 +1,7 @@
 #include "Random.h"
 #include "IROperator.h"
 #include "IRMutator.h"
+#include "Simplify.h"
 
 namespace Halide {
 namespace Internal {
@@ -61,32 +62,91 @@ Expr rng32(Expr x) {
     return (((C2 * x) + C1) * x) + C0;
 }
 
+// The multiplier and key increment of the Philox-2x32 counter-based
+// generator, and the number of rounds to use. See "Parallel random
+// numbers: as easy as 1, 2, 3", Salmon et al., SC 2011.
+const uint32_t philox_multiplier = 0xD256D193;
+const uint32_t philox_key_increment = 0x9E3779B9;
+const int philox_rounds = 10;
+
+// Combine a list of 32-bit integers into a single 32-bit key, by
+// permuting them into each other with rng32.
+Expr combine_key(Expr key, const vector<Expr> &e, vector<std::pair<string, Expr>> &lets) {
+    for (Expr i : e) {
+        internal_assert(i.type() == Int(32) || i.type() == UInt(32));
+        Expr k = cast<uint32_t>(i);
+        if (key.defined()) {
+            k += key;
+        }
+        const uint64_t *ik = as_const_uint(simplify(k));
+        if (ik) {
+            // If it's a const, save the simplifier some work.
+            key = rng32(make_const(UInt(32), *ik));
+        } else {
+            string name = unique_name('R');
+            lets.push_back({name, k});
+            key = rng32(Variable::make(UInt(32), name));
+        }
+    }
+    return key;
 }
 
-Expr random_int(const vector<Expr> &e) {
-    internal_assert(e.size());
-    internal_assert(e[0].type() == Int(32) || e[0].type() == UInt(32));
-    // Permute the first term
-    Expr result = rng32(cast(UInt(32), e[0]));
-    for (size_t i = 1; i < e.size(); i++) {
-        internal_assert(e[i].type() == Int(32) || e[i].type() == UInt(32));
-        // Add in the next term and permute again
-        string name = unique_name('R');
-        // If it's a const, save the simplifier some work
-        const uint64_t *ir = as_const_uint(result);
-        const uint64_t *ie = as_const_uint(e[i]);
-        if (ir && ie) {
-            result = rng32(make_const(UInt(32), (*ir) + (*ie)));
+// Compute the first word of Philox-2x32-10 of the counter (c0, c1)
+// with key k. Each round is one 32x32->64 bit multiply, which
+// vectorizes as a widening multiply, and some xors.
+Expr philox(Expr c0, Expr c1, Expr k, vector<std::pair<string, Expr>> &lets) {
+    for (int i = 0; i < philox_rounds; i++) {
+        Expr product = cast<uint64_t>(c0) * make_const(UInt(64), philox_multiplier);
+        Expr hi = cast<uint32_t>(product >> 32);
+        Expr lo = c0 * make_const(UInt(32), philox_multiplier);
+        Expr round_key = simplify(k + make_const(UInt(32), philox_key_increment * (uint32_t)i));
+
+        string name0 = unique_name('R');
+        string name1 = unique_name('R');
+        lets.push_back({name0, hi ^ c1 ^ round_key});
+        lets.push_back({name1, lo});
+        c0 = Variable::make(UInt(32), name0);
+        c1 = Variable::make(UInt(32), name1);
+    }
+    return c0;
+}
+
+Expr wrap_in_lets(Expr e, const vector<std::pair<string, Expr>> &lets) {
+    for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+        e = Let::make(it->first, it->second, e);
+    }
+    return e;
+}
+
+}
+
+Expr random_int(const vector<Expr> &key, const vector<Expr> &counter) {
+    internal_assert(key.size());
+
+    // The values of the lets used to share subexpressions, in order
+    // of definition.
+    vector<std::pair<string, Expr>> lets;
+
+    // The first two counter values are the counter of a Philox-2x32
+    // generator. Any further values are combined into its key, along
+    // with the key values.
+    Expr c[2] = {make_zero(UInt(32)), make_zero(UInt(32))};
+    vector<Expr> key_values = key;
+    for (size_t i = 0; i < counter.size(); i++) {
+        internal_assert(counter[i].type() == Int(32) || counter[i].type() == UInt(32));
+        if (i < 2) {
+            c[i] = cast<uint32_t>(counter[i]);
         } else {
-            result = Let::make(name, result + cast<uint32_t>(e[i]),
-                               rng32(Variable::make(UInt(32), name)));
+            key_values.push_back(counter[i]);
         }
     }
-    return result;
+    Expr k = combine_key(Expr(), key_values, lets);
+
+    return wrap_in_lets(philox(c[0], c[1], k, lets), lets);
 }
 
-Expr random_float(const vector<Expr> &e) {
-    Expr result = random_int(e);
+Expr random_float(const vector<Expr> &key, const vector<Expr> &counter) {
+    Expr result = random_int(key, counter);
     // Set the exponent to one, and fill the mantissa with 23 random bits.
     result = (127 << 23) | (cast<uint32_t>(result) >> 9);
     // The clamp is purely for the benefit of bounds inference.
@@ -98,14 +158,16 @@ class LowerRandom : public IRMutator {
 
     void visit(const Call *op) {
         if (op->is_intrinsic(Call::random)) {
-            vector<Expr> args = op->args;
-            args.insert(args.end(), extra_args.begin(), extra_args.end());
+            // The seed and the identity of the call select the stream,
+            // and the free vars the position in it.
+            vector<Expr> key = op->args;
+            key.push_back(tag);
             if (op->type == Float(32)) {
-                expr = random_float(args);
+                expr = random_float(key, free_vars);
             } else if (op->type == Int(32)) {
-                expr = cast<int32_t>(random_int(args));
+                expr = cast<int32_t>(random_int(key, free_vars));
             } else if (op->type == UInt(32)) {
-                expr = random_int(args);
+                expr = random_int(key, free_vars);
             } else {
                 internal_error << "The intrinsic random() returns an Int(32), UInt(32) or a Float(32).\n";
             }
@@ -114,13 +176,13 @@ class LowerRandom : public IRMutator {
         }
     }
 
-    vector<Expr> extra_args;
+    vector<Expr> free_vars;
+    int tag;
 public:
-    LowerRandom(const vector<string> &free_vars, int tag) {
-        extra_args.push_back(tag);
+    LowerRandom(const vector<string> &free_vars, int tag) : tag(tag) {
         for (size_t i = 0; i < free_vars.size(); i++) {
             internal_assert(!free_vars[i].empty());
-            extra_args.push_back(Variable::make(Int(32), free_vars[i]));
+            this->free_vars.push_back(Variable::make(Int(32), free_vars[i]));
         }
     }
 };
@@ -130,5 +192,29 @@ Expr lower_random(Expr e, const vector<string> &free_vars, int tag) {
     return r.mutate(e);
 }
 
+void random_test() {
+    // Known answers for Philox-2x32-10, from the Random123 library.
+    struct {
+        uint32_t c0, c1, k, result;
+    } tests[] = {
+        {0, 0, 0, 0xff1dae59},
+        {0xffffffff, 0xffffffff, 0xffffffff, 0x2c3f628b},
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0xdd7ce038},
+    };
+    for (const auto &t : tests) {
+        vector<std::pair<string, Expr>> lets;
+        Expr c0 = make_const(UInt(32), t.c0);
+        Expr c1 = make_const(UInt(32), t.c1);
+        Expr k = make_const(UInt(32), t.k);
+        Expr result = simplify(wrap_in_lets(philox(c0, c1, k, lets), lets));
+        const uint64_t *r = as_const_uint(result);
+        internal_assert(r && *r == t.result)
+            << "Philox-2x32-10 of (" << t.c0 << ", " << t.c1 << ") with key " << t.k
+            << " is " << result << " instead of " << t.result << "\n";
+    }
+
+    std::cout << "Random test passed" << std::endl;
+}
+
 }
 }
@@ -12,19 +12,29 @@ namespace Halide {
 namespace Internal {
 
 /** Return a random floating-point number between zero and one that
- * varies deterministically based on the input expressions. */
-Expr random_float(const std::vector<Expr> &);
+ * varies deterministically based on the input expressions. See
+ * random_int. */
+Expr random_float(const std::vector<Expr> &key, const std::vector<Expr> &counter);
 
 /** Return a random unsigned integer between zero and 2^32-1 that
  * varies deterministically based on the input expressions (which must
- * be integers or unsigned integers). */
-Expr random_int(const std::vector<Expr> &);
+ * be integers or unsigned integers). This is a Philox-2x32-10
+ * counter-based generator: the key selects an independent stream,
+ * and the counter selects the position in that stream. The first two
+ * counter values are used as the Philox counter, and any more are
+ * combined into the key. Each value costs ten 32x32->64 bit
+ * multiplies, which vectorize. */
+Expr random_int(const std::vector<Expr> &key, const std::vector<Expr> &counter);
 
 /** Convert calls to random() to IR generated by random_float and
- * random_int. Tags all calls with the variables in free_vars, and the
- * integer given as the last argument. */
+ * random_int. The arguments of each call (the seed, if any, and the
+ * identity of the call) and the integer tag form the key, and the
+ * variables in free_vars form the counter. The result depends only on
+ * the values of those variables, not on the schedule. */
 Expr lower_random(Expr e, const std::vector<std::string> &free_vars, int tag);
 
+EXPORT void random_test();
+
 }
 }
 
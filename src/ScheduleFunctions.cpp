@@ -375,7 +375,8 @@ Stmt build_provide_loop_nest(string func_name,
                              string prefix,
                              const vector<string> &dims,
                              const Definition &def,
-                             bool is_update) {
+                             bool is_update,
+                             const Target &target) {
 
     internal_assert(!is_update == def.is_init());
 
@@ -403,12 +404,26 @@ Stmt build_provide_loop_nest(string func_name,
 
     // Make any specialized copies
     const vector<Specialization> &specializations = def.specializations();
+
+    // When JIT compiling lazily, tag the start of each specialized
+    // copy. The JIT pulls the tagged branches out into separate
+    // functions that are only compiled when first run. The default
+    // case is always compiled up front.
+    bool lazy = (!specializations.empty() &&
+                 target.has_feature(Target::JIT) &&
+                 target.has_feature(Target::LazySpecializations) &&
+                 !target.has_gpu_feature());
+    Stmt marker = Evaluate::make(Call::make(Int(32), Call::lazy_specialization, {}, Call::Intrinsic));
+
     for (size_t i = specializations.size(); i > 0; i--) {
         Expr c = specializations[i-1].condition;
         const Definition &s_def = specializations[i-1].definition;
 
         Stmt then_case =
-            build_provide_loop_nest(func_name, prefix, dims, s_def, is_update);
+            build_provide_loop_nest(func_name, prefix, dims, s_def, is_update, target);
+        if (lazy) {
+            then_case = Block::make(marker, then_case);
+        }
 
         stmt = IfThenElse::make(c, then_case, stmt);
     }
@@ -422,7 +437,7 @@ Stmt build_provide_loop_nest(string func_name,
 // which it should be realized. It will compute at least those
 // bounds (depending on splits, it may compute more). This loop
 // won't do any allocation.
-Stmt build_produce(Function f) {
+Stmt build_produce(Function f, const Target &target) {
 
     if (f.has_extern_definition()) {
         // Call the external function
@@ -545,12 +560,12 @@ Stmt build_produce(Function f) {
 
         string prefix = f.name() + ".s0.";
         vector<string> dims = f.args();
-        return build_provide_loop_nest(f.name(), prefix, dims, f.definition(), false);
+        return build_provide_loop_nest(f.name(), prefix, dims, f.definition(), false, target);
     }
 }
 
 // Build the loop nests that update a function (assuming it's a reduction).
-vector<Stmt> build_update(Function f) {
+vector<Stmt> build_update(Function f, const Target &target) {
 
     vector<Stmt> updates;
 
@@ -560,16 +575,16 @@ vector<Stmt> build_update(Function f) {
         string prefix = f.name() + ".s" + std::to_string(i+1) + ".";
 
         vector<string> dims = f.args();
-        Stmt loop = build_provide_loop_nest(f.name(), prefix, dims, def, true);
+        Stmt loop = build_provide_loop_nest(f.name(), prefix, dims, def, true, target);
         updates.push_back(loop);
     }
 
     return updates;
 }
 
-pair<Stmt, Stmt> build_production(Function func) {
-    Stmt produce = build_produce(func);
-    vector<Stmt> updates = build_update(func);
+pair<Stmt, Stmt> build_production(Function func, const Target &target) {
+    Stmt produce = build_produce(func, target);
+    vector<Stmt> updates = build_update(func, target);
 
     // Combine the update steps
     Stmt merged_updates = Block::make(updates);
@@ -657,7 +672,7 @@ private:
     string producing;
 
     Stmt build_pipeline(Stmt s) {
-        pair<Stmt, Stmt> realization = build_production(func);
+        pair<Stmt, Stmt> realization = build_production(func, target);
 
         return ProducerConsumer::make(func.name(), realization.first, realization.second, s);
     }
@@ -1,15 +1,20 @@
 #ifndef HALIDE_SCOPE_H
 #define HALIDE_SCOPE_H
 
+#include <algorithm>
 #include <string>
 #include <map>
+#include <memory>
 #include <stack>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <iostream>
 
 #include "Util.h"
 #include "Debug.h"
 #include "Error.h"
+#include "Symbol.h"
 
 /** \file
  * Defines the Scope class, which is used for keeping track of names in a scope while traversing IR
@@ -69,11 +74,17 @@ public:
 /** A common pattern when traversing Halide IR is that you need to
  * keep track of stuff when you find a Let or a LetStmt, and that it
  * should hide previous values with the same name until you leave the
- * Let or LetStmt nodes This class helps with that. */
+ * Let or LetStmt nodes This class helps with that. The table is keyed
+ * on interned Symbols, so lookups with the symbol() of a Variable,
+ * Let, LetStmt or For node hash a pointer rather than the name. The
+ * lookups by name find the Symbol of the name first. Iteration is in
+ * the order of the names, so that it doesn't depend on where the
+ * names were interned. */
 template<typename T>
 class Scope {
 private:
-    std::map<std::string, SmallStack<T>> table;
+    typedef std::unordered_map<Symbol, SmallStack<T>, Symbol::Hash> Table;
+    Table table;
 
     // Copying a scope object copies a large table full of strings and
     // stacks. Bad idea.
@@ -82,6 +93,18 @@ private:
 
     const Scope<T> *containing_scope;
 
+    // The entries of a table, sorted by name.
+    template<typename Iter, typename Tab>
+    static std::shared_ptr<std::vector<Iter>> sorted_entries(Tab &t) {
+        std::shared_ptr<std::vector<Iter>> entries = std::make_shared<std::vector<Iter>>();
+        for (Iter i = t.begin(); i != t.end(); ++i) {
+            entries->push_back(i);
+        }
+        std::sort(entries->begin(), entries->end(), [](const Iter &a, const Iter &b) {
+                return a->first.name() < b->first.name();
+            });
+        return entries;
+    }
 
 public:
     Scope() : containing_scope(nullptr) {}
@@ -102,30 +125,46 @@ public:
     }
 
     /** Retrieve the value referred to by a name */
-    T get(const std::string &name) const {
-        typename std::map<std::string, SmallStack<T>>::const_iterator iter = table.find(name);
+    T get(Symbol name) const {
+        typename Table::const_iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             if (containing_scope) {
                 return containing_scope->get(name);
             } else {
-                internal_error << "Symbol '" << name << "' not found\n";
+                internal_error << "Symbol '" << (name.defined() ? name.name() : "") << "' not found\n";
             }
         }
         return iter->second.top();
     }
 
+    T get(const std::string &name) const {
+        Symbol s = Symbol::find(name);
+        if (!s.defined()) {
+            internal_error << "Symbol '" << name << "' not found\n";
+        }
+        return get(s);
+    }
+
     /** Return a reference to an entry. Does not consider the containing scope. */
-    T &ref(const std::string &name) {
-        typename std::map<std::string, SmallStack<T>>::iterator iter = table.find(name);
+    T &ref(Symbol name) {
+        typename Table::iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
-            internal_error << "Symbol '" << name << "' not found\n";
+            internal_error << "Symbol '" << (name.defined() ? name.name() : "") << "' not found\n";
         }
         return iter->second.top_ref();
     }
 
+    T &ref(const std::string &name) {
+        Symbol s = Symbol::find(name);
+        if (!s.defined()) {
+            internal_error << "Symbol '" << name << "' not found\n";
+        }
+        return ref(s);
+    }
+
     /** Tests if a name is in scope */
-    bool contains(const std::string &name) const {
-        typename std::map<std::string, SmallStack<T>>::const_iterator iter = table.find(name);
+    bool contains(Symbol name) const {
+        typename Table::const_iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             if (containing_scope) {
                 return containing_scope->contains(name);
@@ -136,100 +175,120 @@ public:
         return true;
     }
 
+    bool contains(const std::string &name) const {
+        Symbol s = Symbol::find(name);
+        return s.defined() && contains(s);
+    }
+
     /** Add a new (name, value) pair to the current scope. Hide old
      * values that have this name until we pop this name.
      */
-    void push(const std::string &name, const T &value) {
+    void push(Symbol name, const T &value) {
         table[name].push(value);
     }
 
+    void push(const std::string &name, const T &value) {
+        push(Symbol(name), value);
+    }
+
     /** A name goes out of scope. Restore whatever its old value
      * was (or remove it entirely if there was nothing else of the
      * same name in an outer scope) */
-    void pop(const std::string &name) {
-        typename std::map<std::string, SmallStack<T>>::iterator iter = table.find(name);
-        internal_assert(iter != table.end()) << "Name not in symbol table: " << name << "\n";
+    void pop(Symbol name) {
+        typename Table::iterator iter = table.find(name);
+        internal_assert(iter != table.end())
+            << "Name not in symbol table: " << (name.defined() ? name.name() : "") << "\n";
         iter->second.pop();
         if (iter->second.empty()) {
             table.erase(iter);
         }
     }
 
-    /** Iterate through the scope. Does not capture any containing scope. */
+    void pop(const std::string &name) {
+        Symbol s = Symbol::find(name);
+        internal_assert(s.defined()) << "Name not in symbol table: " << name << "\n";
+        pop(s);
+    }
+
+    /** Iterate through the scope, in the order of the names. Does not
+     * capture any containing scope. The scope must not be changed
+     * while iterating. */
     class const_iterator {
-        typename std::map<std::string, SmallStack<T>>::const_iterator iter;
+        std::shared_ptr<std::vector<typename Table::const_iterator>> entries;
+        size_t index;
     public:
-        explicit const_iterator(const typename std::map<std::string, SmallStack<T>>::const_iterator &i) :
-            iter(i) {
+        const_iterator(std::shared_ptr<std::vector<typename Table::const_iterator>> e, size_t i) :
+            entries(e), index(i) {
         }
 
-        const_iterator() {}
+        const_iterator() : index(0) {}
 
         bool operator!=(const const_iterator &other) {
-            return iter != other.iter;
+            return index != other.index;
         }
 
         void operator++() {
-            ++iter;
+            ++index;
         }
 
         const std::string &name() {
-            return iter->first;
+            return (*entries)[index]->first.name();
         }
 
         const SmallStack<T> &stack() {
-            return iter->second;
+            return (*entries)[index]->second;
         }
 
         const T &value() {
-            return iter->second.top_ref();
+            return (*entries)[index]->second.top_ref();
         }
     };
 
     const_iterator cbegin() const {
-        return const_iterator(table.begin());
+        return const_iterator(sorted_entries<typename Table::const_iterator>(table), 0);
     }
 
     const_iterator cend() const {
-        return const_iterator(table.end());
+        return const_iterator(nullptr, table.size());
     }
 
     class iterator {
-        typename std::map<std::string, SmallStack<T>>::iterator iter;
+        std::shared_ptr<std::vector<typename Table::iterator>> entries;
+        size_t index;
     public:
-        explicit iterator(typename std::map<std::string, SmallStack<T>>::iterator i) :
-            iter(i) {
+        iterator(std::shared_ptr<std::vector<typename Table::iterator>> e, size_t i) :
+            entries(e), index(i) {
         }
 
-        iterator() {}
+        iterator() : index(0) {}
 
         bool operator!=(const iterator &other) {
-            return iter != other.iter;
+            return index != other.index;
         }
 
         void operator++() {
-            ++iter;
+            ++index;
         }
 
         const std::string &name() {
-            return iter->first;
+            return (*entries)[index]->first.name();
         }
 
         SmallStack<T> &stack() {
-            return iter->second;
+            return (*entries)[index]->second;
         }
 
         T &value() {
-            return iter->second.top_ref();
+            return (*entries)[index]->second.top_ref();
         }
     };
 
     iterator begin() {
-        return iterator(table.begin());
+        return iterator(sorted_entries<typename Table::iterator>(table), 0);
     }
 
     iterator end() {
-        return iterator(table.end());
+        return iterator(nullptr, table.size());
     }
 
     void swap(Scope<T> &other) {
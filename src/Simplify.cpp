@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <map>
 #include <stdio.h>
 
 #include "Simplify.h"
@@ -171,8 +172,8 @@ private:
             *min_val = *max_val = *i;
             return true;
         } else if (const Variable *v = e.as<Variable>()) {
-            if (bounds_info.contains(v->name)) {
-                pair<int64_t, int64_t> b = bounds_info.get(v->name);
+            if (bounds_info.contains(v->symbol())) {
+                pair<int64_t, int64_t> b = bounds_info.get(v->symbol());
                 *min_val = b.first;
                 *max_val = b.second;
                 return true;
@@ -371,8 +372,8 @@ private:
     }
 
     void visit(const Variable *op) {
-        if (var_info.contains(op->name)) {
-            VarInfo &info = var_info.ref(op->name);
+        if (var_info.contains(op->symbol())) {
+            VarInfo &info = var_info.ref(op->symbol());
 
             // if replacement is defined, we should substitute it in (unless
             // it's a var that has been hidden by a nested scope).
@@ -3614,7 +3615,7 @@ private:
 
     template<typename T, typename Body>
     Body simplify_let(const T *op) {
-        internal_assert(!var_info.contains(op->name))
+        internal_assert(!var_info.contains(op->symbol()))
             << "Simplify only works on code where every name is unique. Repeated name: " << op->name << "\n";
 
         // If the value is trivial, make a note of it in the scope so
@@ -3715,7 +3716,7 @@ private:
         info.new_uses = 0;
         info.replacement = replacement;
 
-        var_info.push(op->name, info);
+        var_info.push(op->symbol(), info);
 
         // Before we enter the body, track the alignment info
         bool new_value_alignment_tracked = false, new_value_bounds_tracked = false;
@@ -3735,12 +3736,12 @@ private:
         if (no_overflow_scalar_int(value.type())) {
             ModulusRemainder mod_rem = modulus_remainder(value, alignment_info);
             if (mod_rem.modulus > 1) {
-                alignment_info.push(op->name, mod_rem);
+                alignment_info.push(op->symbol(), mod_rem);
                 value_alignment_tracked = true;
             }
             int64_t val_min, val_max;
             if (const_int_bounds(value, &val_min, &val_max)) {
-                bounds_info.push(op->name, make_pair(val_min, val_max));
+                bounds_info.push(op->symbol(), make_pair(val_min, val_max));
                 value_bounds_tracked = true;
             }
         }
@@ -3748,10 +3749,10 @@ private:
         body = mutate(body);
 
         if (value_alignment_tracked) {
-            alignment_info.pop(op->name);
+            alignment_info.pop(op->symbol());
         }
         if (value_bounds_tracked) {
-            bounds_info.pop(op->name);
+            bounds_info.pop(op->symbol());
         }
         if (new_value_alignment_tracked) {
             alignment_info.pop(new_name);
@@ -3760,8 +3761,8 @@ private:
             bounds_info.pop(new_name);
         }
 
-        info = var_info.get(op->name);
-        var_info.pop(op->name);
+        info = var_info.get(op->symbol());
+        var_info.pop(op->symbol());
 
         Body result = body;
 
@@ -3829,13 +3830,13 @@ private:
             const_int(new_extent, &new_extent_int)) {
             bounds_tracked = true;
             int64_t new_max_int = new_min_int + new_extent_int - 1;
-            bounds_info.push(op->name, make_pair(new_min_int, new_max_int));
+            bounds_info.push(op->symbol(), make_pair(new_min_int, new_max_int));
         }
 
         Stmt new_body = mutate(op->body);
 
         if (bounds_tracked) {
-            bounds_info.pop(op->name);
+            bounds_info.pop(op->symbol());
         }
 
         if (is_no_op(new_body)) {
@@ -4035,10 +4036,224 @@ private:
     }
 };
 
+// The results of simplifying Exprs with no outside bounds or
+// alignment information, which is a pure function of the Expr and of
+// the Functions, Parameters and Buffers it refers to.
+struct SimplifyCache {
+    // The Functions, Parameters, Buffers and reduction domains an Expr
+    // refers to, in the order they are visited. IRDeepCompare only
+    // compares names, so two structurally equal Exprs may refer to
+    // different objects, e.g. Params of the same name in two
+    // pipelines. A cached result can only be reused for an Expr that
+    // refers to the same objects.
+    struct Refs {
+        std::vector<IntrusivePtr<FunctionContents>> funcs;
+        std::vector<Parameter> params;
+        std::vector<Buffer> images;
+        std::vector<ReductionDomain> domains;
+
+        bool same_as(const Refs &other) const {
+            if (funcs.size() != other.funcs.size() ||
+                params.size() != other.params.size() ||
+                images.size() != other.images.size() ||
+                domains.size() != other.domains.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < funcs.size(); i++) {
+                if (!funcs[i].same_as(other.funcs[i])) return false;
+            }
+            for (size_t i = 0; i < params.size(); i++) {
+                if (!params[i].same_as(other.params[i])) return false;
+            }
+            for (size_t i = 0; i < images.size(); i++) {
+                if (!images[i].same_as(other.images[i])) return false;
+            }
+            for (size_t i = 0; i < domains.size(); i++) {
+                if (!domains[i].same_as(other.domains[i])) return false;
+            }
+            return true;
+        }
+    };
+
+    struct Entry {
+        Refs refs;
+        Expr result;
+        // Whether the result was the input itself. Callers use
+        // same_as to detect when the simplifier changed something, so
+        // a hit on an equal but distinct Expr must return that Expr
+        // rather than the cached one.
+        bool unchanged;
+    };
+
+    size_t entries = 0, hits = 0, misses = 0, skipped = 0;
+    std::map<Expr, std::vector<Entry>, IRDeepCompare> results;
+
+    // Smaller Exprs (a constant, a variable, x + 1) are simplified in
+    // less time than it takes to find their refs and look them up, so
+    // they aren't cached.
+    static const int min_nodes = 8;
+
+    // Bound the memory held on very large pipelines.
+    static const size_t max_entries = 1 << 16;
+};
+
+namespace {
+
+// The innermost cache of the lowering running on this thread, if
+// any. Each lowering has its own cache, so no locking is needed, and
+// nothing is shared between pipelines.
+thread_local SimplifyCache *current_simplify_cache = nullptr;
+
+class FindRefs : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) {
+        if (op->param.defined()) {
+            refs.params.push_back(op->param);
+        }
+        if (op->image.defined()) {
+            refs.images.push_back(op->image);
+        }
+        if (op->reduction_domain.defined()) {
+            refs.domains.push_back(op->reduction_domain);
+        }
+    }
+
+    void visit(const Load *op) {
+        IRVisitor::visit(op);
+        if (op->param.defined()) {
+            refs.params.push_back(op->param);
+        }
+        if (op->image.defined()) {
+            refs.images.push_back(op->image);
+        }
+    }
+
+    void visit(const Call *op) {
+        IRVisitor::visit(op);
+        if (op->func.defined()) {
+            refs.funcs.push_back(op->func);
+        }
+        if (op->param.defined()) {
+            refs.params.push_back(op->param);
+        }
+        if (op->image.defined()) {
+            refs.images.push_back(op->image);
+        }
+    }
+public:
+    SimplifyCache::Refs refs;
+};
+
+// Counts the nodes of an Expr, stopping once there are enough.
+class CountNodes : public IRGraphVisitor {
+public:
+    using IRGraphVisitor::visit;
+    using IRGraphVisitor::include;
+
+    // Count shared subexpressions once per use, and don't bother
+    // remembering what has been visited.
+    void include(const Expr &e) {
+        if (count < limit) {
+            count++;
+            e.accept(this);
+        }
+    }
+
+    int count = 0;
+    const int limit;
+    CountNodes(int limit) : limit(limit) {}
+};
+
+bool has_at_least_nodes(Expr e, int n) {
+    CountNodes c(n);
+    c.include(e);
+    return c.count >= n;
+}
+
+SimplifyCache::Refs find_refs(Expr e) {
+    FindRefs f;
+    e.accept(&f);
+    return f.refs;
+}
+
+// Overflow errors are distinct from each other on purpose (see
+// signed_integer_overflow_error), so results containing them can't be
+// shared.
+class ContainsOverflowError : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::signed_integer_overflow)) {
+            result = true;
+        } else {
+            IRGraphVisitor::visit(op);
+        }
+    }
+public:
+    bool result = false;
+};
+
+bool contains_overflow_error(Expr e) {
+    ContainsOverflowError c;
+    e.accept(&c);
+    return c.result;
+}
+
+}
+
+ScopedSimplifyCache::ScopedSimplifyCache() :
+    cache(new SimplifyCache), previous(current_simplify_cache) {
+    current_simplify_cache = cache.get();
+}
+
+ScopedSimplifyCache::~ScopedSimplifyCache() {
+    debug(1) << "Simplify cache: " << cache->hits << " hits, "
+             << cache->misses << " misses, "
+             << cache->skipped << " too small to cache\n";
+    current_simplify_cache = previous;
+}
+
 Expr simplify(Expr e, bool simplify_lets,
               const Scope<Interval> &bounds,
               const Scope<ModulusRemainder> &alignment) {
-    return Simplify(simplify_lets, &bounds, &alignment).mutate(e);
+    SimplifyCache *cache = current_simplify_cache;
+    bool cacheable = (cache && e.defined() && simplify_lets &&
+                      &bounds == &Scope<Interval>::empty_scope() &&
+                      &alignment == &Scope<ModulusRemainder>::empty_scope());
+
+    if (cacheable && !has_at_least_nodes(e, SimplifyCache::min_nodes)) {
+        cache->skipped++;
+        cacheable = false;
+    }
+
+    SimplifyCache::Refs refs;
+    if (cacheable) {
+        refs = find_refs(e);
+        auto iter = cache->results.find(e);
+        if (iter != cache->results.end()) {
+            for (const SimplifyCache::Entry &entry : iter->second) {
+                if (entry.refs.same_as(refs)) {
+                    cache->hits++;
+                    return entry.unchanged ? e : entry.result;
+                }
+            }
+        }
+        cache->misses++;
+    }
+
+    Expr result = Simplify(simplify_lets, &bounds, &alignment).mutate(e);
+
+    if (cacheable && !contains_overflow_error(result)) {
+        if (cache->entries >= SimplifyCache::max_entries) {
+            cache->results.clear();
+            cache->entries = 0;
+        }
+        cache->results[e].push_back({refs, result, result.same_as(e)});
+        cache->entries++;
+    }
+
+    return result;
 }
 
 Stmt simplify(Stmt s, bool simplify_lets,
@@ -5037,6 +5252,43 @@ void simplify_test() {
         check(e, e);
     }
 
+    {
+        // Cached results match uncached ones, and an Expr the
+        // simplifier leaves alone comes back as itself.
+        ScopedSimplifyCache cache;
+        Expr e1 = (x + 3) * 2 - x, e2 = (x + 3) * 2 - x;
+        Expr r1 = simplify(e1), r2 = simplify(e2);
+        internal_assert(equal(r1, r2) && equal(r1, x + 6))
+            << "Cached simplification gave " << r2 << " instead of " << r1 << "\n";
+        Expr s1 = x * y + z, s2 = x * y + z;
+        internal_assert(simplify(s1).same_as(s1) && simplify(s2).same_as(s2))
+            << "Cached simplification changed an already simple Expr\n";
+
+        // Params with the same name in different pipelines are
+        // different Exprs to the cache.
+        Parameter p1(Int(32), false, 0, "p"), p2(Int(32), false, 0, "p");
+        Expr v1 = Variable::make(Int(32), "p", p1), v2 = Variable::make(Int(32), "p", p2);
+        simplify(v2 + 0);
+        const Variable *r = simplify(v1 + 0).as<Variable>();
+        internal_assert(r && r->param.same_as(p1))
+            << "Cached simplification returned a Variable of the wrong Parameter\n";
+    }
+
+    {
+        // All of the checks above give the same results with a cache,
+        // both when it is empty and when it holds all their results.
+        ScopedSimplifyCache cache;
+        for (int i = 0; i < 2; i++) {
+            check_casts();
+            check_algebra();
+            check_vectors();
+            check_bounds();
+            check_math();
+            check_boolean();
+            check_overflow();
+        }
+    }
+
     std::cout << "Simplify test passed" << std::endl;
 }
 }
@@ -6,6 +6,7 @@
  */
 
 #include <cmath>
+#include <memory>
 
 #include "IR.h"
 #include "Bounds.h"
@@ -29,6 +30,27 @@ EXPORT Expr simplify(Expr, bool simplify_lets = true,
                      const Scope<ModulusRemainder> &alignment = Scope<ModulusRemainder>::empty_scope());
 // @}
 
+struct SimplifyCache;
+
+/** While one of these exists, simplify() on an Expr with no bounds or
+ * alignment information, on the same thread, remembers its result, so
+ * that structurally identical Exprs that refer to the same Functions,
+ * Parameters and Buffers are only simplified once. This also covers
+ * can_prove. lower() holds one for the duration of lowering, so each
+ * lowering has its own cache, which doesn't outlive the IR it refers
+ * to. */
+struct ScopedSimplifyCache {
+    EXPORT ScopedSimplifyCache();
+    EXPORT ~ScopedSimplifyCache();
+
+private:
+    std::unique_ptr<SimplifyCache> cache;
+    SimplifyCache *previous;
+
+    ScopedSimplifyCache(const ScopedSimplifyCache &);
+    ScopedSimplifyCache &operator=(const ScopedSimplifyCache &);
+};
+
 /** A common use of the simplifier is to prove boolean expressions are
  * true at compile time. Equivalent to is_one(simplify(e)) */
 EXPORT bool can_prove(Expr e);
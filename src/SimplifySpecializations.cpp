@@ -4,6 +4,7 @@
 #include "Simplify.h"
 #include "Substitute.h"
 #include "Definition.h"
+#include "Function.h"
 
 #include <set>
 
@@ -64,9 +65,75 @@ vector<Definition> propagate_specialization_in_definition(Definition &def) {
     return result;
 }
 
+// Find all the input buffer parameters loaded from by some Func.
+class FindBufferParams : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Call *op) {
+        IRVisitor::visit(op);
+        if (op->call_type == Call::Image && op->param.defined()) {
+            params[op->param.name()] = op->param;
+        }
+    }
+public:
+    map<string, Parameter> params;
+};
+
 }
 
+void add_stride_specializations(const vector<Function> &outputs, map<string, Function> &env) {
+    FindBufferParams finder;
+    for (const auto &iter : env) {
+        iter.second.accept(&finder);
+    }
+
+    map<string, Parameter> buffers = finder.params;
+    for (const Function &f : outputs) {
+        for (const Parameter &p : f.output_buffers()) {
+            buffers[p.name()] = p;
+        }
+    }
+
+    // Guard on unit stride in dimension 0 for every buffer the user
+    // left unconstrained. Once the condition is known true, the
+    // simplifier substitutes the stride into the indexing math of
+    // the specialized loop nest, which turns gathers and scatters
+    // into dense vector loads and stores. The strides of the other
+    // dimensions only scale the addresses of whole rows, so they are
+    // left alone. Nothing is guarded on the alignment of the mins or
+    // extents, as no later pass could make use of it.
+    Expr condition;
+    for (const auto &iter : buffers) {
+        const Parameter &p = iter.second;
+        if (p.dimensions() == 0 || p.stride_constraint(0).defined()) {
+            continue;
+        }
+        Expr stride = Variable::make(Int(32), p.name() + ".stride.0", p);
+        Expr dense = (stride == 1);
+        condition = condition.defined() ? (condition && dense) : dense;
+    }
+
+    if (!condition.defined()) {
+        debug(3) << "All buffer strides are already constrained. No stride specializations added\n";
+        return;
+    }
+
+    debug(3) << "Adding stride specialization: " << condition << "\n";
 
+    // Only the output Funcs get the fast path, which keeps the growth
+    // in code size to at most one copy of each output's loop nests
+    // (including whatever is computed within them).
+    for (const Function &out : outputs) {
+        Function f = env.at(out.name());
+        if (f.has_extern_definition()) {
+            continue;
+        }
+        f.definition().add_specialization(condition);
+        for (size_t i = 0; i < f.updates().size(); i++) {
+            f.update(i).add_specialization(condition);
+        }
+    }
+}
 
 void simplify_specializations(map<string, Function> &env) {
     for (auto &iter : env) {
@@ -14,6 +14,17 @@
 namespace Halide {
 namespace Internal {
 
+/** Add a specialization to each definition of the output Funcs that
+ * is taken when every input and output buffer whose stride in
+ * dimension 0 was left unconstrained (with set_stride(0, Expr()))
+ * turns out to have unit stride. Buffer parameters have a unit
+ * stride constraint in dimension 0 by default, so only those that
+ * clear it are guarded. The Funcs in env must be a private copy, as
+ * they are modified in place. Used when the SpecializeStrides target
+ * feature is set. */
+void add_stride_specializations(const std::vector<Function> &outputs,
+                                std::map<std::string, Function> &env);
+
 /** Try to simplify the RHS/LHS of a function's definition based on its
  * specializations. */
 void simplify_specializations(std::map<std::string, Function> &env);
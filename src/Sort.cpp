@@ -0,0 +1,305 @@
+#include <algorithm>
+
+#include "Sort.h"
+#include "ExprUsesVar.h"
+#include "IROperator.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "Util.h"
+
+namespace Halide {
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+using namespace Internal;
+
+namespace {
+
+// Make Batcher's odd-even merge sorting network for n values. Each
+// comparator is a pair of indices i < j, after which value i should
+// be the smaller of the two and value j the larger. The network is
+// made for the next power of two, padded with values larger than
+// everything else, which makes the comparators involving the padding
+// no-ops, so they are dropped.
+vector<pair<int, int>> sorting_network(int n) {
+    int padded = 1;
+    while (padded < n) {
+        padded *= 2;
+    }
+
+    vector<pair<int, int>> network;
+    for (int p = 1; p < padded; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j + k < padded; j += 2 * k) {
+                for (int i = 0; i < std::min(k, padded - j - k); i++) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && i + j + k < n) {
+                        network.push_back({i + j, i + j + k});
+                    }
+                }
+            }
+        }
+    }
+    return network;
+}
+
+// Run the sorting network on a list of Exprs. The sorted values are
+// variables bound by the lets, which are in order of definition.
+vector<Expr> sort_with_lets(const vector<Expr> &values, vector<pair<string, Expr>> &lets) {
+    user_assert(!values.empty()) << "Can't sort an empty list of Exprs.\n";
+
+    Type t = values[0].type();
+    vector<Expr> sorted;
+    for (Expr e : values) {
+        user_assert(e.defined()) << "Can't sort an undefined Expr.\n";
+        user_assert(e.type() == t)
+            << "Can't sort Exprs of different types: " << e << " has type "
+            << e.type() << ", but " << values[0] << " has type " << t << ".\n";
+        string name = unique_name('s');
+        lets.push_back({name, e});
+        sorted.push_back(Variable::make(t, name));
+    }
+
+    for (const pair<int, int> &c : sorting_network((int)values.size())) {
+        Expr a = sorted[c.first];
+        Expr b = sorted[c.second];
+        string lo = unique_name('s');
+        string hi = unique_name('s');
+        lets.push_back({lo, min(a, b)});
+        lets.push_back({hi, max(a, b)});
+        sorted[c.first] = Variable::make(t, lo);
+        sorted[c.second] = Variable::make(t, hi);
+    }
+    return sorted;
+}
+
+// Wrap an Expr in the lets it depends on, skipping the rest.
+Expr wrap_in_lets(Expr e, const vector<pair<string, Expr>> &lets) {
+    for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+        if (expr_uses_var(e, it->first)) {
+            e = Let::make(it->first, it->second, e);
+        }
+    }
+    return e;
+}
+
+// Get the value of an Expr at each point of a reduction domain with
+// constant bounds.
+vector<Expr> unroll_rdom(RDom r, Expr e, const string &name) {
+    user_assert(r.defined()) << name << " requires a defined reduction domain.\n";
+
+    const vector<ReductionVariable> &rvars = r.domain().domain();
+    vector<int> mins, maxs;
+    for (const ReductionVariable &rv : rvars) {
+        const int64_t *min = as_const_int(simplify(rv.min));
+        const int64_t *extent = as_const_int(simplify(rv.extent));
+        user_assert(min && extent)
+            << "The reduction domain of " << name << " must have constant bounds, but "
+            << rv.var << " has min " << rv.min << " and extent " << rv.extent << ".\n";
+        user_assert(*extent > 0)
+            << "The reduction domain of " << name << " is empty, because "
+            << rv.var << " has extent " << *extent << ".\n";
+        mins.push_back((int)*min);
+        maxs.push_back((int)(*min + *extent - 1));
+    }
+
+    Expr predicate = r.domain().predicate();
+
+    // Visit each point of the domain, with the first dimension
+    // innermost.
+    vector<Expr> values;
+    vector<int> point = mins;
+    while (true) {
+        map<string, Expr> replacements;
+        for (size_t i = 0; i < rvars.size(); i++) {
+            replacements[rvars[i].var] = point[i];
+        }
+
+        bool valid = true;
+        if (predicate.defined()) {
+            Expr p = simplify(substitute(replacements, predicate));
+            user_assert(is_const(p))
+                << "The predicate of the reduction domain of " << name
+                << " must be constant at each point, but it is " << p << ".\n";
+            valid = is_one(p);
+        }
+        if (valid) {
+            values.push_back(substitute(replacements, e));
+        }
+
+        size_t i = 0;
+        while (i < rvars.size() && point[i] == maxs[i]) {
+            point[i] = mins[i];
+            i++;
+        }
+        if (i == rvars.size()) {
+            break;
+        }
+        point[i]++;
+    }
+
+    user_assert(!values.empty())
+        << "The predicate of the reduction domain of " << name << " is never true.\n";
+    return values;
+}
+
+}  // namespace
+
+vector<Expr> sort_exprs(const vector<Expr> &values) {
+    vector<pair<string, Expr>> lets;
+    vector<Expr> sorted = sort_with_lets(values, lets);
+    for (Expr &e : sorted) {
+        e = wrap_in_lets(e, lets);
+    }
+    return sorted;
+}
+
+Expr kth_smallest(const vector<Expr> &values, int k) {
+    user_assert(0 <= k && k < (int)values.size())
+        << "Can't find the element with index " << k << " of "
+        << values.size() << " sorted Exprs.\n";
+    vector<pair<string, Expr>> lets;
+    vector<Expr> sorted = sort_with_lets(values, lets);
+    return wrap_in_lets(sorted[k], lets);
+}
+
+Expr median(const vector<Expr> &values) {
+    return kth_smallest(values, (int)values.size() / 2);
+}
+
+Expr kth_smallest(RDom r, Expr e, int k) {
+    return kth_smallest(unroll_rdom(r, e, "kth_smallest"), k);
+}
+
+Expr median(RDom r, Expr e) {
+    return median(unroll_rdom(r, e, "median"));
+}
+
+Func bitonic_sort(Func input, int size) {
+    user_assert(input.defined() && input.dimensions() == 1 && input.outputs() == 1)
+        << "bitonic_sort requires a one-dimensional Func with one output.\n";
+    user_assert(size >= 2 && (size & (size - 1)) == 0)
+        << "bitonic_sort requires a size that is a power of two, at least 2, not "
+        << size << ".\n";
+
+    Var x("x"), xo("xo"), xi("xi");
+
+    Func next, prev = input;
+    for (int pass_size = 1; pass_size < size; pass_size <<= 1) {
+        for (int chunk_size = pass_size; chunk_size > 0; chunk_size >>= 1) {
+            next = Func("bitonic_pass");
+            Expr chunk_start = (x/(2*chunk_size))*(2*chunk_size);
+            Expr chunk_end = (x/(2*chunk_size) + 1)*(2*chunk_size);
+            Expr chunk_middle = chunk_start + chunk_size;
+            Expr chunk_index = x - chunk_start;
+            Expr partner;
+            if (pass_size == chunk_size && pass_size > 1) {
+                // Flipped pass. We need a clamp here to help out
+                // bounds inference.
+                partner = 2*chunk_middle - x - 1;
+                partner = clamp(partner, chunk_start, chunk_end-1);
+            } else {
+                // Regular pass.
+                partner = chunk_start + (chunk_index + chunk_size) % (chunk_size*2);
+            }
+            next(x) = select(x < chunk_middle,
+                             min(prev(x), prev(partner)),
+                             max(prev(x), prev(partner)));
+
+            if (pass_size > 1) {
+                next.split(x, xo, xi, 2*chunk_size);
+            }
+            if (chunk_size > 128) {
+                next.parallel(xo);
+            }
+            next.compute_root();
+            prev = next;
+        }
+    }
+
+    next.bound(x, 0, size);
+    return next;
+}
+
+Func merge_sort(Func input, int size) {
+    user_assert(input.defined() && input.dimensions() == 1 && input.outputs() == 1)
+        << "merge_sort requires a one-dimensional Func with one output.\n";
+    user_assert(size >= 4 && (size & (size - 1)) == 0)
+        << "merge_sort requires a size that is a power of two, at least 4, not "
+        << size << ".\n";
+
+    Var x("x"), y("y");
+
+    // Each parallel task sorts a chunk of this many values.
+    const int task_size = std::min(size, 1024);
+    Func parallel_stage("merge_sort_task");
+
+    // First gather the input into a 2D array of width four where each
+    // row is sorted, using a sorting network.
+    Func result("merge_sort_4");
+    {
+        vector<Expr> v = sort_exprs({input(4*y), input(4*y+1), input(4*y+2), input(4*y+3)});
+        result(x, y) = select(x == 0, v[0],
+                              x == 1, v[1],
+                              x == 2, v[2],
+                              v[3]);
+        result.bound(x, 0, 4).unroll(x);
+    }
+    result.compute_at(parallel_stage, y);
+    if (task_size == 4) {
+        parallel_stage(x, y) = result(x, y);
+        parallel_stage.compute_root().parallel(y);
+        result = parallel_stage;
+    }
+
+    // Now build up to the total size, merging each pair of rows.
+    for (int chunk_size = 4; chunk_size < size; chunk_size *= 2) {
+        // Merge pairs of rows from the partial result. The first
+        // dimension of merge_rows is within the chunk, and the second
+        // dimension is the chunk index. Keeps track of two pointers
+        // we're merging from and an output value.
+        Func merge_rows("merge_rows");
+        RDom r(0, chunk_size*2);
+
+        merge_rows(x, y) = Tuple(0, 0, cast(input.output_types()[0], 0));
+
+        Expr candidate_a = merge_rows(r-1, y)[0];
+        Expr candidate_b = merge_rows(r-1, y)[1];
+        Expr valid_a = candidate_a < chunk_size;
+        Expr valid_b = candidate_b < chunk_size;
+        Expr value_a = result(clamp(candidate_a, 0, chunk_size-1), 2*y);
+        Expr value_b = result(clamp(candidate_b, 0, chunk_size-1), 2*y+1);
+        merge_rows(r, y) = tuple_select(valid_a && ((value_a < value_b) || !valid_b),
+                                        Tuple(candidate_a + 1, candidate_b, value_a),
+                                        Tuple(candidate_a, candidate_b + 1, value_b));
+
+        if (chunk_size*2 <= task_size) {
+            merge_rows.compute_at(parallel_stage, y);
+        } else {
+            // The merges of chunks larger than a task are independent
+            // for each pair of rows.
+            merge_rows.compute_root();
+            merge_rows.update().parallel(y);
+        }
+
+        if (chunk_size*2 == task_size) {
+            parallel_stage(x, y) = merge_rows(x, y)[2];
+            parallel_stage.compute_root().parallel(y);
+            result = parallel_stage;
+        } else {
+            Func merged("merged_rows");
+            merged(x, y) = merge_rows(x, y)[2];
+            result = merged;
+        }
+    }
+
+    // Convert back to 1D.
+    Func sorted("merge_sorted");
+    sorted(x) = result(x, 0);
+    sorted.bound(x, 0, size);
+    return sorted;
+}
+
+}
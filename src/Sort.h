@@ -0,0 +1,70 @@
+#ifndef HALIDE_SORT_H
+#define HALIDE_SORT_H
+
+#include "Func.h"
+#include "RDom.h"
+
+/** \file
+ * Defines sorting networks and order statistics over lists of Exprs
+ * and reduction domains, and sorts of one-dimensional Funcs.
+ */
+namespace Halide {
+
+/** Sort a list of Exprs of the same type into ascending order, using
+ * Batcher's odd-even merge sorting network of min and max
+ * operations. The network has no branches, so it vectorizes across
+ * any pure variables the Exprs depend on. This makes it suitable for
+ * per-pixel sorts of small windows, such as median filters. The
+ * intermediate values of the network are bound to lets, so the size
+ * of each result grows with the number of comparators, rather than
+ * exponentially with the depth of the network. */
+EXPORT std::vector<Expr> sort_exprs(const std::vector<Expr> &values);
+
+/** Find the k-th smallest (counting from zero) of a list of Exprs of
+ * the same type. This is element k of the result of \ref sort_exprs,
+ * and only the comparators of the sorting network that contribute to
+ * it are evaluated. */
+EXPORT Expr kth_smallest(const std::vector<Expr> &values, int k);
+
+/** Find the median of a list of Exprs of the same type, which is the
+ * k-th smallest with k = values.size() / 2. */
+EXPORT Expr median(const std::vector<Expr> &values);
+
+/** Variants of \ref kth_smallest and \ref median over the values of
+ * an expression at each point of a reduction domain. The reduction
+ * domain must have constant bounds, and if it has a predicate, the
+ * predicate must be constant at each point. The domain is unrolled
+ * into one Expr per point, so it should be small. Unlike the inline
+ * reductions, the result does not depend on the order of the points
+ * in the domain. For example, a 5x5 median filter is:
+ *
+ \code
+ Func in, median5x5;
+ Var x, y;
+ RDom r(-2, 5, -2, 5);
+ median5x5(x, y) = median(r, in(x + r.x, y + r.y));
+ \endcode
+ */
+// @{
+EXPORT Expr kth_smallest(RDom r, Expr e, int k);
+EXPORT Expr median(RDom r, Expr e);
+// @}
+
+/** Sort the values of a one-dimensional Func over [0, size) into
+ * ascending order with a bitonic sort. size must be a power of
+ * two. Each pass of the sort is a separate stage, computed at root
+ * and vectorizable, with the larger passes parallelized. The result
+ * is defined over [0, size). */
+EXPORT Func bitonic_sort(Func input, int size);
+
+/** Sort the values of a one-dimensional Func over [0, size) into
+ * ascending order with a merge sort. size must be a power of two, at
+ * least 4. Chunks of up to 1024 values are sorted in parallel, with
+ * sorting networks for the initial groups of four values, and the
+ * sorted chunks are then merged in parallel pairs. The result is
+ * defined over [0, size). */
+EXPORT Func merge_sort(Func input, int size);
+
+}
+
+#endif
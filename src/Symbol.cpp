@@ -0,0 +1,47 @@
+#include "Symbol.h"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+namespace {
+
+// The table of interned names is split into shards, each with its own
+// lock, so that threads lowering different pipelines at once rarely
+// wait for each other. The elements of an unordered_set don't move
+// when it grows, so the interned names can be handed out by address.
+const int shard_count = 64;
+
+struct Shard {
+    std::mutex lock;
+    std::unordered_set<string> names;
+};
+
+Shard &shard_for(const string &name) {
+    // The table is never destroyed, as Symbols may outlive static
+    // destructors.
+    static Shard *shards = new Shard[shard_count];
+    return shards[std::hash<string>()(name) % shard_count];
+}
+
+}
+
+Symbol::Symbol(const string &name) {
+    Shard &shard = shard_for(name);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    str = &*shard.names.insert(name).first;
+}
+
+Symbol Symbol::find(const string &name) {
+    Shard &shard = shard_for(name);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto iter = shard.names.find(name);
+    return iter == shard.names.end() ? Symbol() : Symbol(&*iter);
+}
+
+}
+}
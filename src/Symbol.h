@@ -0,0 +1,100 @@
+#ifndef HALIDE_SYMBOL_H
+#define HALIDE_SYMBOL_H
+
+/** \file
+ * Defines Symbol, an interned name that is cheap to compare and to
+ * hash, used to key Scope lookups on the names in the IR.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+/** A handle to an interned name. Each distinct name is stored once in
+ * a global table, so two Symbols are equal exactly when their names
+ * are, and comparing or hashing one doesn't look at the characters of
+ * the name. Interned names are never freed. Interning is safe to do
+ * from several threads at once. */
+class Symbol {
+    const std::string *str;
+
+    explicit Symbol(const std::string *s) : str(s) {}
+
+    friend class CachedSymbol;
+
+public:
+    /** An undefined Symbol, which matches no name. */
+    Symbol() : str(nullptr) {}
+
+    /** Intern a name, adding it to the table if it isn't already
+     * there. */
+    EXPORT explicit Symbol(const std::string &name);
+
+    /** Find the Symbol of a name without adding it to the table. If
+     * the name was never interned, the result is undefined. As Scope
+     * interns every name pushed onto it, such a name can't be in any
+     * Scope. */
+    EXPORT static Symbol find(const std::string &name);
+
+    bool defined() const {
+        return str != nullptr;
+    }
+
+    const std::string &name() const {
+        return *str;
+    }
+
+    bool operator==(const Symbol &other) const {
+        return str == other.str;
+    }
+
+    bool operator!=(const Symbol &other) const {
+        return str != other.str;
+    }
+
+    /** Hash a Symbol by the address of its interned name. */
+    struct Hash {
+        size_t operator()(const Symbol &s) const {
+            return std::hash<const std::string *>()(s.str);
+        }
+    };
+};
+
+/** The Symbol of the name of an IR node, interned the first time it
+ * is asked for. Nodes are shared between threads, so the cached
+ * handle is atomic. */
+class CachedSymbol {
+    mutable std::atomic<const std::string *> str;
+
+public:
+    CachedSymbol() : str(nullptr) {}
+
+    CachedSymbol(const CachedSymbol &other) : str(other.str.load(std::memory_order_acquire)) {}
+
+    CachedSymbol &operator=(const CachedSymbol &other) {
+        str.store(other.str.load(std::memory_order_acquire), std::memory_order_release);
+        return *this;
+    }
+
+    /** Get the Symbol of name, which must be the name of the node
+     * this belongs to. */
+    Symbol get(const std::string &name) const {
+        const std::string *s = str.load(std::memory_order_acquire);
+        if (!s) {
+            s = Symbol(name).str;
+            str.store(s, std::memory_order_release);
+        }
+        return Symbol(s);
+    }
+};
+
+}
+}
+
+#endif
@@ -249,6 +249,11 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"hvx_64", Target::HVX_64},
     {"hvx_128", Target::HVX_128},
     {"hvx_v62", Target::HVX_v62},
+    {"specialize_strides", Target::SpecializeStrides},
+    {"lazy_specializations", Target::LazySpecializations},
+    {"tiered_jit", Target::TieredJIT},
+    {"no_hoist_loop_invariants", Target::NoHoistLoopInvariants},
+    {"no_hash_consing", Target::NoHashConsing},
 };
 
 bool lookup_feature(const std::string &tok, Target::Feature &result) {
@@ -74,6 +74,11 @@ struct Target {
         HVX_64 = halide_target_feature_hvx_64,
         HVX_128 = halide_target_feature_hvx_128,
         HVX_v62 = halide_target_feature_hvx_v62,
+        SpecializeStrides = halide_target_feature_specialize_strides,
+        LazySpecializations = halide_target_feature_lazy_specializations,
+        TieredJIT = halide_target_feature_tiered_jit,
+        NoHoistLoopInvariants = halide_target_feature_no_hoist_loop_invariants,
+        NoHashConsing = halide_target_feature_no_hash_consing,
         FeatureEnd = halide_target_feature_end
     };
     Target() : os(OSUnknown), arch(ArchUnknown), bits(0) {}
@@ -88,6 +88,32 @@ int unique_count(size_t h) {
     h = h & (num_unique_name_counters - 1);
     return unique_name_counters[h]++;
 }
+
+std::atomic<int> next_unique_name_scope_id(0);
+
+// The innermost UniqueNameScope on this thread, if any.
+thread_local UniqueNameScope *current_unique_name_scope = nullptr;
+}
+
+UniqueNameScope::UniqueNameScope(int id) : id(id), previous(current_unique_name_scope) {
+    current_unique_name_scope = this;
+}
+
+UniqueNameScope::~UniqueNameScope() {
+    current_unique_name_scope = previous;
+}
+
+int UniqueNameScope::reserve_ids(int count) {
+    return next_unique_name_scope_id.fetch_add(count);
+}
+
+// Names made in a scope have two '$' signs, so they are in neither of
+// the first two families below, and the counters of the scope keep
+// them distinct from each other. unique_name('f') and
+// unique_name("f") share a counter, so they can't collide either.
+std::string UniqueNameScope::make_name(const std::string &sanitized_prefix) {
+    int count = counters[sanitized_prefix]++;
+    return sanitized_prefix + "$" + std::to_string(id) + "$" + std::to_string(count);
 }
 
 // There are three possible families of names returned by the methods below:
@@ -100,6 +126,9 @@ int unique_count(size_t h) {
 
 string unique_name(char prefix) {
     if (prefix == '$') prefix = '_';
+    if (current_unique_name_scope) {
+        return current_unique_name_scope->make_name(string(1, prefix));
+    }
     return prefix + std::to_string(unique_count((size_t)(prefix)));
 }
 
@@ -133,6 +162,10 @@ string unique_name(const std::string &prefix) {
     matches_string_pattern &= num_dollars == 1;
     matches_char_pattern &= prefix.size() > 1;
 
+    if (current_unique_name_scope) {
+        return current_unique_name_scope->make_name(sanitized);
+    }
+
     // Then add a suffix that's globally unique relative to the hash
     // of the sanitized name.
     int count = unique_count(std::hash<std::string>()(sanitized));
@@ -14,6 +14,7 @@
  * Various utility functions used internally Halide. */
 
 #include <cstdint>
+#include <map>
 #include <utility>
 #include <vector>
 #include <string>
@@ -89,6 +90,37 @@ EXPORT std::string unique_name(char prefix);
 EXPORT std::string unique_name(const std::string &prefix);
 // @}
 
+/** While one of these exists on a thread, unique_name on that thread
+ * counts names with counters of the scope's own, and always returns
+ * the sanitized prefix followed by '$', the id of the scope, '$' and
+ * the count (e.g. f$3$0). So the names made in the scope only depend
+ * on what that thread does, and not on other threads making names at
+ * the same time. Each id should only be used by one scope. Reserve
+ * them with reserve_ids on one thread, so that they are given out in
+ * a deterministic order. compile_multitarget uses these to lower
+ * several targets concurrently. */
+class UniqueNameScope {
+public:
+    EXPORT explicit UniqueNameScope(int id);
+    EXPORT ~UniqueNameScope();
+
+    /** Reserve count consecutive scope ids, and return the first. */
+    EXPORT static int reserve_ids(int count);
+
+private:
+    friend std::string unique_name(char prefix);
+    friend std::string unique_name(const std::string &prefix);
+
+    std::string make_name(const std::string &sanitized_prefix);
+
+    int id;
+    std::map<std::string, int> counters;
+    UniqueNameScope *previous;
+
+    UniqueNameScope(const UniqueNameScope &);
+    UniqueNameScope &operator=(const UniqueNameScope &);
+};
+
 /** Test if the first string starts with the second string */
 EXPORT bool starts_with(const std::string &str, const std::string &prefix);
 
@@ -675,7 +675,13 @@ typedef enum halide_target_feature_t {
     halide_target_feature_hvx_128 = 34, ///< Enable HVX 128 byte mode.
     halide_target_feature_hvx_v62 = 35, ///< Enable Hexagon v62 architecture.
 
-    halide_target_feature_end = 36 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
+    halide_target_feature_specialize_strides = 36, ///< Add a fast path to each output Func for buffers with unconstrained strides that turn out to be dense in dimension 0.
+    halide_target_feature_lazy_specializations = 37, ///< When JIT compiling, defer compiling each specialization until it is first used.
+    halide_target_feature_tiered_jit = 38, ///< When JIT compiling, compile quickly with few optimizations, then recompile fully optimized in the background.
+    halide_target_feature_no_hoist_loop_invariants = 39, ///< Don't move loop-invariant computation out of loops during lowering.
+    halide_target_feature_no_hash_consing = 40, ///< Don't share equal IR nodes during lowering.
+
+    halide_target_feature_end = 41 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
 /** This function is called internally by Halide in some situations to determine
@@ -0,0 +1,123 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+
+using namespace Halide;
+
+// Check the error of each fast approximate transcendental at each
+// precision against the bound of the precision, computing the correct
+// values in double precision. The error is relative for fast_exp, and
+// divided by max(1, |correct|) otherwise.
+
+Var x("x");
+
+const double bounds[] = {1e-3, 1e-5, 5e-7};
+const char *names[] = {"Low", "Medium", "High"};
+
+// Evaluate a unary approximation, vectorized, over the values of an
+// image, and return the worst error.
+double worst_error(std::function<Expr(Expr)> approx, double (*correct)(double),
+                   const Image<float> &in, bool relative) {
+    Func f;
+    f(x) = approx(in(x));
+    f.vectorize(x, 8);
+    Image<float> out = f.realize(in.width());
+
+    double worst = 0;
+    for (int i = 0; i < in.width(); i++) {
+        double c = correct(in(i));
+        double err = fabs(out(i) - c);
+        err /= relative ? fabs(c) : std::max(1.0, fabs(c));
+        worst = std::max(worst, err);
+    }
+    return worst;
+}
+
+Image<float> linear_range(double min, double max, int n) {
+    Image<float> im(n);
+    for (int i = 0; i < n; i++) {
+        im(i) = (float)(min + (max - min) * i / (n - 1));
+    }
+    return im;
+}
+
+Image<float> exponential_range(double min, double max, int n) {
+    Image<float> im(n);
+    for (int i = 0; i < n; i++) {
+        im(i) = (float)exp(min + (max - min) * i / (n - 1));
+    }
+    return im;
+}
+
+int main(int argc, char **argv) {
+    const int N = 100000;
+    Image<float> trig_range = linear_range(-10000, 10000, N);
+    Image<float> small_range = linear_range(-10, 10, N);
+    Image<float> wide_range = linear_range(-100, 100, N);
+    Image<float> exp_range = linear_range(-80, 80, N);
+    Image<float> log_range = exponential_range(-80, 80, N);
+
+    // Pairs of coordinates for atan2, including the axes and signed
+    // zeros.
+    const int W = 301;
+    Image<float> coords(W);
+    for (int i = 0; i < W; i++) {
+        coords(i) = (i - W / 2) / 15.0f;
+    }
+    coords(W / 2) = -0.0f;
+    coords(W / 2 + 1) = 0.0f;
+
+    const ApproximationPrecision precisions[] = {ApproximationPrecision::Low,
+                                                 ApproximationPrecision::Medium,
+                                                 ApproximationPrecision::High};
+
+    for (int p = 0; p < 3; p++) {
+        ApproximationPrecision precision = precisions[p];
+        struct {
+            const char *name;
+            std::function<Expr(Expr)> approx;
+            double (*correct)(double);
+            const Image<float> &in;
+            bool relative;
+        } tests[] = {
+            {"fast_sin", [=](Expr e) { return fast_sin(e, precision); }, sin, trig_range, false},
+            {"fast_cos", [=](Expr e) { return fast_cos(e, precision); }, cos, trig_range, false},
+            {"fast_sin", [=](Expr e) { return fast_sin(e, precision); }, sin, small_range, false},
+            {"fast_atan", [=](Expr e) { return fast_atan(e, precision); }, atan, wide_range, false},
+            {"fast_atan", [=](Expr e) { return fast_atan(e, precision); }, atan, log_range, false},
+            {"fast_tanh", [=](Expr e) { return fast_tanh(e, precision); }, tanh, small_range, false},
+            {"fast_exp", [=](Expr e) { return fast_exp(e, precision); }, exp, exp_range, true},
+            {"fast_log", [=](Expr e) { return fast_log(e, precision); }, log, log_range, false},
+        };
+
+        for (auto &t : tests) {
+            double err = worst_error(t.approx, t.correct, t.in, t.relative);
+            if (err > bounds[p]) {
+                printf("The error of %s with precision %s was %g, which exceeds the bound of %g\n",
+                       t.name, names[p], err, bounds[p]);
+                return -1;
+            }
+        }
+
+        Var y("y");
+        Func f;
+        f(x, y) = fast_atan2(coords(y), coords(x), precision);
+        f.vectorize(x, 8);
+        Image<float> out = f.realize(W, W);
+        for (int j = 0; j < W; j++) {
+            for (int i = 0; i < W; i++) {
+                double correct = atan2((double)coords(j), (double)coords(i));
+                if (fabs(out(i, j) - correct) > bounds[p]) {
+                    printf("fast_atan2(%f, %f) with precision %s was %f instead of %f\n",
+                           coords(j), coords(i), names[p], out(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+
+using namespace Halide;
+
+// Check conversions between half and single precision against
+// float16_t, at several vector widths, with and without F16C.
+
+Var x("x");
+
+int check_widening(const Image<float16_t> &in, const Target &target, int lanes) {
+    Func f;
+    f(x) = cast<float>(in(x));
+    if (lanes > 1) {
+        f.vectorize(x, lanes);
+    }
+    Image<float> out = f.realize(in.width(), target);
+
+    for (int i = 0; i < in.width(); i++) {
+        float correct = (float)in(i);
+        bool same = std::isnan(correct) ? std::isnan(out(i)) : out(i) == correct;
+        if (!same || std::signbit(out(i)) != std::signbit(correct)) {
+            printf("Widening 0x%04x with %d lanes on %s gave %g instead of %g\n",
+                   in(i).to_bits(), lanes, target.to_string().c_str(), out(i), correct);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int check_narrowing(const Image<float> &in, const Target &target, int lanes) {
+    Func f;
+    f(x) = cast(Float(16), in(x));
+    if (lanes > 1) {
+        f.vectorize(x, lanes);
+    }
+    Image<float16_t> out = f.realize(in.width(), target);
+
+    for (int i = 0; i < in.width(); i++) {
+        float16_t correct(in(i), RoundingMode::ToNearestTiesToEven);
+        bool same = correct.is_nan() ? out(i).is_nan() : out(i).to_bits() == correct.to_bits();
+        if (!same) {
+            printf("Narrowing %.10g with %d lanes on %s gave 0x%04x instead of 0x%04x\n",
+                   in(i), lanes, target.to_string().c_str(), out(i).to_bits(), correct.to_bits());
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // Every half float.
+    Image<float16_t> halves(1 << 16);
+    for (int i = 0; i < (1 << 16); i++) {
+        halves(i) = float16_t::make_from_bits((uint16_t)i);
+    }
+
+    // Floats near each half float, including the ties between
+    // neighbours, and some random bit patterns, which cover the
+    // overflows and the values too small to round to anything but
+    // zero.
+    std::vector<float> values;
+    for (int i = 0; i < (1 << 16); i += 7) {
+        float h = (float)halves(i);
+        float next = (float)halves((i + 1) & 0xffff);
+        values.push_back(h);
+        if (std::isfinite(h) && std::isfinite(next)) {
+            values.push_back(h + (next - h) / 2);
+            values.push_back(std::nextafter(h + (next - h) / 2, h));
+            values.push_back(std::nextafter(h + (next - h) / 2, next));
+        }
+    }
+    for (int i = 0; i < 20000; i++) {
+        uint32_t bits = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        values.push_back(f);
+    }
+    Image<float> floats((int)values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        floats((int)i) = values[i];
+    }
+
+    std::vector<Target> targets = {get_jit_target_from_environment()};
+    if (targets[0].arch == Target::X86 && targets[0].has_feature(Target::F16C)) {
+        // Also check the software fallback.
+        targets.push_back(targets[0].without_feature(Target::F16C));
+    }
+
+    for (const Target &t : targets) {
+        for (int lanes : {1, 4, 8, 16, 12}) {
+            if (check_widening(halves, t, lanes) != 0 ||
+                check_narrowing(floats, t, lanes) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
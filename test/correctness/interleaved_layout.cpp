@@ -0,0 +1,88 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace Halide;
+
+// Describe interleaved storage with the given number of channels.
+template<typename T>
+buffer_t interleaved_buffer(T *data, int width, int height, int channels) {
+    buffer_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.host = (uint8_t *)data;
+    buf.extent[0] = width;
+    buf.extent[1] = height;
+    buf.extent[2] = channels;
+    buf.stride[0] = channels;
+    buf.stride[1] = channels * width;
+    buf.stride[2] = 1;
+    buf.elem_size = sizeof(T);
+    return buf;
+}
+
+template<typename T>
+bool test(int channels, int vector_width) {
+    const int W = 67, H = 13;
+
+    ImageParam input(type_of<T>(), 3);
+    input.set_interleaved(channels);
+
+    Var x, y, c;
+    Func f;
+    // Reverse the channel order and scale each channel differently,
+    // so that mixing up lanes gives the wrong answer.
+    f(x, y, c) = input(x, y, channels - 1 - c) * cast<T>(c + 1) + cast<T>(x % 7);
+    f.output_buffer().set_interleaved(channels);
+    f.reorder(c, x, y).bound(c, 0, channels).unroll(c).vectorize(x, vector_width);
+
+    std::vector<T> in_storage(W * H * channels);
+    buffer_t in_buf = interleaved_buffer(&in_storage[0], W, H, channels);
+    Image<T> in(&in_buf);
+    for (int yy = 0; yy < H; yy++) {
+        for (int xx = 0; xx < W; xx++) {
+            for (int cc = 0; cc < channels; cc++) {
+                in(xx, yy, cc) = (T)((xx * 3 + yy * 5 + cc * 11) % 50);
+            }
+        }
+    }
+    input.set(in);
+
+    // Realize over a region that doesn't start at zero and isn't a
+    // multiple of the vector width.
+    std::vector<T> out_storage((W - 4) * H * channels);
+    buffer_t out_buf = interleaved_buffer(&out_storage[0], W - 4, H, channels);
+    Image<T> out(&out_buf);
+    out.set_min(2, 0, 0);
+    f.realize(out);
+
+    for (int yy = 0; yy < H; yy++) {
+        for (int xx = 2; xx < W - 2; xx++) {
+            for (int cc = 0; cc < channels; cc++) {
+                T correct = (T)(in(xx, yy, channels - 1 - cc) * (cc + 1) + xx % 7);
+                if (out(xx, yy, cc) != correct) {
+                    printf("%d channels, vector width %d: out(%d, %d, %d) = %f instead of %f\n",
+                           channels, vector_width, xx, yy, cc,
+                           (double)out(xx, yy, cc), (double)correct);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (int channels = 3; channels <= 4; channels++) {
+        for (int vector_width : {4, 8, 16}) {
+            if (!test<uint8_t>(channels, vector_width) ||
+                !test<uint16_t>(channels, vector_width) ||
+                !test<float>(channels, vector_width)) {
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "Halide.h"
+#include <math.h>
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 50, H = 20;
+
+    ImageParam input(Float(32), 2);
+    Param<int> mode;
+    Param<float> scale;
+
+    Image<float> in(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            in(x, y) = (float)(x * 3 + y * 5);
+        }
+    }
+    input.set(in);
+
+    Var x, y;
+    Func f, g;
+    f(x, y) = input(x, y) * scale + select(mode == 1, 1.0f, 0.0f);
+    g(x, y) = f(x, y) + f(x + 1, y) + cast<float>(mode);
+
+    // The specializations use values from outside the branch (the
+    // scalar params, the input, and the loop over y), and one of
+    // them is nested in another.
+    f.compute_at(g, y);
+    f.specialize(mode == 1).vectorize(x, 4);
+    g.specialize(mode == 0);
+    g.specialize(mode == 1).vectorize(x, 8)
+        .specialize(scale == 1.0f);
+
+    Target t = get_jit_target_from_environment().with_feature(Target::LazySpecializations);
+    g.compile_jit(t);
+
+    // Run every path, and run the first one again once it's compiled.
+    for (int m : {0, 1, 2, 0}) {
+        for (float s : {1.0f, 0.5f}) {
+            mode.set(m);
+            scale.set(s);
+            Image<float> out = g.realize(W - 1, H, t);
+            for (int yy = 0; yy < H; yy++) {
+                for (int xx = 0; xx < W - 1; xx++) {
+                    float b = (m == 1) ? 1.0f : 0.0f;
+                    float correct = (in(xx, yy) * s + b) + (in(xx + 1, yy) * s + b) + m;
+                    if (fabs(out(xx, yy) - correct) > 1e-3f) {
+                        printf("mode %d, scale %f: out(%d, %d) = %f instead of %f\n",
+                               m, s, xx, yy, out(xx, yy), correct);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include "Halide.h"
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Check that compute_root intermediates of bounded size with
+// non-overlapping lifetimes share a single heap allocation, and that
+// those of unbounded size are left alone.
+
+int malloc_count = 0;
+size_t current_bytes = 0, peak_bytes = 0;
+
+void *my_malloc(void *user_context, size_t x) {
+    malloc_count++;
+    current_bytes += x;
+    peak_bytes = std::max(peak_bytes, current_bytes);
+    void *orig = malloc(x + 64);
+    void *ptr = (void *)((((size_t)orig + 64) >> 6) << 6);
+    ((void **)ptr)[-1] = orig;
+    ((size_t *)ptr)[-2] = x;
+    return ptr;
+}
+
+void my_free(void *user_context, void *ptr) {
+    current_bytes -= ((size_t *)ptr)[-2];
+    free(((void **)ptr)[-1]);
+}
+
+// Count the slabs, and those whose size isn't a constant.
+int slabs = 0, non_constant_slabs = 0;
+
+class CountSlabs : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Allocate *op) {
+        if (starts_with(op->name, "memory_plan.slab")) {
+            slabs++;
+            if (op->constant_allocation_size() == 0) {
+                non_constant_slabs++;
+            }
+        }
+        IRMutator::visit(op);
+    }
+};
+
+const int W = 200, H = 100, stages = 6;
+
+int run(bool bounded) {
+    malloc_count = 0;
+    current_bytes = peak_bytes = 0;
+    slabs = non_constant_slabs = 0;
+
+    Var x, y;
+    std::vector<Func> funcs;
+    Func input;
+    input(x, y) = cast<float>(x * 3 + y * 5);
+    funcs.push_back(input);
+    for (int i = 1; i < stages; i++) {
+        Func f;
+        f(x, y) = funcs[i - 1](x - 1, y) * 0.25f + funcs[i - 1](x + 1, y) * 0.75f + i;
+        funcs.push_back(f);
+    }
+    for (int i = 0; i < stages - 1; i++) {
+        funcs[i].compute_root().vectorize(x, 4);
+    }
+
+    Func out = funcs.back();
+    if (bounded) {
+        out.bound(x, 0, W).bound(y, 0, H);
+    }
+    out.set_custom_allocator(my_malloc, my_free);
+    out.add_custom_lowering_pass(new CountSlabs);
+    Image<float> result = out.realize(W, H);
+
+    // Check the result against a reference computed in C.
+    std::vector<float> ref((W + 2 * stages) * H), next(ref.size());
+    const int ofs = stages;
+    for (int y = 0; y < H; y++) {
+        for (int x = -stages; x < W + stages; x++) {
+            ref[(x + ofs) + y * (W + 2 * stages)] = (float)(x * 3 + y * 5);
+        }
+    }
+    for (int i = 1; i < stages; i++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = -stages + i; x < W + stages - i; x++) {
+                int idx = (x + ofs) + y * (W + 2 * stages);
+                next[idx] = ref[idx - 1] * 0.25f + ref[idx + 1] * 0.75f + i;
+            }
+        }
+        std::swap(ref, next);
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = ref[(x + ofs) + y * (W + 2 * stages)];
+            if (std::fabs(result(x, y) - correct) > 1e-3f * std::fabs(correct) + 1e-3f) {
+                printf("result(%d, %d) = %f instead of %f\n", x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (current_bytes != 0) {
+        printf("Not everything was freed\n");
+        return -1;
+    }
+
+    // The sizes of the intermediates depend on the size of the output,
+    // so unless it's bounded they can't go in a slab.
+    if (!bounded) {
+        if (slabs != 0 || malloc_count != stages - 1) {
+            printf("With an unbounded output there were %d slabs and %d calls to malloc "
+                   "instead of 0 and %d\n", slabs, malloc_count, stages - 1);
+            return -1;
+        }
+        return 0;
+    }
+
+    // All the intermediates should come from one slab of constant
+    // size, and at most two of them are live at once, so the slab
+    // should be about the size of two intermediates rather than all
+    // five.
+    size_t intermediate_bytes = (W + 2 * stages) * H * sizeof(float);
+    if (slabs != 1 || non_constant_slabs != 0) {
+        printf("There were %d slabs, %d of them of non-constant size, instead of one of constant size\n",
+               slabs, non_constant_slabs);
+        return -1;
+    }
+    if (malloc_count != 1) {
+        printf("There were %d calls to malloc instead of 1\n", malloc_count);
+        return -1;
+    }
+    if (peak_bytes > 3 * intermediate_bytes) {
+        printf("Peak memory usage was %d bytes. Expected at most %d\n",
+               (int)peak_bytes, (int)(3 * intermediate_bytes));
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (run(true) != 0 || run(false) != 0) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
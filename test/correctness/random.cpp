@@ -1,5 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
+#include <vector>
 
 using namespace Halide;
 
@@ -174,6 +175,102 @@ int main(int argc, char **argv) {
         }
     }
 
+    // The values shouldn't depend on the schedule.
+    {
+        Func f;
+        f(x, y) = random_uint();
+
+        Func g;
+        g(x, y) = f(x, y);
+
+        Image<uint32_t> correct = g.realize(100, 100);
+
+        Var xo, yo, xi, yi;
+        f.compute_at(g, xo).vectorize(x, 8);
+        g.tile(x, y, xo, yo, xi, yi, 16, 8, TailStrategy::GuardWithIf).parallel(yo);
+        Image<uint32_t> scheduled = g.realize(100, 100);
+
+        for (int y = 0; y < 100; y++) {
+            for (int x = 0; x < 100; x++) {
+                if (scheduled(x, y) != correct(x, y)) {
+                    printf("Scheduling changed the random value at (%d, %d): %u instead of %u\n",
+                           x, y, scheduled(x, y), correct(x, y));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Check the random bytes are uniform, and that the slices of a
+    // three-dimensional function are independent, with a chi-squared
+    // test.
+    {
+        const int W = 1024, H = 256, D = 4;
+        Var z;
+        Func f;
+        f(x, y, z) = random_uint();
+        f.vectorize(x, 8);
+        Image<uint32_t> im = f.realize(W, H, D);
+
+        std::vector<int> hist(256, 0), joint(256, 0);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                hist[im(x, y, 0) >> 24]++;
+                // Pairs of the top 4 bits of two slices.
+                joint[((im(x, y, 1) >> 28) << 4) | (im(x, y, 3) >> 28)]++;
+            }
+        }
+
+        // For 255 degrees of freedom, the chi-squared statistic has
+        // mean 255 and standard deviation about 22.6.
+        for (const std::vector<int> *h : {&hist, &joint}) {
+            double expected = double(W * H) / 256;
+            double chi2 = 0;
+            for (int count : *h) {
+                chi2 += (count - expected) * (count - expected) / expected;
+            }
+            if (chi2 > 255 + 6 * 22.6) {
+                printf("Chi-squared statistic was %f, which is too large for a uniform distribution\n", chi2);
+                return -1;
+            }
+        }
+    }
+
+    // Check the moments of the normal and exponential distributions.
+    {
+        const int S = 1024;
+        Func f;
+        f(x, y) = Tuple(cast<double>(random_normal()), cast<double>(random_exponential()));
+        f.vectorize(x, 8).parallel(y);
+        Realization R = f.realize(S, S);
+        Image<double> normal = R[0], exponential = R[1];
+
+        RDom r(0, S, 0, S);
+        Expr n = normal(r.x, r.y);
+        Expr e = exponential(r.x, r.y);
+        double n_mean = evaluate<double>(sum(n)) / (S * S);
+        double n_var = evaluate<double>(sum(pow(n - (float)n_mean, 2))) / (S * S - 1);
+        double n_within_sigma = evaluate<double>(sum(cast<double>(abs(n) < 1))) / (S * S);
+        double e_mean = evaluate<double>(sum(e)) / (S * S);
+        double e_var = evaluate<double>(sum(pow(e - (float)e_mean, 2))) / (S * S - 1);
+        double e_min = evaluate<double>(minimum(e));
+
+        if (fabs(n_mean) > tol || fabs(n_var - 1) > tol) {
+            printf("Normal distribution had mean %f and variance %f instead of 0 and 1\n", n_mean, n_var);
+            return -1;
+        }
+        if (fabs(n_within_sigma - 0.6827) > tol) {
+            printf("%f of the normal distribution was within one standard deviation instead of 0.6827\n",
+                   n_within_sigma);
+            return -1;
+        }
+        if (fabs(e_mean - 1) > tol || fabs(e_var - 1) > 2 * tol || e_min < 0) {
+            printf("Exponential distribution had mean %f, variance %f and minimum %f "
+                   "instead of 1, 1 and at least 0\n", e_mean, e_var, e_min);
+            return -1;
+        }
+    }
+
     printf("Success!\n");
 
     return 0;
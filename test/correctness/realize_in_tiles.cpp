@@ -0,0 +1,91 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int input_value(int x, int y) {
+    return x * 3 + y * 5;
+}
+
+int main(int argc, char **argv) {
+    ImageParam input(Int(32), 2);
+    Var x, y;
+
+    // A two-stage pipeline with a compute_root intermediate.
+    Func blur_x, blur_y;
+    blur_x(x, y) = input(x - 1, y) + input(x, y) + input(x + 1, y);
+    blur_y(x, y) = blur_x(x, y - 1) + blur_x(x, y) + blur_x(x, y + 1);
+    blur_x.compute_root();
+
+    Pipeline p(blur_y);
+
+    const int W = 200, H = 150, tile_w = 64, tile_h = 32;
+    Image<int> out(W, H);
+    int tiles = 0, errors = 0;
+
+    auto fetch = [&](const std::string &name, Buffer buf) {
+        if (name != input.name()) {
+            printf("Asked to fetch unknown input %s\n", name.c_str());
+            errors++;
+            return;
+        }
+        // Each fetch should cover one tile plus a one-pixel apron.
+        if (buf.extent(0) > tile_w + 2 || buf.extent(1) > tile_h + 2) {
+            printf("Fetched region %d x %d is larger than a tile's working set\n",
+                   buf.extent(0), buf.extent(1));
+            errors++;
+        }
+        Image<int> im(buf);
+        for (int yy = buf.min(1); yy < buf.min(1) + buf.extent(1); yy++) {
+            for (int xx = buf.min(0); xx < buf.min(0) + buf.extent(0); xx++) {
+                im(xx, yy) = input_value(xx, yy);
+            }
+        }
+    };
+
+    auto sink = [&](Realization r) {
+        Image<int> tile = r[0];
+        tiles++;
+        for (int yy = tile.min(1); yy < tile.min(1) + tile.extent(1); yy++) {
+            for (int xx = tile.min(0); xx < tile.min(0) + tile.extent(0); xx++) {
+                out(xx, yy) = tile(xx, yy);
+            }
+        }
+    };
+
+    p.realize_in_tiles({W, H}, {tile_w, tile_h}, fetch, sink);
+
+    if (errors) {
+        return -1;
+    }
+
+    int expected_tiles = ((W + tile_w - 1) / tile_w) * ((H + tile_h - 1) / tile_h);
+    if (tiles != expected_tiles) {
+        printf("Got %d tiles instead of %d\n", tiles, expected_tiles);
+        return -1;
+    }
+
+    if (input.get().defined()) {
+        printf("Input should have been left unbound\n");
+        return -1;
+    }
+
+    for (int yy = 0; yy < H; yy++) {
+        for (int xx = 0; xx < W; xx++) {
+            int correct = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    correct += input_value(xx + dx, yy + dy);
+                }
+            }
+            if (out(xx, yy) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n",
+                       xx, yy, out(xx, yy), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
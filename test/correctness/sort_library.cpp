@@ -0,0 +1,163 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+using namespace Halide;
+
+// Check the sorting networks, order statistics and sorts of Funcs
+// defined in Sort.h against std::sort and std::nth_element.
+
+Var x("x"), y("y"), c("c");
+
+// Gather a list of Exprs into the second dimension of a Func.
+Func gather(const std::vector<Expr> &values) {
+    Expr e = values.back();
+    for (int i = (int)values.size() - 2; i >= 0; i--) {
+        e = select(c == i, values[i], e);
+    }
+    Func f;
+    f(x, c) = e;
+    f.bound(c, 0, (int)values.size()).unroll(c).vectorize(x, 8);
+    return f;
+}
+
+int test_sort_exprs(int n) {
+    const int W = 64;
+    Image<int> data(W, n);
+    for (int i = 0; i < n; i++) {
+        for (int x = 0; x < W; x++) {
+            data(x, i) = rand() % 100 - 50;
+        }
+    }
+
+    std::vector<Expr> values;
+    for (int i = 0; i < n; i++) {
+        values.push_back(data(x, i));
+    }
+    Image<int> sorted = gather(sort_exprs(values)).realize(W, n);
+
+    // Find each order statistic separately too.
+    std::vector<Expr> kth;
+    for (int k = 0; k < n; k++) {
+        kth.push_back(kth_smallest(values, k));
+    }
+    Image<int> selected = gather(kth).realize(W, n);
+
+    for (int x = 0; x < W; x++) {
+        std::vector<int> correct(n);
+        for (int i = 0; i < n; i++) {
+            correct[i] = data(x, i);
+        }
+        std::sort(correct.begin(), correct.end());
+        for (int i = 0; i < n; i++) {
+            if (sorted(x, i) != correct[i]) {
+                printf("sort_exprs of %d values: sorted(%d, %d) = %d instead of %d\n",
+                       n, x, i, sorted(x, i), correct[i]);
+                return -1;
+            }
+            if (selected(x, i) != correct[i]) {
+                printf("kth_smallest of %d values: selected(%d, %d) = %d instead of %d\n",
+                       n, x, i, selected(x, i), correct[i]);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int test_median_filter() {
+    const int W = 128, H = 64;
+    Image<uint8_t> in(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            in(x, y) = rand() & 0xff;
+        }
+    }
+    Func input = BoundaryConditions::repeat_edge(in);
+
+    // A median filter over a disc of radius 2, which has 13 points.
+    RDom r(-2, 5, -2, 5);
+    r.where(r.x*r.x + r.y*r.y <= 4);
+    Func median_disc("median_disc");
+    median_disc(x, y) = median(r, input(x + r.x, y + r.y));
+    median_disc.vectorize(x, 16).parallel(y);
+
+    Image<uint8_t> out = median_disc.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            std::vector<uint8_t> window;
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    if (dx*dx + dy*dy <= 4) {
+                        int cx = std::min(std::max(x + dx, 0), W - 1);
+                        int cy = std::min(std::max(y + dy, 0), H - 1);
+                        window.push_back(in(cx, cy));
+                    }
+                }
+            }
+            std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+            uint8_t correct = window[window.size() / 2];
+            if (out(x, y) != correct) {
+                printf("median_disc(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int test_sort_func(int size) {
+    Image<float> data(size);
+    for (int i = 0; i < size; i++) {
+        data(i) = (float)(rand() % 1000);
+    }
+    Func input;
+    input(x) = data(x);
+
+    std::vector<float> correct(&data(0), &data(0) + size);
+    std::sort(correct.begin(), correct.end());
+
+    Image<float> bitonic_sorted = bitonic_sort(input, size).realize(size);
+    for (int i = 0; i < size; i++) {
+        if (bitonic_sorted(i) != correct[i]) {
+            printf("bitonic_sort of %d values: sorted(%d) = %f instead of %f\n",
+                   size, i, bitonic_sorted(i), correct[i]);
+            return -1;
+        }
+    }
+
+    if (size >= 4) {
+        Image<float> merge_sorted = merge_sort(input, size).realize(size);
+        for (int i = 0; i < size; i++) {
+            if (merge_sorted(i) != correct[i]) {
+                printf("merge_sort of %d values: sorted(%d) = %f instead of %f\n",
+                       size, i, merge_sorted(i), correct[i]);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    for (int n : {1, 2, 3, 5, 8, 9, 16, 25}) {
+        if (test_sort_exprs(n) != 0) {
+            return -1;
+        }
+    }
+
+    if (test_median_filter() != 0) {
+        return -1;
+    }
+
+    for (int size : {2, 4, 8, 256, 4096}) {
+        if (test_sort_func(size) != 0) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// Count the runs of the fast path.
+int fast_path_runs = 0;
+extern "C" DLLEXPORT int record_fast_path(int x) {
+    fast_path_runs++;
+    return x;
+}
+HalideExtern_1(int, record_fast_path, int);
+
+// Find the variables for the strides of buffers in dimension 0.
+class FindStride : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) {
+        const std::string suffix = ".stride.0";
+        if (op->name.size() > suffix.size() &&
+            op->name.compare(op->name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            found = true;
+        }
+    }
+
+public:
+    bool found = false;
+};
+
+// Count the loads and stores of dense vectors.
+class CountDenseAccesses : public IRVisitor {
+    using IRVisitor::visit;
+
+    bool dense(Expr index) {
+        const Ramp *ramp = index.as<Ramp>();
+        return ramp && is_one(ramp->stride);
+    }
+
+    void visit(const Load *op) {
+        IRVisitor::visit(op);
+        if (dense(op->index)) {
+            loads++;
+        }
+    }
+
+    void visit(const Store *op) {
+        IRVisitor::visit(op);
+        if (dense(op->index)) {
+            stores++;
+        }
+    }
+
+public:
+    int loads = 0, stores = 0;
+};
+
+// Check that the lowered code branches on the strides, with dense
+// vector loads and stores on the fast path and none on the general
+// path, and make the fast path count its runs.
+int specializations = 0;
+class CheckStrideSpecialization : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const IfThenElse *op) {
+        FindStride stride;
+        op->condition.accept(&stride);
+        if (!stride.found) {
+            IRMutator::visit(op);
+            return;
+        }
+        specializations++;
+
+        CountDenseAccesses fast, general;
+        op->then_case.accept(&fast);
+        if (op->else_case.defined()) {
+            op->else_case.accept(&general);
+        }
+        if (fast.loads == 0 || fast.stores == 0) {
+            std::cerr << "The fast path has no dense vector loads or stores:\n" << Stmt(op);
+            exit(-1);
+        }
+        if (general.loads != 0 || general.stores != 0) {
+            std::cerr << "The general path has dense vector loads or stores:\n" << Stmt(op);
+            exit(-1);
+        }
+
+        Stmt then_case = Block::make(Evaluate::make(record_fast_path(0)), op->then_case);
+        stmt = IfThenElse::make(op->condition, then_case, op->else_case);
+    }
+};
+
+int main(int argc, char **argv) {
+    const int W = 64, H = 16;
+
+    ImageParam input(Int(32), 2);
+    // Allow any stride in dimension 0, so that only the automatic
+    // specialization can recover dense vector loads.
+    input.set_stride(0, Expr());
+
+    Var x, y;
+    Func f;
+    f(x, y) = input(x, y) * 2 + y;
+    f.output_buffer().set_stride(0, Expr());
+    f.vectorize(x, 8);
+    f.add_custom_lowering_pass(new CheckStrideSpecialization);
+
+    Target t = get_jit_target_from_environment().with_feature(Target::SpecializeStrides);
+    f.compile_jit(t);
+    if (specializations != 1) {
+        printf("Found %d stride specializations instead of 1\n", specializations);
+        return -1;
+    }
+
+    // Run on dense buffers, which must take the fast path, and on
+    // buffers with a stride of two in dimension 0, which must take the
+    // general path, with widths and mins that are and aren't multiples
+    // of the vector width.
+    struct {
+        int width, min;
+    } shapes[] = {{W, 0}, {W - 3, 0}, {W, 3}, {W - 5, 8}};
+    for (int stride = 1; stride <= 2; stride++) {
+        for (auto shape : shapes) {
+            const int w = shape.width, m = shape.min;
+            std::vector<int> in_storage(w * H * stride), out_storage(w * H * stride);
+
+            buffer_t in_buf, out_buf;
+            memset(&in_buf, 0, sizeof(in_buf));
+            in_buf.host = (uint8_t *)&in_storage[0];
+            in_buf.extent[0] = w;
+            in_buf.extent[1] = H;
+            in_buf.stride[0] = stride;
+            in_buf.stride[1] = w * stride;
+            in_buf.min[0] = m;
+            in_buf.elem_size = sizeof(int);
+            out_buf = in_buf;
+            out_buf.host = (uint8_t *)&out_storage[0];
+
+            Image<int> in(&in_buf), out(&out_buf);
+            for (int yy = 0; yy < H; yy++) {
+                for (int xx = m; xx < m + w; xx++) {
+                    in(xx, yy) = xx * 3 + yy * 7;
+                }
+            }
+
+            input.set(in);
+            fast_path_runs = 0;
+            f.realize(out, t);
+            if (fast_path_runs != (stride == 1 ? 1 : 0)) {
+                printf("stride %d, width %d, min %d: the fast path ran %d times\n",
+                       stride, w, m, fast_path_runs);
+                return -1;
+            }
+
+            for (int yy = 0; yy < H; yy++) {
+                for (int xx = m; xx < m + w; xx++) {
+                    int correct = in(xx, yy) * 2 + yy;
+                    if (out(xx, yy) != correct) {
+                        printf("stride %d, width %d, min %d: out(%d, %d) = %d instead of %d\n",
+                               stride, w, m, xx, yy, out(xx, yy), correct);
+                        return -1;
+                    }
+                }
+            }
+
+            // The gaps between strided elements must not have been touched.
+            for (size_t i = 0; i < out_storage.size(); i++) {
+                if (i % stride != 0 && out_storage[i] != 0) {
+                    printf("Wrote outside the output at index %d\n", (int)i);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // With the default unit stride constraints, there is nothing to
+    // specialize on.
+    {
+        ImageParam dense_input(Int(32), 2);
+        Func g;
+        g(x, y) = dense_input(x, y) + 1;
+        g.vectorize(x, 8);
+        g.add_custom_lowering_pass(new CheckStrideSpecialization);
+        specializations = 0;
+        g.compile_jit(t);
+        if (specializations != 0) {
+            printf("Found %d stride specializations of dense buffers\n", specializations);
+            return -1;
+        }
+
+        for (int w : {W, W - 3}) {
+            Image<int> in(w, H);
+            for (int yy = 0; yy < H; yy++) {
+                for (int xx = 0; xx < w; xx++) {
+                    in(xx, yy) = xx - yy;
+                }
+            }
+            dense_input.set(in);
+            Image<int> out = g.realize(w, H, t);
+            for (int yy = 0; yy < H; yy++) {
+                for (int xx = 0; xx < w; xx++) {
+                    if (out(xx, yy) != in(xx, yy) + 1) {
+                        printf("width %d: out(%d, %d) = %d instead of %d\n",
+                               w, xx, yy, out(xx, yy), in(xx, yy) + 1);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "Halide.h"
+
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+
+namespace {
+
+// A blur with a schedule controlled by GeneratorParams.
+class TiledBlur : public Halide::Generator<TiledBlur> {
+public:
+    GeneratorParam<int> tile_x{ "tile_x", 32, 1, 1024 };
+    GeneratorParam<int> tile_y{ "tile_y", 8, 1, 1024 };
+    GeneratorParam<int> vector_width{ "vector_width", 8, 1, 64 };
+
+    ImageParam input{ Float(32), 2, "input" };
+
+    Func build() {
+        Var x("x"), y("y"), xi("xi"), yi("yi");
+        Func blur_x("blur_x"), blur_y("blur_y");
+
+        blur_x(x, y) = input(x, y) + input(x + 1, y) + input(x + 2, y);
+        blur_y(x, y) = (blur_x(x, y) + blur_x(x, y + 1) + blur_x(x, y + 2)) / 9;
+
+        blur_y.tile(x, y, xi, yi, tile_x, tile_y).vectorize(xi, vector_width);
+        blur_x.compute_at(blur_y, x).vectorize(x, vector_width);
+        return blur_y;
+    }
+};
+
+Halide::RegisterGenerator<TiledBlur> register_tiled_blur{"tiled_blur"};
+
+}  // namespace
+
+bool contains(const std::vector<std::string> &values, const std::string &v) {
+    for (const std::string &value : values) {
+        if (value == v) return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const int W = 256, H = 128;
+    const char *params_file = "autotune_jittest_params.txt";
+    remove(params_file);
+
+    Image<float> in(W + 2, H + 2), out(W, H);
+    for (int y = 0; y < H + 2; y++) {
+        for (int x = 0; x < W + 2; x++) {
+            in(x, y) = (float)((x * 7 + y * 13) % 17);
+        }
+    }
+
+    std::vector<TunableParam> space = {
+        { "tile_x", { "8", "16", "32", "64", "128" } },
+        { "tile_y", { "1", "2", "4", "8", "16" } },
+        { "vector_width", { "4", "8", "16" } }
+    };
+
+    Target target = get_jit_target_from_environment();
+
+    AutotuneOptions options;
+    options.max_evaluations = 10;
+    options.samples = 2;
+    options.iterations = 2;
+    options.output_file = params_file;
+
+    AutotuneResult result = autotune("tiled_blur", { { "target", target.to_string() } },
+                                     space, { in.raw_buffer(), out.raw_buffer() }, options);
+
+    if (result.evaluations < 1 || result.evaluations > options.max_evaluations) {
+        printf("Unexpected number of evaluations: %d\n", result.evaluations);
+        return -1;
+    }
+    if (result.params.size() != space.size()) {
+        printf("Expected a value for each tuned param\n");
+        return -1;
+    }
+    for (const TunableParam &p : space) {
+        if (!contains(p.values, result.params[p.name])) {
+            printf("Value %s for %s is not in the search space\n",
+                   result.params[p.name].c_str(), p.name.c_str());
+            return -1;
+        }
+    }
+    printf("Best configuration: tile_x=%s tile_y=%s vector_width=%s, %g ms\n",
+           result.params["tile_x"].c_str(), result.params["tile_y"].c_str(),
+           result.params["vector_width"].c_str(), result.time * 1e3);
+
+    // Every configuration computes the same thing, so the output of
+    // the last run must be correct.
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = 0;
+            for (int dy = 0; dy < 3; dy++) {
+                correct += in(x, y + dy) + in(x + 1, y + dy) + in(x + 2, y + dy);
+            }
+            correct /= 9;
+            if (std::fabs(out(x, y) - correct) > 1e-4f) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    // The best configuration is recorded for the target, and survives
+    // other entries being added.
+    save_tuned_params(params_file, "some_other_generator", target, { { "tile_x", "4" } });
+    Internal::GeneratorParamValues loaded;
+    if (!load_tuned_params(params_file, "tiled_blur", target, loaded) ||
+        loaded != result.params) {
+        printf("Failed to load the tuned params\n");
+        return -1;
+    }
+    Internal::GeneratorParamValues other;
+    if (load_tuned_params(params_file, "tiled_blur", target.with_feature(Target::NoAsserts), other)) {
+        printf("Loaded tuned params for the wrong target\n");
+        return -1;
+    }
+
+    remove(params_file);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -10,12 +10,15 @@
 #include "Deinterleave.h"
 #include "ModulusRemainder.h"
 #include "CSE.h"
+#include "HoistLoopInvariants.h"
 #include "IREquality.h"
 #include "Solve.h"
 #include "Monotonic.h"
 #include "Reduction.h"
 #include "Interval.h"
 #include "Associativity.h"
+#include "CostEstimate.h"
+#include "Random.h"
 
 using namespace Halide;
 using namespace Halide::Internal;
@@ -29,6 +32,7 @@ int main(int argc, const char **argv) {
     deinterleave_vector_test();
     modulus_remainder_test();
     cse_test();
+    hoist_loop_invariants_test();
     simplify_test();
     solve_test();
     target_test();
@@ -37,6 +41,8 @@ int main(int argc, const char **argv) {
     split_predicate_test();
     interval_test();
     associativity_test();
+    cost_estimate_test();
+    random_test();
 
     return 0;
 }
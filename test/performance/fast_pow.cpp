@@ -1,6 +1,7 @@
 #include "Halide.h"
 #include <cstdio>
 #include <algorithm>
+#include <functional>
 #include "benchmark.h"
 
 using namespace Halide;
@@ -95,6 +96,46 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    // Compare the throughput of the other transcendentals, which call
+    // the math library, with the fast approximations at each
+    // precision.
+    {
+        Expr u = (x - 1024) / 100.0f;
+        Expr v = (y - 384) / 100.0f;
+        struct {
+            const char *name;
+            Expr exact;
+            std::function<Expr(ApproximationPrecision)> approx;
+        } funcs[] = {
+            {"sin", sin(u), [&](ApproximationPrecision p) { return fast_sin(u, p); }},
+            {"cos", cos(u), [&](ApproximationPrecision p) { return fast_cos(u, p); }},
+            {"atan2", atan2(v, u), [&](ApproximationPrecision p) { return fast_atan2(v, u, p); }},
+            {"tanh", tanh(u), [&](ApproximationPrecision p) { return fast_tanh(u, p); }},
+            {"exp", exp(u), [&](ApproximationPrecision p) { return fast_exp(u, p); }},
+        };
+        const ApproximationPrecision precisions[] = {ApproximationPrecision::Low,
+                                                     ApproximationPrecision::Medium,
+                                                     ApproximationPrecision::High};
+        const char *precision_names[] = {"Low", "Medium", "High"};
+        const int pixels = timing_scratch.width() * timing_scratch.height();
+
+        for (auto &f : funcs) {
+            Func exact;
+            exact(x, y) = f.exact;
+            exact.vectorize(x, 8);
+            double t_exact = benchmark(trials, iterations, [&]() { exact.realize(timing_scratch); });
+            printf("%s: %f ns per pixel\n", f.name, 1e9 * t_exact / pixels);
+            for (int i = 0; i < 3; i++) {
+                Func approx;
+                approx(x, y) = f.approx(precisions[i]);
+                approx.vectorize(x, 8);
+                double t = benchmark(trials, iterations, [&]() { approx.realize(timing_scratch); });
+                printf("  fast_%s with precision %s: %f ns per pixel\n",
+                       f.name, precision_names[i], 1e9 * t / pixels);
+            }
+        }
+    }
+
     printf("Success!\n");
 
     return 0;
@@ -0,0 +1,56 @@
+#include "Halide.h"
+#include <cstdio>
+#include "benchmark.h"
+
+using namespace Halide;
+
+// Compare a memory-bound pipeline over half-precision buffers, which
+// loads half floats, computes in single precision and stores half
+// floats, with the same pipeline over single-precision buffers.
+
+const int W = 4096, H = 2048;
+
+double run(Type t) {
+    ImageParam in(t, 2);
+    Var x, y;
+    Func f;
+    f(x, y) = cast(t, cast<float>(in(x, y)) * 1.5f + 0.25f);
+    f.vectorize(x, 16).parallel(y, 16);
+
+    Image<float> input_f32(W, H);
+    Image<float16_t> input_f16(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input_f32(x, y) = (float)((x + y) % 1000) / 100;
+            input_f16(x, y) = float16_t(input_f32(x, y));
+        }
+    }
+    Buffer input = t.bits() == 16 ? Buffer(input_f16) : Buffer(input_f32);
+    Buffer output(t, W, H);
+    in.set(input);
+
+    f.compile_jit();
+    double time = benchmark(5, 10, [&]() { f.realize(output); });
+
+    double bytes = 2.0 * W * H * t.bytes();
+    printf("%-8s %8.3f ms, %6.2f GB/s\n",
+           t.bits() == 16 ? "float16" : "float32", time * 1e3, bytes / time * 1e-9);
+    return time;
+}
+
+int main(int argc, char **argv) {
+    double t_f32 = run(Float(32));
+    double t_f16 = run(Float(16));
+
+    // Half-precision buffers move half as many bytes. The conversions
+    // are single instructions with F16C, so the pipeline should be no
+    // slower.
+    Target target = get_jit_target_from_environment();
+    if (target.has_feature(Target::F16C) && t_f16 > 1.2 * t_f32) {
+        printf("The float16 pipeline was slower than the float32 pipeline\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "Halide.h"
+
+#include <cmath>
+#include <cstdio>
+#include "benchmark.h"
+
+using namespace Halide;
+
+// A separable blur of a planar color image with a color correction,
+// with the blur of the columns computed per strip of rows. The loads
+// of each stage index with the runtime strides of the buffers, and
+// the correction calls pow with a loop-invariant exponent.
+Func make_pipeline(ImageParam input, Param<float> gamma) {
+    Var x("x"), y("y"), c("c"), yo("yo");
+    Func clamped = BoundaryConditions::repeat_edge(input);
+
+    Func blur_y("blur_y");
+    blur_y(x, y, c) = (clamped(x, y - 2, c) + clamped(x, y - 1, c) * 4 + clamped(x, y, c) * 6 +
+                       clamped(x, y + 1, c) * 4 + clamped(x, y + 2, c)) * (1.0f / 16);
+    Func blur_x("blur_x");
+    blur_x(x, y, c) = (blur_y(x - 2, y, c) + blur_y(x - 1, y, c) * 4 + blur_y(x, y, c) * 6 +
+                       blur_y(x + 1, y, c) * 4 + blur_y(x + 2, y, c)) * (1.0f / 16);
+    Func corrected("corrected");
+    corrected(x, y, c) = pow(blur_x(x, y, c), 1.0f / gamma) * pow(2.0f, cast<float>(c) / gamma);
+
+    corrected.split(y, yo, y, 16).parallel(yo).vectorize(x, 8);
+    blur_y.compute_at(corrected, yo).vectorize(x, 8);
+    return corrected;
+}
+
+// Compare the time taken to lower the pipeline, and to run it, with
+// and without hoisting loop invariants.
+int main(int argc, char **argv) {
+    const int W = 1536, H = 2560, C = 3;
+
+    ImageParam input(Float(32), 3);
+    Param<float> gamma;
+    Image<float> in(W, H, C);
+    for (int c = 0; c < C; c++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                in(x, y, c) = (float)((x * 17 + y * 31 + c * 7) % 101) / 101;
+            }
+        }
+    }
+    input.set(in);
+    gamma.set(2.2f);
+
+    Target t = get_jit_target_from_environment();
+    Target no_hoist = t.with_feature(Target::NoHoistLoopInvariants);
+
+    Func hoisted = make_pipeline(input, gamma);
+    Func not_hoisted = make_pipeline(input, gamma);
+
+    double lower_hoisted = benchmark(3, 1, [&]() {
+        hoisted.compile_to_module({input, gamma}, "hoisted", t);
+    });
+    double lower_not_hoisted = benchmark(3, 1, [&]() {
+        not_hoisted.compile_to_module({input, gamma}, "not_hoisted", no_hoist);
+    });
+
+    hoisted.compile_jit(t);
+    not_hoisted.compile_jit(no_hoist);
+    Image<float> out_hoisted(W, H, C), out_not_hoisted(W, H, C);
+    double run_hoisted = benchmark(10, 1, [&]() { hoisted.realize(out_hoisted, t); });
+    double run_not_hoisted = benchmark(10, 1, [&]() { not_hoisted.realize(out_not_hoisted, no_hoist); });
+
+    for (int c = 0; c < C; c++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (std::abs(out_hoisted(x, y, c) - out_not_hoisted(x, y, c)) > 1e-5f) {
+                    printf("out(%d, %d, %d) = %f with hoisting, and %f without\n",
+                           x, y, c, out_hoisted(x, y, c), out_not_hoisted(x, y, c));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Lowering: %g ms with hoisting, %g ms without\n",
+           lower_hoisted * 1e3, lower_not_hoisted * 1e3);
+    printf("Running: %g ms with hoisting, %g ms without\n",
+           run_hoisted * 1e3, run_not_hoisted * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "Halide.h"
+
+#include <cstdio>
+#include "benchmark.h"
+
+using namespace Halide;
+
+// Measure how long it takes to lower a pipeline with many stages, each
+// with a handful of split loops. This is dominated by symbol table
+// lookups on long names in the lowering passes, and by making and
+// freeing IR nodes. Compare lowering with and without hash-consing of
+// the IR nodes.
+int main(int argc, char **argv) {
+    const int stages = 40;
+
+    ImageParam input(Float(32), 3);
+    Var x, y, c, xi, yi;
+
+    std::vector<Func> fs;
+    Func prev = BoundaryConditions::repeat_edge(input);
+    for (int i = 0; i < stages; i++) {
+        Func f("stage_" + std::to_string(i));
+        f(x, y, c) = (prev(x - 1, y, c) + prev(x + 1, y, c) +
+                      prev(x, y - 1, c) + prev(x, y + 1, c)) * 0.25f;
+        if (i % 4 == 3) {
+            f.compute_root().tile(x, y, xi, yi, 32, 8).vectorize(xi, 8).parallel(y);
+        }
+        fs.push_back(f);
+        prev = f;
+    }
+    Func output = fs.back();
+    output.bound(c, 0, 3);
+
+    Target t = get_host_target();
+    double time = benchmark(3, 1, [&]() {
+        output.compile_to_module({input}, "lowering_time", t);
+    });
+    double time_no_hash_consing = benchmark(3, 1, [&]() {
+        output.compile_to_module({input}, "lowering_time", t.with_feature(Target::NoHashConsing));
+    });
+
+    printf("%g ms to lower a %d stage pipeline, %g ms without hash-consing\n",
+           time * 1e3, stages, time_no_hash_consing * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
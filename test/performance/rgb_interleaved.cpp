@@ -12,9 +12,7 @@ void test_deinterleave() {
 
     dst(x, y, c) = src(x, y, c);
 
-    src.set_stride(0, 3);
-    src.set_stride(2, 1);
-    src.set_extent(2, 3);
+    src.set_interleaved(3);
 
     // This is the default format for Halide, but made explicit for illustration.
     dst.output_buffer().set_stride(0, 1);
@@ -133,10 +131,7 @@ void test_interleave(bool fast) {
     src.set_stride(0, 1);
     src.set_extent(2, 3);
 
-    dst.output_buffer().set_min(2, 0);
-    dst.output_buffer().set_stride(0, 3);
-    dst.output_buffer().set_stride(2, 1);
-    dst.output_buffer().set_extent(2, 3);
+    dst.output_buffer().set_interleaved(3);
 
     if( fast ) {
         dst.reorder(c, x, y).bound(c, 0, 3).unroll(c);
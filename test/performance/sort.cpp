@@ -7,136 +7,28 @@ using namespace Halide;
 
 Var x("x"), y("y");
 
-Func bitonic_sort(Func input, int size) {
-    Func next, prev = input;
-
-    Var xo("xo"), xi("xi");
-
-    for (int pass_size = 1; pass_size < size; pass_size <<= 1) {
-        for (int chunk_size = pass_size; chunk_size > 0; chunk_size >>= 1) {
-            next = Func("bitonic_pass");
-            Expr chunk_start = (x/(2*chunk_size))*(2*chunk_size);
-            Expr chunk_end = (x/(2*chunk_size) + 1)*(2*chunk_size);
-            Expr chunk_middle = chunk_start + chunk_size;
-            Expr chunk_index = x - chunk_start;
-            if (pass_size == chunk_size && pass_size > 1) {
-                // Flipped pass
-                Expr partner = 2*chunk_middle - x - 1;
-                // We need a clamp here to help out bounds inference
-                partner = clamp(partner, chunk_start, chunk_end-1);
-                next(x) = select(x < chunk_middle,
-                                 min(prev(x), prev(partner)),
-                                 max(prev(x), prev(partner)));
-
-
-            } else {
-                // Regular pass
-                Expr partner = chunk_start + (chunk_index + chunk_size) % (chunk_size*2);
-                next(x) = select(x < chunk_middle,
-                                 min(prev(x), prev(partner)),
-                                 max(prev(x), prev(partner)));
-
-
-            }
-
-            if (pass_size > 1) {
-                next.split(x, xo, xi, 2*chunk_size);
-            }
-            if (chunk_size > 128) {
-                next.parallel(xo);
-            }
-            next.compute_root();
-            prev = next;
-        }
+// Use a sorting network to sort each column of the first n rows of a
+// 2D Func, like the many small sorts of the windows of a median
+// filter.
+Func sort_columns(Func input, int n) {
+    std::vector<Expr> values;
+    for (int i = 0; i < n; i++) {
+        values.push_back(input(x, i));
     }
+    values = sort_exprs(values);
 
-    return next;
-}
-
-// Merge sort contiguous chunks of size s in a 1d func.
-Func merge_sort(Func input, int total_size) {
-    std::vector<Func> stages;
-    Func result;
-
-    const int parallel_work_size = 512;
-
-    Func parallel_stage("parallel_stage");
-
-    // First gather the input into a 2D array of width four where each row is sorted
-    {
-        assert(input.dimensions() == 1);
-        // Use a small sorting network
-        Expr a0 = input(4*y);
-        Expr a1 = input(4*y+1);
-        Expr a2 = input(4*y+2);
-        Expr a3 = input(4*y+3);
-
-        Expr b0 = min(a0, a1);
-        Expr b1 = max(a0, a1);
-        Expr b2 = min(a2, a3);
-        Expr b3 = max(a2, a3);
-
-        a0 = min(b0, b2);
-        a1 = max(b0, b2);
-        a2 = min(b1, b3);
-        a3 = max(b1, b3);
-
-        b0 = a0;
-        b1 = min(a1, a2);
-        b2 = max(a1, a2);
-        b3 = a3;
-
-        result(x, y) = select(x == 0, b0,
-                              select(x == 1, b1,
-                                  select(x == 2, b2, b3)));
-
-        result.compute_at(parallel_stage, y).bound(x, 0, 4).unroll(x);
-
-        stages.push_back(result);
+    Expr e = values.back();
+    for (int i = n - 2; i >= 0; i--) {
+        e = select(y == i, values[i], e);
     }
-
-    // Now build up to the total size, merging each pair of rows
-    for (int chunk_size = 4; chunk_size < total_size; chunk_size *= 2) {
-        // "result" contains the sorted halves
-        assert(result.dimensions() == 2);
-
-        // Merge pairs of rows from the partial result
-        Func merge_rows("merge_rows");
-        RDom r(0, chunk_size*2);
-
-        // The first dimension of merge_rows is within the chunk, and the
-        // second dimension is the chunk index.  Keeps track of two
-        // pointers we're merging from and an output value.
-        merge_rows(x, y) = Tuple(0, 0, cast(input.value().type(), 0));
-
-        Expr candidate_a = merge_rows(r-1, y)[0];
-        Expr candidate_b = merge_rows(r-1, y)[1];
-        Expr valid_a = candidate_a < chunk_size;
-        Expr valid_b = candidate_b < chunk_size;
-        Expr value_a = result(clamp(candidate_a, 0, chunk_size-1), 2*y);
-        Expr value_b = result(clamp(candidate_b, 0, chunk_size-1), 2*y+1);
-        merge_rows(r, y) = tuple_select(valid_a && ((value_a < value_b) || !valid_b),
-                                        Tuple(candidate_a + 1, candidate_b, value_a),
-                                        Tuple(candidate_a, candidate_b + 1, value_b));
-
-
-        if (chunk_size <= parallel_work_size) {
-            merge_rows.compute_at(parallel_stage, y);
-        } else {
-            merge_rows.compute_root();
-        }
-
-        if (chunk_size == parallel_work_size) {
-            parallel_stage(x, y) = merge_rows(x, y)[2];
-            parallel_stage.compute_root().parallel(y);
-            result = parallel_stage;
-        } else {
-            result = lambda(x, y, merge_rows(x, y)[2]);
-        }
-    }
-
-    // Convert back to 1D
-    return lambda(x, result(x, 0));
+    Func sorted("sorted_columns");
+    sorted(x, y) = e;
+
+    Var xo("xo");
+    sorted.bound(y, 0, n).reorder(y, x).unroll(y)
+        .split(x, xo, x, 1024).parallel(xo)
+        .vectorize(x, get_jit_target_from_environment().natural_vector_size<int>());
+    return sorted;
 }
 
 int main(int argc, char **argv) {
@@ -186,6 +78,55 @@ int main(int argc, char **argv) {
            "std::sort %fms\n",
            t_bitonic * 1e3, t_merge * 1e3, t_std * 1e3);
 
+    // Sort many columns of a few values each.
+    const int columns = 1 << 16, column_size = 9;
+    Image<int> column_data(columns, column_size);
+    for (int y = 0; y < column_size; y++) {
+        for (int x = 0; x < columns; x++) {
+            column_data(x, y) = rand() & 0xfffff;
+        }
+    }
+
+    printf("Sorting network...\n");
+    f = sort_columns(lambda(x, y, column_data(x, y)), column_size);
+    f.compile_jit();
+    printf("Running...\n");
+    Image<int> columns_sorted(columns, column_size);
+    f.realize(columns_sorted);
+    double t_network = benchmark(1, 10, [&]() {
+        f.realize(columns_sorted);
+    });
+
+    // std::sort needs each column to be contiguous, so time it on
+    // the transpose.
+    std::vector<int> columns_correct(columns * column_size);
+    for (int x = 0; x < columns; x++) {
+        for (int y = 0; y < column_size; y++) {
+            columns_correct[x * column_size + y] = column_data(x, y);
+        }
+    }
+    printf("std::sort of columns...\n");
+    double t_std_columns = benchmark(1, 1, [&]() {
+        for (int x = 0; x < columns; x++) {
+            std::sort(&columns_correct[x * column_size], &columns_correct[(x + 1) * column_size]);
+        }
+    });
+
+    printf("Times for %d sorts of %d values:\n"
+           "sorting network: %fms \n"
+           "std::sort %fms\n",
+           columns, column_size, t_network * 1e3, t_std_columns * 1e3);
+
+    for (int x = 0; x < columns; x++) {
+        for (int y = 0; y < column_size; y++) {
+            if (columns_sorted(x, y) != columns_correct[x * column_size + y]) {
+                printf("sorting network failed: (%d, %d) -> %d instead of %d\n",
+                       x, y, columns_sorted(x, y), columns_correct[x * column_size + y]);
+                return -1;
+            }
+        }
+    }
+
     if (N <= 100) {
         for (int i = 0; i < N; i++) {
             printf("%8d %8d %8d\n",